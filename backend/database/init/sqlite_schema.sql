@@ -1,6 +1,10 @@
 -- sqlite_schema.sql
 -- Converted from PostgreSQL schema for SQLite for development
 
+-- Let the maintenance job return freed pages with PRAGMA incremental_vacuum
+-- (must be set before any table is created)
+PRAGMA auto_vacuum = INCREMENTAL;
+
 -- Create cities table
 CREATE TABLE cities (
                         id INTEGER PRIMARY KEY AUTOINCREMENT,
@@ -28,7 +32,9 @@ CREATE TABLE trips (
                        id INTEGER PRIMARY KEY AUTOINCREMENT,
                        start_city_id INTEGER REFERENCES cities(id) ON DELETE SET NULL,
                        trip_type TEXT NOT NULL,
-                       total_distance REAL CHECK (total_distance >= 0)
+                       trip_kind INTEGER NOT NULL DEFAULT 0, -- TripKind value, what lookups filter on
+                       total_distance REAL CHECK (total_distance >= 0),
+                       created_at INTEGER NOT NULL DEFAULT (CAST(strftime('%s', 'now') AS INTEGER))
 );
 
 -- Create trip_cities table
@@ -46,7 +52,8 @@ CREATE TABLE purchases (
                            city_id INTEGER REFERENCES cities(id) ON DELETE CASCADE,
                            food_id INTEGER REFERENCES foods(id) ON DELETE CASCADE,
                            quantity INTEGER NOT NULL CHECK (quantity > 0),
-                           trip_id INTEGER REFERENCES trips(id) ON DELETE SET NULL
+                           trip_id INTEGER REFERENCES trips(id) ON DELETE SET NULL,
+                           unit_price_cents INTEGER NOT NULL DEFAULT 0 -- food price when bought
 );
 
 -- Create users table
@@ -65,8 +72,9 @@ CREATE INDEX idx_city_distances_from ON city_distances(from_city_id);
 CREATE INDEX idx_city_distances_to ON city_distances(to_city_id);
 CREATE INDEX idx_city_distances_distance ON city_distances(distance);
 CREATE INDEX idx_trips_start_city ON trips(start_city_id);
-CREATE INDEX idx_trips_type ON trips(trip_type);
+CREATE INDEX idx_trips_kind ON trips(trip_kind);
 CREATE INDEX idx_trips_total_distance ON trips(total_distance);
+CREATE INDEX idx_trips_created_at ON trips(created_at);
 CREATE INDEX idx_trip_cities_trip_id ON trip_cities(trip_id);
 CREATE INDEX idx_trip_cities_city_id ON trip_cities(city_id);
 CREATE INDEX idx_trip_cities_visit_order ON trip_cities(visit_order);
@@ -75,4 +83,97 @@ CREATE INDEX idx_purchases_food_id ON purchases(food_id);
 CREATE INDEX idx_purchases_trip_id ON purchases(trip_id);
 CREATE INDEX idx_purchases_quantity ON purchases(quantity);
 CREATE INDEX idx_users_name ON users(name);
-CREATE INDEX idx_users_role ON users(role);
\ No newline at end of file
+CREATE INDEX idx_users_role ON users(role);
+
+-- Spending aggregates, kept current by the triggers below so the
+-- /spending endpoints read one row instead of grouping purchases.
+-- Amounts are integer cents of quantity * the unit price stored on the
+-- purchase, so later food price changes never move past totals.
+CREATE TABLE trip_spending (
+    trip_id INTEGER PRIMARY KEY,
+    purchase_count INTEGER NOT NULL DEFAULT 0,
+    item_count INTEGER NOT NULL DEFAULT 0,
+    total_cents INTEGER NOT NULL DEFAULT 0
+);
+CREATE TABLE city_spending (
+    city_id INTEGER PRIMARY KEY,
+    purchase_count INTEGER NOT NULL DEFAULT 0,
+    item_count INTEGER NOT NULL DEFAULT 0,
+    total_cents INTEGER NOT NULL DEFAULT 0
+);
+CREATE TABLE food_spending (
+    food_id INTEGER PRIMARY KEY,
+    purchase_count INTEGER NOT NULL DEFAULT 0,
+    item_count INTEGER NOT NULL DEFAULT 0,
+    total_cents INTEGER NOT NULL DEFAULT 0
+);
+CREATE TRIGGER purchases_spending_insert AFTER INSERT ON purchases
+BEGIN
+    INSERT INTO trip_spending (trip_id, purchase_count, item_count, total_cents)
+    SELECT NEW.trip_id, 1, NEW.quantity, NEW.quantity * NEW.unit_price_cents
+    WHERE NEW.trip_id IS NOT NULL
+    ON CONFLICT(trip_id) DO UPDATE SET purchase_count = purchase_count + 1,
+        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;
+    INSERT INTO city_spending (city_id, purchase_count, item_count, total_cents)
+    SELECT NEW.city_id, 1, NEW.quantity, NEW.quantity * NEW.unit_price_cents
+    WHERE NEW.city_id IS NOT NULL
+    ON CONFLICT(city_id) DO UPDATE SET purchase_count = purchase_count + 1,
+        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;
+    INSERT INTO food_spending (food_id, purchase_count, item_count, total_cents)
+    SELECT NEW.food_id, 1, NEW.quantity, NEW.quantity * NEW.unit_price_cents
+    WHERE NEW.food_id IS NOT NULL
+    ON CONFLICT(food_id) DO UPDATE SET purchase_count = purchase_count + 1,
+        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;
+END;
+CREATE TRIGGER purchases_spending_delete AFTER DELETE ON purchases
+BEGIN
+    UPDATE trip_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,
+        total_cents = total_cents - OLD.quantity * OLD.unit_price_cents
+    WHERE trip_id = OLD.trip_id;
+    DELETE FROM trip_spending WHERE trip_id = OLD.trip_id AND purchase_count <= 0;
+    UPDATE city_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,
+        total_cents = total_cents - OLD.quantity * OLD.unit_price_cents
+    WHERE city_id = OLD.city_id;
+    DELETE FROM city_spending WHERE city_id = OLD.city_id AND purchase_count <= 0;
+    UPDATE food_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,
+        total_cents = total_cents - OLD.quantity * OLD.unit_price_cents
+    WHERE food_id = OLD.food_id;
+    DELETE FROM food_spending WHERE food_id = OLD.food_id AND purchase_count <= 0;
+END;
+CREATE TRIGGER purchases_spending_update AFTER UPDATE OF city_id, food_id, quantity, trip_id, unit_price_cents ON purchases
+BEGIN
+    UPDATE trip_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,
+        total_cents = total_cents - OLD.quantity * OLD.unit_price_cents
+    WHERE trip_id = OLD.trip_id;
+    DELETE FROM trip_spending WHERE trip_id = OLD.trip_id AND purchase_count <= 0;
+    UPDATE city_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,
+        total_cents = total_cents - OLD.quantity * OLD.unit_price_cents
+    WHERE city_id = OLD.city_id;
+    DELETE FROM city_spending WHERE city_id = OLD.city_id AND purchase_count <= 0;
+    UPDATE food_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,
+        total_cents = total_cents - OLD.quantity * OLD.unit_price_cents
+    WHERE food_id = OLD.food_id;
+    DELETE FROM food_spending WHERE food_id = OLD.food_id AND purchase_count <= 0;
+    INSERT INTO trip_spending (trip_id, purchase_count, item_count, total_cents)
+    SELECT NEW.trip_id, 1, NEW.quantity, NEW.quantity * NEW.unit_price_cents
+    WHERE NEW.trip_id IS NOT NULL
+    ON CONFLICT(trip_id) DO UPDATE SET purchase_count = purchase_count + 1,
+        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;
+    INSERT INTO city_spending (city_id, purchase_count, item_count, total_cents)
+    SELECT NEW.city_id, 1, NEW.quantity, NEW.quantity * NEW.unit_price_cents
+    WHERE NEW.city_id IS NOT NULL
+    ON CONFLICT(city_id) DO UPDATE SET purchase_count = purchase_count + 1,
+        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;
+    INSERT INTO food_spending (food_id, purchase_count, item_count, total_cents)
+    SELECT NEW.food_id, 1, NEW.quantity, NEW.quantity * NEW.unit_price_cents
+    WHERE NEW.food_id IS NOT NULL
+    ON CONFLICT(food_id) DO UPDATE SET purchase_count = purchase_count + 1,
+        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;
+END;
+CREATE TRIGGER trips_spending_delete AFTER DELETE ON trips
+BEGIN
+    DELETE FROM trip_spending WHERE trip_id = OLD.id;
+END;
+
+-- Schema version for DatabaseManager::applyMigrations (bump with each migration)
+PRAGMA user_version = 4;
\ No newline at end of file
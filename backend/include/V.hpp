@@ -68,6 +68,21 @@ class V {
     		size_t capacity() const { return capacity_; }
     		bool empty() const { return size_ == 0; }
 
+		// Grow the storage to hold at least new_capacity elements without reallocating
+		void reserve(size_t new_capacity) {
+			if (new_capacity <= capacity_) {
+				return;
+			}
+			T* new_data = new T[new_capacity];
+			for (size_t i = 0; i < size_; i++) {
+				new_data[i] = data[i];
+			}
+
+			delete[] data;
+			data = new_data;
+			capacity_ = new_capacity;
+		}
+
 		void push_back(const T& value) {
 			if(size_ == capacity_) {
 				size_t new_capacity = (capacity_ == 0) ? 1 : capacity_ * 2;
@@ -0,0 +1,102 @@
+/**
+ * Database Executor
+ * Runs database-bound work on dedicated threads, off the HTTP I/O threads
+ */
+
+#ifndef DATABASE_EXECUTOR_HPP
+#define DATABASE_EXECUTOR_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class DatabaseExecutor
+ * @brief Small pool of threads reserved for work that blocks on SQLite
+ *
+ * Request handlers that read or write the database post their work here and
+ * return, so a slow trip insert holds a DB thread instead of the Crow worker
+ * that also serves cached reads. Work runs in submission order when there is
+ * one thread. Statements still go through DatabaseManager, which serializes
+ * them on its single connection; the extra threads only let planning and JSON
+ * building overlap with another request's SQL.
+ */
+class DatabaseExecutor {
+public:
+    using Work = std::function<void()>;
+
+private:
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::deque<Work> queue;
+    size_t running;             ///< Work items currently executing
+    size_t maxQueued;           ///< Queue capacity before post() refuses work
+    bool stopping;
+    std::vector<std::thread> workers;
+
+public:
+    static const size_t DEFAULT_THREADS = 2;
+    static const size_t DEFAULT_MAX_QUEUED = 1024;
+
+    /**
+     * @brief The process-wide executor, started with the configured thread count
+     */
+    static DatabaseExecutor& getInstance();
+
+    /**
+     * @brief Set the thread count getInstance() starts with (ServerConfig::databaseThreads)
+     * @return false if the process-wide executor is already running
+     */
+    static bool configure(size_t threadCount);
+
+    /**
+     * @brief Start the DB threads
+     * @param threadCount Number of threads (at least 1)
+     * @param maxQueued Work items allowed to wait for a thread
+     */
+    explicit DatabaseExecutor(size_t threadCount = DEFAULT_THREADS, size_t maxQueued = DEFAULT_MAX_QUEUED);
+
+    /**
+     * @brief Calls shutdown()
+     */
+    ~DatabaseExecutor();
+
+    DatabaseExecutor(const DatabaseExecutor&) = delete;
+    DatabaseExecutor& operator=(const DatabaseExecutor&) = delete;
+
+    /**
+     * @brief Queue work for a DB thread and return immediately
+     * @return false if the queue is full (nothing is queued); the caller should shed the request
+     * @note Exceptions escaping the work are logged and dropped
+     */
+    bool post(Work work);
+
+    /**
+     * @brief Run everything still queued, then join the threads
+     *
+     * Call before the services that queued work are destroyed. Work posted
+     * afterwards runs on the calling thread.
+     */
+    void shutdown();
+
+    /**
+     * @brief Work items waiting for a DB thread
+     */
+    size_t queuedCount();
+
+    /**
+     * @brief Work items currently executing
+     */
+    size_t runningCount();
+
+    size_t getThreadCount() const;
+
+private:
+    void workerLoop();
+};
+
+#endif
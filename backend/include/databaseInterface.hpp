@@ -7,6 +7,7 @@
 #define DATABASE_INTERFACE_HPP
 
 #include "header.hpp"
+#include <functional>
 
 class DatabaseInterface {
 public:
@@ -20,6 +21,9 @@ public:
     // Generic query execution
     virtual bool executeQuery(const std::string& query) = 0;
     virtual V<std::vector<std::string>> executeSelect(const std::string& query) = 0;
+    // Streams rows to onRow one at a time; return false from onRow to stop early
+    virtual bool executeSelectEach(const std::string& query,
+                                   const std::function<bool(const std::vector<std::string>&)>& onRow) = 0;
     virtual int executeInsert(const std::string& query) = 0;
     virtual bool executeUpdate(const std::string& query) = 0;
     virtual bool executeDelete(const std::string& query) = 0;
@@ -30,4 +34,42 @@ public:
     virtual bool rollbackTransaction() = 0;
 };
 
+// Scoped transaction: begins on construction and rolls back on destruction
+// unless commit() succeeded, so an early return or exception can never leave
+// the transaction open and the connection locked
+class Transaction {
+private:
+    DatabaseInterface& database;
+    bool active;
+
+public:
+    explicit Transaction(DatabaseInterface& database)
+        : database(database), active(database.beginTransaction()) {}
+
+    ~Transaction() {
+        rollback();
+    }
+
+    Transaction(const Transaction&) = delete;
+    Transaction& operator=(const Transaction&) = delete;
+
+    // False when BEGIN failed; nothing runs inside the transaction then
+    bool isActive() const { return active; }
+
+    bool commit() {
+        if (!active || !database.commitTransaction()) {
+            return false;
+        }
+        active = false;
+        return true;
+    }
+
+    void rollback() {
+        if (active) {
+            active = false;
+            database.rollbackTransaction();
+        }
+    }
+};
+
 #endif
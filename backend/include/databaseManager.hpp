@@ -10,6 +10,7 @@
 #include "V.hpp"
 #include <sqlite3.h>
 #include <memory>
+#include <mutex>
 #include <string>
 
 class DatabaseManager : public DatabaseInterface {
@@ -18,10 +19,15 @@ private:
     std::string dbPath;
     sqlite3* db;
     bool isConnected_;
-    bool inTransaction;
+    int transactionDepth;     // nested begins join the outermost transaction
+    bool rollbackOnly;        // an inner level rolled back, so the outer commit must too
+    std::recursive_mutex connectionMutex; // serializes statements from request and worker threads
 
     DatabaseManager();
 
+    // Schema upgrades for databases created from an older sqlite_schema.sql
+    bool applyMigrations();
+
 public:
     static DatabaseManager& getInstance();
     
@@ -33,6 +39,8 @@ public:
     // Generic query execution
     bool executeQuery(const std::string& query) override;
     V<std::vector<std::string>> executeSelect(const std::string& query) override;
+    bool executeSelectEach(const std::string& query,
+                           const std::function<bool(const std::vector<std::string>&)>& onRow) override;
     int executeInsert(const std::string& query) override;
     bool executeUpdate(const std::string& query) override;
     bool executeDelete(const std::string& query) override;
@@ -42,6 +50,9 @@ public:
     bool commitTransaction() override;
     bool rollbackTransaction() override;
     
+    // Schema version recorded in PRAGMA user_version
+    int getSchemaVersion();
+    
     ~DatabaseManager();
 };
 
@@ -2,23 +2,24 @@
 #define CITY_HPP
 
 #include "../header.hpp"
+#include <string_view>
 
 class City {
   private:
     int id;
-    std::string name;
+    const std::string* name; // Interned in NamePool; copying a City never copies the name
 
   public:
     City();
-    City(int id, const std::string& name);
+    City(int id, std::string_view name);
 
     //getters
     int getId() const;                         // Returns the city's ID number
-    std::string getName() const;
+    const std::string& getName() const;        // Pooled name, valid for the life of the process
 
     //setters
     void setId(int id);
-    void setName(const std::string& name);
+    void setName(std::string_view name);
 
     void print() const;
 };
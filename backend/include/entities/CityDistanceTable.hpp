@@ -0,0 +1,86 @@
+#ifndef CITY_DISTANCE_TABLE_HPP
+#define CITY_DISTANCE_TABLE_HPP
+
+#include "../header.hpp"
+#include "CityDistance.hpp"
+
+/**
+ * @class CityDistanceTable
+ * @brief Columnar (struct-of-arrays) copy of the city_distances table
+ *
+ * V<CityDistance> interleaves from, to and distance, so a pass over one
+ * field drags the other two through the cache. Here each field is its own
+ * contiguous int array, grouped by from_city_id in CSR form: the legs
+ * leaving a city are one slice [rowOffsets[from], rowOffsets[from + 1]).
+ * Rows are handed out as views into those arrays, never copied.
+ */
+class CityDistanceTable {
+private:
+    int maxCityId;                ///< Largest city ID on either end of a leg
+    std::vector<size_t> rowOffsets; ///< Start of each from_city_id's slice, up to the last from_city_id seen
+    std::vector<int> fromCityIds;
+    std::vector<int> toCityIds;
+    std::vector<int> distances;
+
+public:
+    /**
+     * @struct Row
+     * @brief The legs leaving one city, as pointers into the table's columns
+     */
+    struct Row {
+        const int* toCityIds = nullptr;
+        const int* distances = nullptr;
+        size_t size = 0;
+    };
+
+    CityDistanceTable();
+
+    /**
+     * @brief Group rows by from_city_id; rows keep their relative order within a city
+     */
+    explicit CityDistanceTable(const V<CityDistance>& rows);
+
+    /**
+     * @brief Add one leg; legs must arrive in non-decreasing from_city_id order
+     * @return false (and nothing added) if fromCityId is below the previous leg's
+     * @note Legs with an ID <= 0 on either end are skipped
+     */
+    bool append(int fromCityId, int toCityId, int distance);
+
+    /**
+     * @brief The legs leaving a city; empty for a city without any
+     */
+    Row getRow(int fromCityId) const {
+        if (fromCityId <= 0 || (size_t)fromCityId >= rowOffsets.size()) {
+            return Row();
+        }
+        size_t begin = rowOffsets[fromCityId];
+        size_t end = (size_t)fromCityId + 1 < rowOffsets.size() ? rowOffsets[fromCityId + 1] : toCityIds.size();
+
+        Row row;
+        row.toCityIds = toCityIds.data() + begin;
+        row.distances = distances.data() + begin;
+        row.size = end - begin;
+        return row;
+    }
+
+    /**
+     * @brief Distance of the leg from one city to another
+     * @return The distance, or -1 if the leg is unknown
+     */
+    int findDistance(int fromCityId, int toCityId) const;
+
+    /**
+     * @brief The leg at position index, in table order
+     */
+    CityDistance at(size_t index) const;
+
+    const int* getFromCityIds() const { return fromCityIds.data(); }
+    const int* getToCityIds() const { return toCityIds.data(); }
+    const int* getDistances() const { return distances.data(); }
+
+    size_t size() const;
+    int getMaxCityId() const;
+};
+
+#endif
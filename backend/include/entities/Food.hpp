@@ -2,25 +2,26 @@
 #define FOOD_HPP
 
 #include "../header.hpp"
+#include <string_view>
 
 class Food {
 private:
     int id;              // Primary key from foods table - unique identifier for each food
-    std::string name;    // Food name from foods table - the actual name like "Croissant"
+    const std::string* name; // Food name from foods table, like "Croissant" - interned in NamePool
     int cityId;          // Foreign key - which city this food belongs to (links to cities table)
     double price;        // Food price from foods table - the cost like 2.50
 
 public:
     Food();
-    Food(int id, const std::string& name, int cityId, double price);
+    Food(int id, std::string_view name, int cityId, double price);
 
     int getId() const;
-    std::string getName() const;
+    const std::string& getName() const;
     int getCityId() const;
     double getPrice() const;
 
     void setId(int id);
-    void setName(const std::string& name);
+    void setName(std::string_view name);
     void setCityId(int cityId);
     void setPrice(double price);
 
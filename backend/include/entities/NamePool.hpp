@@ -0,0 +1,48 @@
+#ifndef NAME_POOL_HPP
+#define NAME_POOL_HPP
+
+#include "../header.hpp"
+#include <deque>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * @class NamePool
+ * @brief Process-wide intern pool for reference-data names (cities, foods)
+ *
+ * Every distinct name is stored once. Entities keep a pointer to the pooled
+ * string, so copying a City or Food, growing a V of them or reading the name
+ * never allocates. Pooled strings live until the process exits; the pool only
+ * grows by names that were never seen before, which for reference data is
+ * bounded by the size of the cities and foods tables.
+ */
+class NamePool {
+private:
+    std::mutex mutex;
+    std::deque<std::string> names;               ///< Storage; push_back never moves existing strings
+    std::unordered_map<std::string_view, const std::string*> lookup; ///< Keys view into `names`, so hits never allocate
+
+    NamePool();
+
+public:
+    static NamePool& getInstance();
+
+    NamePool(const NamePool&) = delete;
+    NamePool& operator=(const NamePool&) = delete;
+
+    /**
+     * @brief The pooled copy of name, adding it on first sight
+     * @return A reference that stays valid for the life of the process
+     */
+    const std::string& intern(std::string_view name);
+
+    /**
+     * @brief The pooled empty string, used by default-constructed entities
+     */
+    const std::string& empty() const;
+
+    size_t size();
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef PURCHASE_HPP
+#define PURCHASE_HPP
+
+#include "../header.hpp"
+
+class Purchase {
+private:
+    int id;              // Primary key from purchases table - 0 until the purchase is written
+    int cityId;          // Foreign key - city the food was bought in (links to cities table)
+    int foodId;          // Foreign key - food that was bought (links to foods table)
+    int quantity;        // How many were bought, always at least 1
+    int tripId;          // Foreign key - trip the purchase belongs to, 0 when not tied to a trip
+
+public:
+    Purchase();
+    Purchase(int id, int cityId, int foodId, int quantity, int tripId);
+
+    int getId() const;
+    int getCityId() const;
+    int getFoodId() const;
+    int getQuantity() const;
+    int getTripId() const;
+
+    void setId(int id);
+    void setCityId(int cityId);
+    void setFoodId(int foodId);
+    void setQuantity(int quantity);
+    void setTripId(int tripId);
+
+    void print() const;
+};
+
+#endif
@@ -2,32 +2,34 @@
 #define TRIP_HPP
 
 #include "../header.hpp"
+#include "TripKind.hpp"
 
 class Trip {
     private:
         int id;
         int start_city_id;
-        std::string trip_type;
+        TripKind trip_kind;
         double total_distance;
         //int numCities;
 
     public:
         // Constructors
         Trip();
-        Trip(int id, int start_city_id, std::string trip_type, double total_distance);
-        Trip(int start_city_id, std::string trip_type, double total_distance);
+        Trip(int id, int start_city_id, TripKind trip_kind, double total_distance);
+        Trip(int start_city_id, TripKind trip_kind, double total_distance);
 
         // Getters
         int getId() const;
         int getStartCityId() const;
-        std::string getTripType() const;
+        TripKind getTripKind() const;
+        const char* getTripType() const;  // Label of the trip kind, e.g. "paris_tour"
         double getTotalDistance() const;
         //int getNumCities() const;
 
         // Setters
         void setId(int id);
         void setStartCityId(int start_city_id);
-        void setTripType(std::string trip_type);
+        void setTripKind(TripKind trip_kind);
         void setTotalDistance(double total_distance);
         //void setNumCities(int numCities);
 
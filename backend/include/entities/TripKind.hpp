@@ -0,0 +1,84 @@
+#ifndef TRIP_KIND_HPP
+#define TRIP_KIND_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @enum TripKind
+ * @brief What kind of tour a trip is; stored as trips.trip_kind
+ *
+ * The values are persisted, so existing ones must never be renumbered.
+ * Add new kinds at the end and give them a row in TRIP_KIND_CATALOG.
+ */
+enum class TripKind : uint8_t {
+    Unknown = 0,
+    Paris = 1,
+    London = 2,
+    Berlin = 3,
+    Custom = 4,
+    Culinary = 5
+};
+
+/**
+ * @struct TripKindInfo
+ * @brief One row of the trip kind catalog
+ */
+struct TripKindInfo {
+    TripKind kind;
+    const char* label; ///< Public name, used in the API and in trips.trip_type
+    bool maintained;   ///< Regenerable preset; maintenance may merge duplicates and expire old copies
+};
+
+// Indexed by the enum value, so label lookups are a single array read
+constexpr TripKindInfo TRIP_KIND_CATALOG[] = {
+    {TripKind::Unknown, "unknown", false},
+    {TripKind::Paris, "paris_tour", true},
+    {TripKind::London, "london_tour", true},
+    {TripKind::Berlin, "berlin_tour", true},
+    {TripKind::Custom, "custom_tour", false},
+    {TripKind::Culinary, "culinary_tour", false},
+};
+
+constexpr size_t TRIP_KIND_COUNT = sizeof(TRIP_KIND_CATALOG) / sizeof(TRIP_KIND_CATALOG[0]);
+
+constexpr bool tripKindCatalogIsIndexed() {
+    for (size_t i = 0; i < TRIP_KIND_COUNT; i++) {
+        if ((size_t)TRIP_KIND_CATALOG[i].kind != i) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(tripKindCatalogIsIndexed(), "TRIP_KIND_CATALOG rows must be in enum order");
+
+/**
+ * @brief Public label of a trip kind ("paris_tour", ...); "unknown" for out-of-range values
+ */
+constexpr const char* tripKindLabel(TripKind kind) {
+    return (size_t)kind < TRIP_KIND_COUNT ? TRIP_KIND_CATALOG[(size_t)kind].label
+                                          : TRIP_KIND_CATALOG[0].label;
+}
+
+/**
+ * @brief Trip kind for a label, or TripKind::Unknown if there is none
+ * @note "custom" is accepted for custom_tour, the label custom trips were once saved with
+ */
+constexpr TripKind tripKindFromLabel(std::string_view label) {
+    for (size_t i = 1; i < TRIP_KIND_COUNT; i++) {
+        if (std::string_view(TRIP_KIND_CATALOG[i].label) == label) {
+            return TRIP_KIND_CATALOG[i].kind;
+        }
+    }
+    return label == "custom" ? TripKind::Custom : TripKind::Unknown;
+}
+
+/**
+ * @brief Trip kind stored as an integer, or TripKind::Unknown if out of range
+ */
+constexpr TripKind tripKindFromValue(int value) {
+    return value > 0 && (size_t)value < TRIP_KIND_COUNT ? TRIP_KIND_CATALOG[value].kind : TripKind::Unknown;
+}
+
+#endif
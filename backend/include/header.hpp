@@ -18,11 +18,4 @@ void showCityAndFood(DatabaseManager& database);
 void showTripController(DatabaseManager& database);
 void runTripTests(DatabaseManager& database);
 
-namespace TripTypes {
-    const std::string PARIS_TOUR = "paris_tour";
-    const std::string LONDON_TOUR = "london_tour";
-    const std::string CUSTOM_TOUR = "custom_tour";
-    const std::string BERLIN_TOUR = "berlin_tour";
-}
-
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "../header.hpp"
 #include "../entities/CityDistance.hpp"
+#include "../entities/CityDistanceTable.hpp"
 #include "../databaseManager.hpp"
 
 class CityDistanceRepository {
@@ -15,6 +16,7 @@ public:
     V<CityDistance> findByFromCity(int fromCityId);
     int getDistance(int fromCityId, int toCityId);
     V<CityDistance> findAll();
+    CityDistanceTable findAllColumnar(); // Same rows as findAll, streamed straight into columns
 
 private:
     CityDistance mapRowToEntity(const std::vector<std::string>& row);
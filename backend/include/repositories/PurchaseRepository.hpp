@@ -0,0 +1,27 @@
+#ifndef PURCHASE_REPOSITORY_HPP
+#define PURCHASE_REPOSITORY_HPP
+
+#include "../header.hpp"
+#include "../entities/Purchase.hpp"
+
+class DatabaseManager;
+
+class PurchaseRepository {
+  private:
+    DatabaseManager& database;
+
+  public:
+    PurchaseRepository(DatabaseManager& db);
+
+    bool save(Purchase& purchase);             // Insert one purchase and store its new ID
+    bool saveAll(const V<Purchase>& purchases); // Insert many purchases with multi-row INSERTs (caller owns the transaction)
+    V<Purchase> findByTrip(int tripId);        // Get purchases made on a specific trip
+
+  private:
+    Purchase mapRowToEntity(const std::vector<std::string>& row);  // converts a database row to a Purchase object
+    static std::string buildValues(const Purchase& purchase);      // "(city_id, food_id, quantity, trip_id, unit_price_cents)" for an INSERT
+
+};
+
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef SPENDING_REPOSITORY_HPP
+#define SPENDING_REPOSITORY_HPP
+
+#include "../header.hpp"
+
+class DatabaseManager;
+
+// Which aggregate table a spending row comes from
+enum class SpendingScope {
+    Trip,
+    City,
+    Food
+};
+
+// One row of trip_spending, city_spending or food_spending
+struct SpendingTotals {
+    int id = 0;                 // trip, city or food ID depending on the scope
+    int purchaseCount = 0;      // purchases recorded
+    long long itemCount = 0;    // sum of quantities
+    long long totalCents = 0;   // sum of quantity * price, in cents
+};
+
+// An aggregate row that disagrees with a from-scratch recount of purchases
+struct SpendingMismatch {
+    SpendingScope scope;
+    SpendingTotals stored;      // what the aggregate table holds
+    SpendingTotals expected;    // what GROUP BY over purchases gives
+};
+
+class SpendingRepository {
+private:
+    DatabaseManager& database;
+
+public:
+    SpendingRepository(DatabaseManager& database);
+
+    // Reads the maintained aggregate row - a primary key lookup. Returns
+    // false if nothing has been bought for that ID yet.
+    bool findTotals(SpendingScope scope, int id, SpendingTotals& totals);
+
+    // Recomputes every aggregate from purchases and returns the rows that
+    // differ, including aggregate rows with no purchases behind them
+    V<SpendingMismatch> findMismatches(SpendingScope scope);
+
+    // Replaces an aggregate table with a fresh recount (caller owns the transaction)
+    bool rebuild(SpendingScope scope);
+
+    static std::string scopeToString(SpendingScope scope);
+
+private:
+    static std::string tableFor(SpendingScope scope);
+    static std::string keyFor(SpendingScope scope);
+    static std::string buildRecountQuery(SpendingScope scope);
+};
+
+#endif
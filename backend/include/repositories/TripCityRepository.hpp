@@ -4,6 +4,7 @@
 #include "../header.hpp"
 #include "../databaseManager.hpp"
 #include "../entities/TripCity.hpp"
+#include <functional>
 
 /**
  * @class TripCityRepository
@@ -77,14 +78,46 @@ public:
      */
     bool existsByTripAndOrder(int tripId, int visitOrder);
     
+    // Keyset pagination
+    /**
+     * @brief Get one page of TripCity rows ordered by ID
+     * @param afterId Only rows with an ID greater than this (0 for the first page)
+     * @param limit Maximum number of rows to return
+     * @param tripId Restrict to one trip, or 0 for every trip
+     * @return Up to limit TripCity objects
+     * @note Pass the last ID of a page as afterId to get the next page
+     */
+    V<TripCity> findPage(int afterId, int limit, int tripId = 0);
+    
+    /**
+     * @brief Visit one page of TripCity rows without collecting them
+     * @param afterId Only rows with an ID greater than this
+     * @param limit Maximum number of rows to visit
+     * @param tripId Restrict to one trip, or 0 for every trip
+     * @param onTripCity Called for each row; return false to stop early
+     * @return true if the query ran, false on a database error
+     */
+    bool forEachInPage(int afterId, int limit, int tripId,
+                       const std::function<bool(const TripCity&)>& onTripCity);
+    
     // Batch operations
     /**
      * @brief Save multiple TripCity entities at once
      * @param tripCities Vector of TripCity objects to save
      * @return true if all successful, false if any fails
+     * @note New rows (ID 0) are written with multi-row INSERTs
      */
     bool saveAll(const V<TripCity>& tripCities);
     
+    /**
+     * @brief Rewrite the visit order of every stop of a trip
+     * @param tripId The trip to reorder
+     * @param tripCityIds IDs of all the trip's trip_cities rows in their new order
+     * @return true if successful, false otherwise
+     * @note Two whole-trip UPDATEs regardless of trip size; callers own the transaction
+     */
+    bool reorderTrip(int tripId, const V<int>& tripCityIds);
+    
     /**
      * @brief Remove all cities from a specific trip
      * @param tripId The trip ID to clear
@@ -92,6 +125,25 @@ public:
      */
     bool removeByTrip(int tripId);
     
+    // Incremental route edits (callers own the transaction)
+    /**
+     * @brief Move every stop at or after a visit order by delta positions
+     * @param tripId The trip to edit
+     * @param fromOrder First visit order to move
+     * @param delta Positions to move by (negative moves stops earlier)
+     * @return true if successful, false otherwise
+     * @note Only the moved rows are rewritten
+     */
+    bool shiftVisitOrders(int tripId, int fromOrder, int delta);
+    
+    /**
+     * @brief Remove the stop at one visit order of a trip
+     * @param tripId The trip to edit
+     * @param visitOrder The visit order to remove
+     * @return true if successful, false otherwise
+     */
+    bool removeByTripAndOrder(int tripId, int visitOrder);
+    
 private:
     // Helper methods
     /**
@@ -141,6 +193,15 @@ private:
      * @return SQL SELECT query string
      */
     std::string buildSelectByTripQuery(int tripId);
+    
+    /**
+     * @brief Build keyset page SELECT SQL query for TripCity
+     * @param afterId Only rows with an ID greater than this
+     * @param limit Maximum number of rows
+     * @param tripId Restrict to one trip, or 0 for every trip
+     * @return SQL SELECT query string
+     */
+    std::string buildSelectPageQuery(int afterId, int limit, int tripId);
 };
 
 #endif
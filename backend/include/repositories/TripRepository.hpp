@@ -3,9 +3,16 @@
 
 #include "../header.hpp"
 #include "../entities/Trip.hpp"
+#include <functional>
 
 class DatabaseManager;
 
+// A trip whose kind, start city and ordered city list match an older trip's
+struct TripDuplicate {
+    int canonicalId;  // oldest trip with the same route
+    int duplicateId;
+};
+
 class TripRepository {
 private:
     DatabaseManager& database;
@@ -14,8 +21,8 @@ public:
     TripRepository(DatabaseManager& database);
 
     // This function will return a vector of trip objects
-    // that match the trip type (starting city)
-    V<Trip> findByType(const std::string& tripType);
+    // that match the trip kind
+    V<Trip> findByType(TripKind tripKind);
 
     // This function is for custom start city
     V<Trip> findByStartCity(int startCityId);
@@ -37,6 +44,47 @@ public:
     bool load(int id, Trip& trip);           // Load trip by ID
     V<Trip> findAll();                       // Get all trips
 
+    // Adds delta (possibly negative) to a trip's total_distance in place,
+    // for incremental route edits that know the change without re-summing
+    bool addToTotalDistance(int tripId, double delta);
+
+    // Overwrites a trip's total_distance, for edits that recompute the whole route
+    bool setTotalDistance(int tripId, double totalDistance);
+
+    // Keyset pagination: at most `limit` trips with id > afterId, ordered by
+    // id. TripKind::Unknown matches every kind. Pass the last id of one page
+    // as afterId to fetch the next, so each page is an index range scan no
+    // matter how deep into the table it is.
+    V<Trip> findPage(int afterId, int limit, TripKind tripKind = TripKind::Unknown);
+
+    // Same rows as findPage, handed to onTrip one at a time instead of being
+    // collected. Return false from onTrip to stop early.
+    bool forEachInPage(int afterId, int limit, TripKind tripKind,
+                       const std::function<bool(const Trip&)>& onTrip);
+
+    // Maintenance queries used by TripMaintenanceService. Each works on at
+    // most `limit` trips so callers can keep their transactions short.
+
+    // Trips of the given kinds created before the cutoff that no purchase refers to
+    V<int> findExpiredUnreferencedIds(const V<TripKind>& kinds, long long createdBefore, int limit);
+
+    // Trips of the given kinds created before the cutoff that repeat an older
+    // trip's route, lowest duplicate id first. Grouping happens in SQLite, so
+    // the caller never holds more than one page; merged duplicates are gone
+    // from the next call, so callers page by calling again.
+    V<TripDuplicate> findDuplicateRoutes(const V<TripKind>& kinds, long long createdBefore, int limit);
+
+    // Points purchases at the canonical trip, then deletes the duplicates
+    bool mergeDuplicates(int canonicalId, const V<int>& duplicateIds);
+
+    // Deletes trips and their trip_cities rows
+    bool deleteByIds(const V<int>& ids);
+
+private:
+    static std::string joinIds(const V<int>& ids);
+    static std::string joinKinds(const V<TripKind>& kinds);
+    static std::string buildPageQuery(int afterId, int limit, TripKind tripKind);
+
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef API_APP_HPP
+#define API_APP_HPP
+
+#include <crow.h>
+#include <cstddef>
+#include <string>
+
+/**
+ * @struct BodyParseLimit
+ * @brief Crow middleware that answers 413 to request bodies over maxBytes
+ *
+ * Runs before any route, so handlers never JSON-parse or validate an
+ * oversized body. It is a parse limit, not a payload cap: Crow has already
+ * read the whole body into req.body by the time middleware runs, so it does
+ * not bound the memory or time spent receiving it.
+ */
+struct BodyParseLimit {
+    struct context {};
+
+    size_t maxBytes = 1024 * 1024;
+
+    void before_handle(crow::request& req, crow::response& res, context&) {
+        if (req.body.size() > maxBytes) {
+            crow::json::wvalue error;
+            error["error"] = "Request body too large";
+            error["max_bytes"] = maxBytes;
+            res = crow::response(413, error);
+            res.end();
+        }
+    }
+
+    void after_handle(crow::request&, crow::response&, context&) {}
+};
+
+// The Crow application type every route registers on
+using ApiApp = crow::App<BodyParseLimit>;
+
+#endif
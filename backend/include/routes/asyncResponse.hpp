@@ -0,0 +1,59 @@
+#ifndef ASYNC_RESPONSE_HPP
+#define ASYNC_RESPONSE_HPP
+
+#include <crow.h>
+#include "../databaseExecutor.hpp"
+#include <exception>
+#include <type_traits>
+
+/**
+ * @brief Finish a request on a database thread instead of the Crow I/O thread
+ *
+ * The handler returns as soon as the work is queued; Crow keeps the
+ * connection open until res.end() is called, and the I/O thread goes back to
+ * serving other requests meanwhile. The connection owns both req and res
+ * until then, so the body may capture them by reference.
+ *
+ * If every DB thread is busy and the executor's queue is full, the request
+ * is answered 429 on the calling thread instead, like the job and purchase
+ * queues do.
+ *
+ * @param res The response Crow handed to the route
+ * @param body Either returns a crow::response, or takes crow::response& and ends it itself
+ */
+template <typename Body>
+void respondAsync(crow::response& res, Body body) {
+    bool queued = DatabaseExecutor::getInstance().post([&res, body]() mutable {
+        try {
+            if constexpr (std::is_invocable_v<Body&, crow::response&>) {
+                body(res);
+            } else {
+                res = body();
+                res.end();
+            }
+        } catch (const std::exception& e) {
+            crow::json::wvalue error;
+            error["error"] = "Internal server error";
+            error["message"] = e.what();
+            res = crow::response(500, error);
+            res.end();
+        } catch (...) {
+            // Anything else would leave the connection open with no response
+            crow::json::wvalue error;
+            error["error"] = "Internal server error";
+            res = crow::response(500, error);
+            res.end();
+        }
+    });
+
+    if (!queued) {
+        crow::json::wvalue error;
+        error["error"] = "Server is busy";
+        error["message"] = "Too many requests are waiting for the database, retry shortly";
+        res = crow::response(429, error);
+        res.set_header("Retry-After", "1");
+        res.end();
+    }
+}
+
+#endif
@@ -2,10 +2,10 @@
 #define CITY_ROUTES_HPP
 
 #include <crow.h>
-#include "../services/CityService.hpp"
+#include "apiApp.hpp"
 #include "../services/FoodService.hpp"
-#include "../repositories/CityDistanceRepository.hpp"
+#include "../services/ReferenceDataCache.hpp"
 
-void registerCityRoutes(crow::SimpleApp& app, CityService& cityService, FoodService& foodService, CityDistanceRepository& cityDistanceRepo);
+void registerCityRoutes(ApiApp& app, FoodService& foodService, ReferenceDataCache& referenceData);
 
 #endif
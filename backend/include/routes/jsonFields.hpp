@@ -0,0 +1,54 @@
+#ifndef JSON_FIELDS_HPP
+#define JSON_FIELDS_HPP
+
+#include <crow.h>
+#include "../V.hpp"
+#include <climits>
+#include <cmath>
+
+/**
+ * @brief Read a JSON number that is a whole number and fits an int
+ *
+ * crow's .i() truncates 2.5 to 2 and wraps 1e20 around, so an ID read with
+ * it can silently name a different row. These helpers reject such values.
+ * @return false if the value is not a number, has a fraction or is out of int range
+ */
+inline bool readIntegerValue(const crow::json::rvalue& json, int& value) {
+    if (json.t() != crow::json::type::Number) {
+        return false;
+    }
+    double number = json.d();
+    if (number != std::floor(number) || number < INT_MIN || number > INT_MAX) {
+        return false;
+    }
+    value = (int)number;
+    return true;
+}
+
+/**
+ * @brief Read an integer field of a JSON object
+ * @return false if the field is missing or not a whole number that fits an int
+ */
+inline bool readInteger(const crow::json::rvalue& json, const char* field, int& value) {
+    return json.t() == crow::json::type::Object && json.has(field) && readIntegerValue(json[field], value);
+}
+
+/**
+ * @brief Read an array field of integers, appending them to values
+ * @return false if the field is missing, not an array, or holds anything but whole ints
+ */
+inline bool readIntegerList(const crow::json::rvalue& json, const char* field, V<int>& values) {
+    if (json.t() != crow::json::type::Object || !json.has(field) || json[field].t() != crow::json::type::List) {
+        return false;
+    }
+    for (const auto& element : json[field]) {
+        int value;
+        if (!readIntegerValue(element, value)) {
+            return false;
+        }
+        values.push_back(value);
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef PURCHASE_ROUTES_HPP
+#define PURCHASE_ROUTES_HPP
+
+#include <crow.h>
+#include "apiApp.hpp"
+#include "../services/PurchaseService.hpp"
+
+void registerPurchaseRoutes(ApiApp& app, PurchaseService& purchaseService);
+
+#endif
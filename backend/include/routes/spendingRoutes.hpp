@@ -0,0 +1,10 @@
+#ifndef SPENDING_ROUTES_HPP
+#define SPENDING_ROUTES_HPP
+
+#include <crow.h>
+#include "apiApp.hpp"
+#include "../services/SpendingService.hpp"
+
+void registerSpendingRoutes(ApiApp& app, SpendingService& spendingService);
+
+#endif
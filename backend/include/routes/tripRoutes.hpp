@@ -2,10 +2,14 @@
 #define TRIP_ROUTES_HPP
 
 #include <crow.h>
+#include "apiApp.hpp"
 #include "../services/TripService.hpp"
-#include "../services/CityService.hpp"
+#include "../services/ReferenceDataCache.hpp"
 #include "../services/tripCityService.hpp"
+#include "../services/TripJobService.hpp"
+#include "../services/FoodService.hpp"
 
-void registerTripRoutes(crow::SimpleApp& app, TripService& tripService, CityService& cityService, TripCityService& tripCityService);
+void registerTripRoutes(ApiApp& app, TripService& tripService, ReferenceDataCache& referenceData, TripCityService& tripCityService,
+                        TripJobService& tripJobService, FoodService& foodService);
 
 #endif
\ No newline at end of file
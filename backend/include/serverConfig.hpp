@@ -0,0 +1,47 @@
+/**
+ * Server Configuration
+ * Startup settings for the API server, read from the environment and command line
+ */
+
+#ifndef SERVER_CONFIG_HPP
+#define SERVER_CONFIG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @struct ServerConfig
+ * @brief Port, worker threads and request limits for the Crow server
+ *
+ * Defaults are overridden first by environment variables, then by command
+ * line flags:
+ *
+ *   API_PORT               --port N           TCP port (default 3001)
+ *   API_THREADS            --threads N        Crow worker threads (default: one per core)
+ *   API_KEEPALIVE_TIMEOUT  --timeout S        Seconds an idle keep-alive connection stays open (default 5)
+ *   API_MAX_BODY_PARSE     --max-body-parse B Largest request body routes will parse, in bytes (default 1 MiB)
+ *   API_DB_THREADS         --db-threads N     Threads finishing database-bound requests (default 2)
+ */
+struct ServerConfig {
+    uint16_t port = 3001;
+    unsigned workerThreads = 0;          ///< 0 until load() picks one per core
+    uint8_t keepAliveTimeoutSeconds = 5;
+    size_t maxBodyParseBytes = 1024 * 1024;  ///< See BodyParseLimit; Crow has read the body by then
+    unsigned databaseThreads = 2;        ///< Size of the DatabaseExecutor pool
+
+    /**
+     * @brief Build the configuration for this process
+     * @param config Populated with the defaults and every override
+     * @param error Set to a description of the first invalid setting
+     * @return false if a setting was invalid or a flag unknown
+     */
+    static bool load(int argc, char* argv[], ServerConfig& config, std::string& error);
+
+    /**
+     * @brief One-line summary for the startup log
+     */
+    std::string describe() const;
+};
+
+#endif
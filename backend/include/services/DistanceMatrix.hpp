@@ -0,0 +1,149 @@
+#ifndef DISTANCE_MATRIX_HPP
+#define DISTANCE_MATRIX_HPP
+
+#include "../header.hpp"
+#include "../entities/CityDistance.hpp"
+#include "../entities/CityDistanceTable.hpp"
+#include <cstdint>
+
+/**
+ * @class DistanceMatrix
+ * @brief Dense in-memory copy of the city_distances table
+ *
+ * Every city that appears in a distance gets a dense index (in ascending ID
+ * order) when the matrix is built, and the matrix is indexed by those, so
+ * its size is the square of the number of cities rather than of the largest
+ * ID. getDistance(from, to) is two index lookups and one array read instead
+ * of a SQL query. Pairs without a row in city_distances hold NO_EDGE.
+ */
+class DistanceMatrix {
+private:
+    int maxCityId;               ///< Largest city ID present
+    std::vector<int> indexOf;    ///< City ID -> dense index, -1 for IDs without a distance (maxCityId + 1 entries)
+    std::vector<int> cityIds;    ///< Dense index -> city ID, ascending
+    std::vector<int> distances;  ///< Row-major cityCount x cityCount distances, by dense index
+    size_t edgeCount;            ///< Number of pairs with a known distance
+    int neighbourCount;          ///< Entries per city in `neighbours` (0 until buildNeighbourLists)
+    std::vector<int> neighbours; ///< Row-major cityCount x neighbourCount city IDs, nearest first, -1 padded
+
+    // Index the given IDs (ascending, unique, > 0) and size the matrix for them
+    void indexCities(std::vector<int> ids);
+
+public:
+    static constexpr int NO_EDGE = -1;
+    static const int NEIGHBOUR_LIST_SIZE = 10; ///< Default k for buildNeighbourLists
+
+    DistanceMatrix();
+    explicit DistanceMatrix(const V<CityDistance>& rows);
+
+    /**
+     * @brief Fill the matrix straight from a columnar table, one city's slice at a time
+     */
+    explicit DistanceMatrix(const CityDistanceTable& table);
+
+    /**
+     * @brief Wrap an already computed matrix (e.g. a shortest-path closure)
+     * @param cityIds The cities, ascending; position i is dense index i
+     * @param distances cityIds.size() x cityIds.size() values by dense index, NO_EDGE for unknown pairs
+     */
+    DistanceMatrix(std::vector<int> cityIds, std::vector<int> distances);
+
+    /**
+     * @brief Dense index of a city
+     * @return 0 .. getCityCount() - 1, or -1 for a city without any distance
+     */
+    int getIndex(int cityId) const {
+        if (cityId <= 0 || cityId > maxCityId) {
+            return -1;
+        }
+        return indexOf[cityId];
+    }
+
+    /**
+     * @brief Distance in km between two cities
+     * @return The distance, or NO_EDGE if the pair is unknown
+     */
+    int getDistance(int fromCityId, int toCityId) const {
+        int from = getIndex(fromCityId);
+        int to = getIndex(toCityId);
+        if (from < 0 || to < 0) {
+            return NO_EDGE;
+        }
+        return distances[(size_t)from * cityIds.size() + to];
+    }
+
+    /**
+     * @brief Every distance from one city, indexed by the destination's dense index
+     * @return getCityCount() values (NO_EDGE for unknown pairs), or nullptr for an unknown city
+     */
+    const int* getRow(int fromCityId) const {
+        int from = getIndex(fromCityId);
+        if (from < 0) {
+            return nullptr;
+        }
+        return &distances[(size_t)from * cityIds.size()];
+    }
+
+    /**
+     * @brief Number of indexed cities (the matrix is this many squared)
+     */
+    int getCityCount() const {
+        return (int)cityIds.size();
+    }
+
+    /**
+     * @brief City ID at a dense index
+     */
+    int getCityId(int index) const {
+        return cityIds[index];
+    }
+
+    /**
+     * @brief Precompute each city's k nearest reachable cities in one contiguous buffer
+     *
+     * Ties are ordered by city ID. A city with fewer than k reachable cities
+     * lists them all, followed by -1.
+     */
+    void buildNeighbourLists(int k = NEIGHBOUR_LIST_SIZE);
+
+    /**
+     * @brief Length of every neighbour list (0 if none were built)
+     */
+    int getNeighbourCount() const {
+        return neighbourCount;
+    }
+
+    /**
+     * @brief The nearest cities to cityId, closest first
+     * @return getNeighbourCount() city IDs (-1 past the last reachable city), or nullptr
+     *         for an unknown city or when no lists were built
+     */
+    const int* getNeighbours(int cityId) const {
+        int index = getIndex(cityId);
+        if (neighbourCount == 0 || index < 0) {
+            return nullptr;
+        }
+        return &neighbours[(size_t)index * neighbourCount];
+    }
+
+    /**
+     * @brief Append the matrix in the compact binary format
+     *
+     * Little-endian, 16-byte header, then the city IDs, then the matrix:
+     *
+     *   bytes 0-3    magic "CDM2"
+     *   bytes 4-7    uint32 n (number of cities)
+     *   bytes 8-15   uint64 dataVersion
+     *   next 4n      int32 city IDs, ascending; row/column i belongs to the i-th ID
+     *   next 4n^2    n x n int32 distances, row-major
+     *
+     * Unknown pairs hold NO_EDGE.
+     */
+    void appendBinary(std::string& out, uint64_t dataVersion) const;
+
+    bool hasCity(int cityId) const;
+    int getMaxCityId() const;
+    size_t getEdgeCount() const;
+};
+
+#endif
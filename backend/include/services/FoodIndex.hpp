@@ -0,0 +1,71 @@
+#ifndef FOOD_INDEX_HPP
+#define FOOD_INDEX_HPP
+
+#include "../header.hpp"
+#include "../entities/Food.hpp"
+#include <cstdint>
+#include <limits>
+
+/**
+ * @struct FoodQuery
+ * @brief Filters for FoodIndex::search; defaults match every food
+ */
+struct FoodQuery {
+    int cityId = 0;                 ///< Only foods sold in this city (0 = any city)
+    double minPrice = 0.0;          ///< Inclusive lower price bound
+    double maxPrice = std::numeric_limits<double>::infinity(); ///< Inclusive upper price bound
+    std::string namePrefix;         ///< Case-insensitive name prefix (empty = any name)
+    size_t limit = 50;              ///< Most results returned
+};
+
+/**
+ * @class FoodIndex
+ * @brief Immutable sorted views over the foods table
+ *
+ * The foods are stored once, ordered by ID, and three index arrays give
+ * them by (price), by (city, price) and by lower-cased name. A query binary
+ * searches the matching array and walks forward, so price ranges, the k
+ * cheapest foods (overall or in one city) and name prefixes cost
+ * O(log n + results) instead of a scan of every food.
+ */
+class FoodIndex {
+private:
+    std::vector<Food> foods;                                  ///< Every food, by ID
+    std::vector<uint32_t> byPrice;                            ///< Positions ordered by (price, id)
+    std::vector<uint32_t> byCityPrice;                        ///< Positions ordered by (city, price, id)
+    std::vector<std::pair<std::string, uint32_t>> byName;     ///< (lower-cased name, position), by name
+
+public:
+    FoodIndex();
+    explicit FoodIndex(const V<Food>& rows);
+
+    /**
+     * @brief Look a food up by ID
+     * @return The food, or nullptr if there is none with that ID
+     */
+    const Food* findById(int foodId) const;
+
+    /**
+     * @brief Foods matching the query
+     * @return Up to query.limit foods, cheapest first, or in name order
+     *         when a name prefix is given
+     */
+    V<Food> search(const FoodQuery& query) const;
+
+    /**
+     * @brief Number of foods in a price range, without listing them
+     * @param cityId Restrict to one city (0 = any city)
+     */
+    size_t countInPriceRange(double minPrice, double maxPrice, int cityId = 0) const;
+
+    /**
+     * @brief Every food, ordered by ID
+     */
+    const std::vector<Food>& getAll() const;
+
+    size_t size() const;
+
+    static std::string toLower(const std::string& text);
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef FOOD_PLANNER_HPP
+#define FOOD_PLANNER_HPP
+
+#include "../header.hpp"
+#include <map>
+
+/**
+ * @struct FoodPlanItem
+ * @brief One food the planner may buy, with its price in cents and how much it is worth
+ */
+struct FoodPlanItem {
+    int foodId = 0;
+    int cityId = 0;
+    std::string name;
+    long long priceCents = 0;
+    double score = 1.0;      ///< Value of one unit (taste rating, defaults to 1)
+    int maxQuantity = 1;     ///< Most units of this food that may be bought
+};
+
+/**
+ * @struct FoodPlanChoice
+ * @brief A food picked by the planner and how many to buy
+ */
+struct FoodPlanChoice {
+    int foodId = 0;
+    int cityId = 0;
+    std::string name;
+    int quantity = 0;
+    long long priceCents = 0;  ///< Price of one unit
+    double score = 0.0;        ///< Score of one unit
+};
+
+/**
+ * @struct FoodPlan
+ * @brief Result of a budget-constrained food selection
+ */
+struct FoodPlan {
+    bool feasible = false;
+    std::string error;           ///< Why no plan exists (set when !feasible)
+    long long budgetCents = 0;
+    long long spentCents = 0;
+    double totalScore = 0.0;
+    V<FoodPlanChoice> choices;
+};
+
+/**
+ * @class FoodPlanner
+ * @brief Picks the highest scoring basket of foods that fits a budget
+ *
+ * Solves a bounded knapsack: every food has a price, a score and a maximum
+ * quantity, and cities may require a minimum number of items. Quantities are
+ * binary split (1, 2, 4, ... units) so each food adds O(log maxQuantity)
+ * 0/1 items to a dense DP over the budget in cents. Prices and budget are
+ * first divided by their greatest common divisor, so menus priced in whole
+ * or half euros need far fewer DP columns.
+ *
+ * A city with a minimum of m items keeps m + 1 DP rows while its foods are
+ * processed (items bought there so far, capped at m), so minimums cost
+ * O(m) extra per food of that city only.
+ */
+class FoodPlanner {
+public:
+    /// Most memory solve() will allocate for its tables (decisions and DP rows), in bytes
+    static const size_t MAX_TABLE_BYTES = 64 * 1024 * 1024;
+
+    /// Largest per-city minimum supported
+    static const int MAX_CITY_MINIMUM = 254;
+
+    /**
+     * @brief Choose quantities that maximize total score within the budget
+     * @param items Foods available, with prices, scores and quantity limits
+     * @param budgetCents Most that may be spent
+     * @param cityMinimums City ID -> least number of items to buy there
+     * @return The best plan, or feasible = false with an error message
+     */
+    static FoodPlan solve(const V<FoodPlanItem>& items, long long budgetCents,
+                          const std::map<int, int>& cityMinimums);
+};
+
+#endif
@@ -3,9 +3,20 @@
 
 #include "../header.hpp"
 #include "../entities/Food.hpp"
+#include "FoodPlanner.hpp"
+#include <map>
 
 class FoodRepository;
 
+// What a customer asks of a food plan: a budget, optional scores and limits
+struct FoodPlanRequest {
+    long long budgetCents = 0;
+    std::map<int, int> cityMinimums;     // city ID -> least number of items to buy there
+    std::map<int, double> scores;        // food ID -> score per unit (unlisted foods score 1)
+    int defaultMaxQuantity = 1;          // units allowed per food unless listed below
+    std::map<int, int> maxQuantities;    // food ID -> units allowed
+};
+
 class FoodService {
 private:
     FoodRepository& foodRepo;
@@ -16,6 +27,9 @@ public:
     V<Food> getAllFoods();                    // Get all foods from the database
     V<Food> getFoodsByCityId(int cityId);     // Get foods for a specific city
 
+    // Best scoring selection of foods sold in the given cities within the budget
+    FoodPlan planFoodsForCities(const V<int>& cityIds, const FoodPlanRequest& request);
+
     void displayAllFoods();                   // Display all foods on screen
     void displayFoodsByCityId(int cityId);    // Display foods for a specific city
 
@@ -0,0 +1,154 @@
+#ifndef PURCHASE_SERVICE_HPP
+#define PURCHASE_SERVICE_HPP
+
+#include "../header.hpp"
+#include "../entities/Purchase.hpp"
+#include "../repositories/PurchaseRepository.hpp"
+#include "../repositories/TripRepository.hpp"
+#include "ReferenceDataCache.hpp"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/**
+ * @struct PurchaseLedgerConfig
+ * @brief Tuning knobs for the purchase write-behind queue
+ */
+struct PurchaseLedgerConfig {
+    size_t maxBatchSize = 256;         ///< Purchases written per transaction
+    int flushIntervalMs = 20;          ///< Longest a purchase waits for its batch to fill
+    size_t maxQueuedPurchases = 8192;  ///< Queue capacity before submissions are rejected
+    size_t maxTrackedFailures = 4096;  ///< Failed sequence numbers remembered for acks
+};
+
+/**
+ * @brief Durability of a submitted purchase
+ */
+enum class PurchaseAckStatus {
+    Pending,  ///< Queued or being written
+    Durable,  ///< Committed to the database
+    Failed,   ///< Rejected by the database and dropped
+    Unknown   ///< Sequence number never issued, or too old to be tracked
+};
+
+/**
+ * @struct PurchaseTicket
+ * @brief Sequence numbers handed out for one submission (inclusive range)
+ */
+struct PurchaseTicket {
+    long long firstSequence = 0;
+    long long lastSequence = 0;
+};
+
+/**
+ * @class PurchaseService
+ * @brief Validates purchases and writes them behind the request
+ *
+ * Purchases are appended to an in-memory queue and a single flusher thread
+ * writes them in grouped transactions of up to maxBatchSize rows, or
+ * whatever has arrived after flushIntervalMs. A checkout burst therefore
+ * costs one commit per batch instead of one per purchase.
+ *
+ * Every queued purchase gets a sequence number. Batches are written in
+ * sequence order, so once the flusher has decided a batch every lower
+ * sequence number is decided too; callers poll getStatus() or block in
+ * waitFor() to learn whether their purchases reached the database. If a
+ * grouped transaction fails, its purchases are retried one by one so a
+ * single bad row does not take the rest of the batch down with it.
+ */
+class PurchaseService {
+private:
+    struct QueuedPurchase {
+        long long sequence;
+        Purchase purchase;
+    };
+
+    PurchaseRepository& purchaseRepo;
+    TripRepository& tripRepo;
+    ReferenceDataCache& referenceData;
+    PurchaseLedgerConfig config;
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;  ///< Signalled when purchases are queued
+    std::condition_variable batchDecided;   ///< Signalled after every flush
+    std::deque<QueuedPurchase> queue;
+    std::deque<long long> failedSequences;  ///< Ascending, capped at maxTrackedFailures
+    long long nextSequence;
+    long long decidedThrough;   ///< Every sequence up to this one is durable or failed
+    long long forgottenThrough; ///< Failures up to this one were dropped from failedSequences
+    bool stopping;
+    std::thread flusher;
+
+public:
+    /**
+     * @brief Constructor - starts the flusher thread
+     * @param purchaseRepo Repository the batches are written through
+     * @param tripRepo Trips a purchase may be tied to
+     * @param referenceData Cached foods used to validate submissions
+     * @param config Batch size, flush interval and queue limits
+     */
+    PurchaseService(PurchaseRepository& purchaseRepo, TripRepository& tripRepo, ReferenceDataCache& referenceData,
+                    const PurchaseLedgerConfig& config = PurchaseLedgerConfig());
+
+    /**
+     * @brief Destructor - writes everything still queued, then joins the flusher
+     */
+    ~PurchaseService();
+
+    PurchaseService(const PurchaseService&) = delete;
+    PurchaseService& operator=(const PurchaseService&) = delete;
+
+    /**
+     * @brief Check a purchase before it is queued
+     *
+     * Looks the trip up in the database (foreign keys are off, so nothing else
+     * stops a purchase for a missing trip); call it off the HTTP I/O threads.
+     * @param purchase The purchase to check
+     * @return Empty string if valid, otherwise the reason it was rejected
+     */
+    std::string validate(const Purchase& purchase);
+
+    /**
+     * @brief Queue purchases for writing
+     * @param purchases Validated purchases, written in the given order
+     * @param ticket Receives the sequence numbers assigned to them
+     * @return false if the queue has no room for all of them (nothing is queued)
+     */
+    bool submit(const V<Purchase>& purchases, PurchaseTicket& ticket);
+
+    /**
+     * @brief Current durability of one purchase
+     * @param sequence Sequence number from a ticket
+     */
+    PurchaseAckStatus getStatus(long long sequence);
+
+    /**
+     * @brief Combined durability of an inclusive range of sequence numbers
+     * @return Failed if any was dropped, Pending until all are decided
+     */
+    PurchaseAckStatus getStatus(long long firstSequence, long long lastSequence);
+
+    /**
+     * @brief Block until every purchase in the ticket is decided or the timeout expires
+     * @param ticket Ticket returned by submit()
+     * @param timeoutMs How long to wait
+     * @return Durable if all were written, Failed if any was dropped, Pending on timeout
+     */
+    PurchaseAckStatus waitFor(const PurchaseTicket& ticket, int timeoutMs);
+
+    /**
+     * @brief Purchases waiting to be written
+     */
+    size_t queuedCount();
+
+    static std::string statusToString(PurchaseAckStatus status);
+
+private:
+    void flusherLoop();
+    void writeBatch(const V<QueuedPurchase>& batch);
+    bool writeInTransaction(const V<Purchase>& purchases);
+    PurchaseAckStatus statusLocked(long long firstSequence, long long lastSequence);
+};
+
+#endif
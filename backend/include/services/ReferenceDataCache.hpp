@@ -0,0 +1,142 @@
+#ifndef REFERENCE_DATA_CACHE_HPP
+#define REFERENCE_DATA_CACHE_HPP
+
+#include "../header.hpp"
+#include "../entities/City.hpp"
+#include "../entities/CityDistanceTable.hpp"
+#include "../repositories/CityRepository.hpp"
+#include "../repositories/CityDistanceRepository.hpp"
+#include "../repositories/FoodRepository.hpp"
+#include "DistanceMatrix.hpp"
+#include "FoodIndex.hpp"
+#include "ShortestPaths.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+/**
+ * @struct ReferenceDataSnapshot
+ * @brief One immutable, consistent copy of the cities, distances and foods
+ *
+ * Everything a request reads from one snapshot comes from the same load, so
+ * a reload can never hand a request new distances next to old foods.
+ */
+struct ReferenceDataSnapshot {
+    uint64_t version;                 ///< Unique per load, increasing over the process lifetime
+    V<City> cities;                   ///< Ordered by name, as CityRepository::findAll returns them
+    CityDistanceTable directDistances; ///< The city_distances rows
+    ShortestPaths shortestPaths;      ///< Built from directDistances
+    FoodIndex foodIndex;
+    std::unordered_map<int, size_t> cityPositions; ///< City ID -> index in cities
+
+    ReferenceDataSnapshot(uint64_t version, V<City> cities, CityDistanceTable directDistances,
+                          const V<Food>& foods);
+
+    /**
+     * @brief The city with this ID, or nullptr if there is none
+     */
+    const City* findCity(int cityId) const;
+
+    /**
+     * @brief Name of the city with this ID, or "Unknown"
+     */
+    std::string cityName(int cityId) const;
+};
+
+/**
+ * @class ReferenceDataCache
+ * @brief Process-wide cache of reference data that planners read repeatedly
+ *
+ * Cities, foods and distances only change on import or admin edits, so they
+ * are loaded into an immutable ReferenceDataSnapshot shared by every request
+ * thread. A reload builds a complete new snapshot without blocking anyone and
+ * then publishes it with one atomic pointer swap (read-copy-update): readers
+ * never take a lock, and requests still holding the old snapshot keep using it
+ * until they drop their shared_ptr.
+ *
+ * Nothing but in-flight requests holds a superseded snapshot, so its distance
+ * tables and food index are freed as soon as the last of them finishes.
+ */
+class ReferenceDataCache {
+private:
+    CityRepository& cityRepo;
+    CityDistanceRepository& cityDistanceRepo;
+    FoodRepository& foodRepo;
+
+    // Only accessed through std::atomic_load / std::atomic_store
+    std::shared_ptr<const ReferenceDataSnapshot> current;
+    std::atomic<uint64_t> currentVersion; ///< current->version, 0 before the first load
+
+    std::mutex reloadMutex; ///< Serializes writers; readers never touch it after the first load
+
+    // Background reloads requested with requestReload()
+    std::mutex workerMutex;
+    std::condition_variable wakeUp;
+    bool reloadRequested;
+    bool stopping;
+    std::thread worker;
+
+public:
+    ReferenceDataCache(CityRepository& cityRepo, CityDistanceRepository& cityDistanceRepo, FoodRepository& foodRepo);
+    ~ReferenceDataCache();
+
+    ReferenceDataCache(const ReferenceDataCache&) = delete;
+    ReferenceDataCache& operator=(const ReferenceDataCache&) = delete;
+
+    /**
+     * @brief The current snapshot, loaded on first use
+     * @note Hold on to the returned pointer for the whole request to read one consistent version
+     */
+    std::shared_ptr<const ReferenceDataSnapshot> getSnapshot();
+
+    /**
+     * @brief Shortest distances between all cities, from the current snapshot
+     *
+     * Pairs without a row in city_distances get the length of the shortest
+     * chain of known legs, so planners always see a complete metric.
+     */
+    std::shared_ptr<const DistanceMatrix> getDistanceMatrix();
+
+    /**
+     * @brief The shortest paths behind getDistanceMatrix(), with next hops to rebuild them
+     */
+    std::shared_ptr<const ShortestPaths> getShortestPaths();
+
+    /**
+     * @brief Every food, indexed by ID, price, city and name
+     */
+    std::shared_ptr<const FoodIndex> getFoodIndex();
+
+    /**
+     * @brief Every city, ordered by name
+     */
+    std::shared_ptr<const V<City>> getCities();
+
+    /**
+     * @brief Version of the published snapshot (0 if nothing is loaded yet)
+     */
+    uint64_t getVersion() const;
+
+    /**
+     * @brief Load a new snapshot on the calling thread and publish it
+     * @return The new snapshot's version
+     */
+    uint64_t reload();
+
+    /**
+     * @brief Reload on the cache's background thread and return immediately
+     *
+     * Requests that arrive while a reload is pending are folded into it.
+     */
+    void requestReload();
+
+private:
+    std::shared_ptr<const ReferenceDataSnapshot> loadSnapshot();
+    void publish(const std::shared_ptr<const ReferenceDataSnapshot>& snapshot); // caller holds reloadMutex
+    void workerLoop();
+};
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef RESPONSE_CACHE_HPP
+#define RESPONSE_CACHE_HPP
+
+#include "../header.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+
+/**
+ * @brief HTTP content codings the server can produce
+ */
+enum class ContentEncoding {
+    Identity,
+    Gzip,
+    Deflate
+};
+
+/**
+ * @brief Header value for a coding ("gzip", "deflate"; "identity" for none)
+ */
+const char* contentEncodingName(ContentEncoding encoding);
+
+/**
+ * @brief Pick the coding to answer an Accept-Encoding header with
+ *
+ * Honours q-values, including q=0 to refuse a coding and "*". Prefers gzip
+ * over deflate when the client weighs them equally. A missing header means
+ * identity.
+ */
+ContentEncoding negotiateEncoding(const std::string& acceptEncoding);
+
+/**
+ * @brief Compress a body with zlib
+ * @param out Receives the gzip stream or the zlib ("deflate") stream
+ * @return false if zlib failed or encoding is Identity
+ */
+bool compressBody(const std::string& body, ContentEncoding encoding, std::string& out);
+
+/**
+ * @struct CachedResponse
+ * @brief One response body with every coding prepared up front
+ */
+struct CachedResponse {
+    uint64_t version = 0;       ///< Data version the body was built from
+    std::string contentType;
+    std::string identity;
+    std::string gzip;           ///< Empty when compressing did not make it smaller
+    std::string deflate;        ///< Empty when compressing did not make it smaller
+
+    /**
+     * @brief The body to send for a negotiated coding
+     * @param encoding Updated to Identity when that coding was not worth storing
+     */
+    const std::string& bodyFor(ContentEncoding& encoding) const;
+};
+
+/**
+ * @class ResponseCache
+ * @brief Response bodies built and compressed once per data version
+ *
+ * Reference responses (all cities, all distances, all foods) only change
+ * when the reference data is reloaded. The first request after a reload
+ * builds the body and compresses it with every supported coding; later
+ * requests for that version copy the stored bytes with no JSON building or
+ * compression. An entry is rebuilt when a request asks for a newer version.
+ */
+class ResponseCache {
+private:
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<const CachedResponse>> entries;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> builds;
+
+public:
+    ResponseCache();
+
+    /**
+     * @brief The entry for key at version, building it with build() if missing or stale
+     * @param build Produces the uncompressed body; may run on several threads at once after a reload
+     */
+    std::shared_ptr<const CachedResponse> get(const std::string& key, uint64_t version, const std::string& contentType,
+                                              const std::function<std::string()>& build);
+
+    uint64_t getHits() const;
+    uint64_t getBuilds() const;
+
+    /**
+     * @brief Total stored bytes over all entries and codings
+     */
+    size_t storedBytes();
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef SHORTEST_PATHS_HPP
+#define SHORTEST_PATHS_HPP
+
+#include "../header.hpp"
+#include "DistanceMatrix.hpp"
+
+/**
+ * @class ShortestPaths
+ * @brief All-pairs shortest paths over the city_distances graph
+ *
+ * Imported city sheets do not always list a distance for every pair, and a
+ * missing pair used to be skipped by the planners. This precomputes the
+ * metric closure: the length of the shortest chain of known legs between
+ * every two cities, plus the first city on that chain (next hop) so the full
+ * path can be rebuilt. Both lookups are O(1) array reads.
+ *
+ * Small or dense graphs use a blocked Floyd-Warshall that walks the matrix
+ * in cache-sized tiles; large sparse graphs run Dijkstra with a binary heap
+ * from every city instead, over the CSR slices of a CityDistanceTable.
+ */
+class ShortestPaths {
+public:
+    enum class Algorithm {
+        FloydWarshall,
+        Dijkstra
+    };
+
+    /// Graphs up to this many cities always use Floyd-Warshall
+    static const int FLOYD_WARSHALL_MAX_CITIES = 512;
+    /// Side of the square tiles the blocked Floyd-Warshall works on
+    static const int BLOCK_SIZE = 32;
+
+private:
+    DistanceMatrix closure;      ///< Shortest distances; NO_EDGE where no path exists
+    std::vector<int> nextHop;    ///< Row-major by dense index: index of the first city after `from` towards `to`, -1 if none
+    Algorithm algorithm;
+    size_t directEdgeCount;      ///< Pairs loaded from city_distances
+    size_t indirectPairCount;    ///< Pairs whose shortest path goes through another city
+
+    void build(const DistanceMatrix& direct, const CityDistanceTable& legs);
+    void floydWarshall(std::vector<int>& dist, int width);
+    void dijkstra(const DistanceMatrix& direct, const CityDistanceTable& legs, std::vector<int>& dist, int width);
+
+public:
+    ShortestPaths();
+    explicit ShortestPaths(const DistanceMatrix& direct);
+
+    /**
+     * @brief Build from the known legs in columnar form; Dijkstra walks the
+     *        table's per-city slices directly as its adjacency lists
+     */
+    explicit ShortestPaths(const CityDistanceTable& legs);
+
+    /**
+     * @brief Shortest distances between all cities, usable anywhere a DistanceMatrix is
+     */
+    const DistanceMatrix& getMetricClosure() const;
+
+    /**
+     * @brief Length of the shortest path in km
+     * @return The distance, or DistanceMatrix::NO_EDGE if `to` cannot be reached
+     */
+    int getDistance(int fromCityId, int toCityId) const {
+        return closure.getDistance(fromCityId, toCityId);
+    }
+
+    /**
+     * @brief First city after fromCityId on the shortest path to toCityId
+     * @return The next city (toCityId itself for a direct leg), or -1 if unreachable
+     */
+    int getNextHop(int fromCityId, int toCityId) const;
+
+    /**
+     * @brief Every city on the shortest path, including both ends
+     * @return The path, or an empty list if toCityId cannot be reached
+     */
+    V<int> getPath(int fromCityId, int toCityId) const;
+
+    Algorithm getAlgorithm() const;
+    size_t getDirectEdgeCount() const;
+    size_t getIndirectPairCount() const;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef SPENDING_SERVICE_HPP
+#define SPENDING_SERVICE_HPP
+
+#include "../header.hpp"
+#include "../repositories/SpendingRepository.hpp"
+
+/**
+ * @class SpendingService
+ * @brief Read side of the spending aggregates
+ *
+ * trip_spending, city_spending and food_spending are updated by SQLite
+ * triggers whenever a purchase is inserted, deleted or moved to another
+ * trip, so totals are a single primary key lookup. Totals use the food
+ * price at the time of the last write; after re-importing foods with new
+ * prices, run rebuild() to recount.
+ */
+class SpendingService {
+private:
+    SpendingRepository& spendingRepo;
+
+public:
+    SpendingService(SpendingRepository& spendingRepo);
+
+    /**
+     * @brief Spending totals for one trip, city or food
+     * @param scope Which aggregate to read
+     * @param id Trip, city or food ID
+     * @return The totals; all zero if nothing has been bought
+     */
+    SpendingTotals getTotals(SpendingScope scope, int id);
+
+    /**
+     * @brief Recount every aggregate from purchases and compare
+     * @return Rows that disagree; empty when the aggregates are consistent
+     */
+    V<SpendingMismatch> checkConsistency();
+
+    /**
+     * @brief Recount every aggregate from purchases in one transaction
+     * @return true if all three tables were rebuilt
+     */
+    bool rebuild();
+};
+
+#endif
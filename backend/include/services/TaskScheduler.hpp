@@ -0,0 +1,203 @@
+#ifndef TASK_SCHEDULER_HPP
+#define TASK_SCHEDULER_HPP
+
+#include "../header.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class CancellationToken
+ * @brief Shared flag that asks work to stop early
+ *
+ * Copies share the same flag, so a token handed to many tasks is cancelled
+ * for all of them at once. Cancellation is cooperative: tasks not yet
+ * started are skipped, running ones check isCancelled() when they can.
+ */
+class CancellationToken {
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled;
+
+public:
+    CancellationToken() : cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const {
+        cancelled->store(true, std::memory_order_release);
+    }
+
+    bool isCancelled() const {
+        return cancelled->load(std::memory_order_acquire);
+    }
+};
+
+/**
+ * @struct TaskSchedulerStats
+ * @brief Point-in-time counters of a TaskScheduler, for instrumentation
+ */
+struct TaskSchedulerStats {
+    size_t workerCount = 0;
+    size_t queuedTasks = 0;     ///< Tasks waiting in all deques
+    V<size_t> queueDepths;      ///< Tasks waiting in each worker's deque
+    uint64_t submitted = 0;     ///< Tasks ever submitted
+    uint64_t executed = 0;      ///< Tasks run to completion (or to an exception)
+    uint64_t steals = 0;        ///< Tasks a worker took from another worker's deque
+    uint64_t helped = 0;        ///< Tasks run by non-worker threads waiting on their own TaskGroup
+};
+
+class TaskGroup;
+
+/**
+ * @class TaskScheduler
+ * @brief Work-stealing thread pool shared by the whole process
+ *
+ * Each worker owns a deque. A worker pushes and pops its own tasks at the
+ * back (newest first, so forked subtasks run while their data is still in
+ * cache) and, when its deque is empty, steals the oldest task from the front
+ * of another worker's deque. Tasks submitted from outside the pool are dealt
+ * round-robin across the workers. Idle workers sleep until work arrives.
+ *
+ * getInstance() is sized to the machine's cores, so planners, batch
+ * endpoints and background jobs share one set of threads instead of each
+ * starting their own.
+ */
+class TaskScheduler {
+public:
+    using Task = std::function<void()>;
+
+private:
+    struct QueuedTask {
+        Task run;
+        const TaskGroup* group; ///< The group that forked it, nullptr for a bare submit()
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<QueuedTask> tasks;
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> steals{0};
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<size_t> queuedTasks;
+    std::atomic<uint64_t> submitted;
+    std::atomic<uint64_t> helped;
+    std::atomic<size_t> nextWorker; ///< Round-robin target for outside submissions
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    bool stopping;
+
+public:
+    /**
+     * @brief The process-wide scheduler, one worker per core
+     */
+    static TaskScheduler& getInstance();
+
+    /**
+     * @brief Start a pool
+     * @param workerCount Number of worker threads (0 = one per core)
+     */
+    explicit TaskScheduler(size_t workerCount = 0);
+
+    /**
+     * @brief Runs every task still queued, then joins the workers
+     */
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /**
+     * @brief Queue a task; from a worker it goes on that worker's own deque
+     * @note Exceptions escaping a bare task are logged and dropped; use TaskGroup to see them
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Queue a task forked by a TaskGroup, tagged so its waiter can find it
+     */
+    void submit(Task task, const TaskGroup* group);
+
+    /**
+     * @brief Run one queued task on the calling thread
+     *
+     * A worker runs any queued task. A thread outside the pool only runs
+     * tasks forked by group, so a request thread waiting on its own batch
+     * never picks up an unrelated background job.
+     * @return false if there was no task the caller may run
+     */
+    bool runPendingTask(const TaskGroup* group);
+
+    /**
+     * @brief Split [0, count) into chunks and run body(begin, end) on each in parallel
+     *
+     * The calling thread works on chunks too and returns once all are done.
+     * Chunks not yet started when the token is cancelled are skipped.
+     * @throws Whatever the first failing chunk threw
+     */
+    void parallelFor(size_t count, const std::function<void(size_t, size_t)>& body,
+                     const CancellationToken& token = CancellationToken());
+
+    size_t getWorkerCount() const;
+    TaskSchedulerStats getStats();
+
+private:
+    void workerLoop(size_t index);
+    bool takeTask(size_t index, Task& task);
+    void runTask(Task& task);
+};
+
+/**
+ * @class TaskGroup
+ * @brief Fork/join over a TaskScheduler: run() forks, wait() joins
+ *
+ * wait() does not just block: while the group's tasks are unfinished the
+ * waiting thread runs queued tasks itself, so a task may fork and wait on a
+ * nested group without tying up a worker. Threads outside the pool only
+ * help with this group's own tasks. The destructor waits as well, so
+ * tasks may safely refer to the group's scope.
+ */
+class TaskGroup {
+private:
+    TaskScheduler& scheduler;
+    CancellationToken token;
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t pending;
+    std::exception_ptr error;
+
+public:
+    explicit TaskGroup(TaskScheduler& scheduler = TaskScheduler::getInstance(),
+                       const CancellationToken& token = CancellationToken());
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /**
+     * @brief Fork a task; it is skipped if the group is cancelled before it starts
+     */
+    void run(TaskScheduler::Task task);
+
+    /**
+     * @brief Wait for every forked task, helping to run queued work meanwhile
+     * @throws The first exception any task in the group threw
+     */
+    void wait();
+
+    /**
+     * @brief Cancel the group's token
+     */
+    void cancel();
+
+    const CancellationToken& getToken() const;
+};
+
+#endif
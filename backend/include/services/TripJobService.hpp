@@ -0,0 +1,138 @@
+#ifndef TRIP_JOB_SERVICE_HPP
+#define TRIP_JOB_SERVICE_HPP
+
+#include "../header.hpp"
+#include "../entities/Trip.hpp"
+#include "TripService.hpp"
+#include "TaskScheduler.hpp"
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+
+/**
+ * @brief Lifecycle of an asynchronous trip planning job
+ */
+enum class TripJobStatus {
+    Queued,
+    Running,
+    Completed,
+    Failed,
+    Cancelled
+};
+
+/**
+ * @struct TripJob
+ * @brief Snapshot of one planning job as seen by the polling endpoint
+ */
+struct TripJob {
+    int id = 0;                 ///< Job ID handed back to the client
+    int startCityId = 0;        ///< Requested starting city
+    V<int> cityIds;             ///< Requested cities to visit
+    RouteOptions options;       ///< Round trip and 2-opt settings
+    TripJobStatus status = TripJobStatus::Queued;
+    int citiesPlanned = 0;      ///< Cities placed on the route so far
+    int targetCities = 0;       ///< Cities the finished route will contain
+    double bestDistance = 0.0;  ///< Distance of the best route found so far
+    Trip trip = Trip(0, 0, TripKind::Unknown, 0.0); ///< Final trip (valid once Completed)
+    std::string error;          ///< Failure reason (set when Failed)
+    CancellationToken cancellation; ///< Cancelled by TripJobService::cancel()
+};
+
+/**
+ * @class TripJobService
+ * @brief Runs custom trip planning on the shared TaskScheduler
+ *
+ * Submitting a job returns immediately with a job ID. Jobs wait in a bounded
+ * queue and at most maxRunningJobs of them run on the scheduler at a time,
+ * each calling TripService::planCustomTour and publishing progress as the
+ * route grows; the cap leaves the remaining workers free for batch planning.
+ * When the queue is full, submit() refuses the job so the route layer can
+ * answer 429.
+ */
+class TripJobService {
+private:
+    TripService& tripService;
+    TaskScheduler& scheduler;
+    size_t maxRunningJobs;      ///< Jobs allowed on the scheduler at once
+    size_t maxQueuedJobs;       ///< Jobs allowed to wait for a worker
+    size_t maxRetainedJobs;     ///< Finished jobs kept around for polling
+
+    std::mutex mutex;
+    std::condition_variable allJobsDone;
+    std::deque<int> pendingJobs;        ///< Job IDs waiting for a worker
+    std::deque<int> finishedJobs;       ///< Job IDs in completion order (oldest first)
+    std::map<int, TripJob> jobs;
+    int nextJobId;
+    size_t runningJobs;
+    bool stopping;
+
+public:
+    /**
+     * @brief Constructor
+     * @param tripService Service used to plan and persist each trip
+     * @param maxRunningJobs Jobs planned concurrently on the scheduler
+     * @param maxQueuedJobs Queue capacity before submissions are rejected
+     * @param maxRetainedJobs Finished jobs remembered before the oldest is dropped
+     * @param scheduler Pool the jobs run on
+     */
+    TripJobService(TripService& tripService, size_t maxRunningJobs = 2,
+                   size_t maxQueuedJobs = 32, size_t maxRetainedJobs = 256,
+                   TaskScheduler& scheduler = TaskScheduler::getInstance());
+
+    /**
+     * @brief Destructor - waits for queued and running jobs to finish
+     */
+    ~TripJobService();
+
+    TripJobService(const TripJobService&) = delete;
+    TripJobService& operator=(const TripJobService&) = delete;
+
+    /**
+     * @brief Queue a custom trip for planning
+     * @param startCityId The city the trip starts from
+     * @param cityIds Cities to visit
+     * @param options Round trip and 2-opt settings
+     * @return The new job ID, or -1 if the queue is full
+     */
+    int submit(int startCityId, const V<int>& cityIds, const RouteOptions& options = RouteOptions());
+
+    /**
+     * @brief Copy out the current state of a job
+     * @param jobId The job to look up
+     * @param job Populated with the job state when found
+     * @return true if the job exists, false otherwise
+     */
+    bool getJob(int jobId, TripJob& job);
+
+    /**
+     * @brief Cancel a queued or running job
+     *
+     * A queued job never starts; a running one stops at its next progress
+     * update and nothing is saved.
+     * @return false if the job does not exist or has already finished
+     */
+    bool cancel(int jobId);
+
+    /**
+     * @brief Number of jobs waiting for a worker
+     */
+    size_t queuedJobCount();
+
+    /**
+     * @brief Number of jobs currently running on the scheduler
+     */
+    size_t runningJobCount();
+
+    /**
+     * @brief Lower-case name of a job status for JSON responses
+     */
+    static std::string statusToString(TripJobStatus status);
+
+private:
+    void scheduleJobs();        ///< Must be called with mutex held
+    void runJob(int jobId);
+    void retireJob(int jobId);  ///< Must be called with mutex held
+};
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef TRIP_MAINTENANCE_SERVICE_HPP
+#define TRIP_MAINTENANCE_SERVICE_HPP
+
+#include "../header.hpp"
+#include "../repositories/TripRepository.hpp"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * @struct TripMaintenanceConfig
+ * @brief Tuning knobs for the background trip maintenance job
+ */
+struct TripMaintenanceConfig {
+    int intervalSeconds = 3600;          ///< Time between maintenance runs
+    long long tripTtlSeconds = 7 * 24 * 3600; ///< Unreferenced preset trips older than this are deleted
+    long long dedupMinAgeSeconds = 3600; ///< Trips younger than this are left alone by dedup
+    int batchSize = 500;                 ///< Trips handled per transaction
+    int vacuumPages = 2000;              ///< Pages released per incremental_vacuum
+    int analyzeEveryRuns = 24;           ///< Run ANALYZE on every Nth pass
+};
+
+/**
+ * @struct TripMaintenanceReport
+ * @brief What one maintenance pass did
+ */
+struct TripMaintenanceReport {
+    int duplicatesRemoved = 0;
+    int expiredRemoved = 0;
+    bool analyzed = false;
+};
+
+/**
+ * @class TripMaintenanceService
+ * @brief Keeps the trips and trip_cities tables from growing without bound
+ *
+ * Every preset tour request inserts a new trip, so the tables fill with
+ * identical routes. A background thread periodically:
+ * 1. Collapses preset trips with the same type, start city and city order
+ *    into the oldest (canonical) trip, moving any purchases over to it
+ * 2. Deletes preset trips past their TTL that no purchase refers to
+ * 3. Returns free pages with PRAGMA incremental_vacuum and refreshes planner
+ *    statistics with ANALYZE
+ *
+ * Only kinds marked maintained in TRIP_KIND_CATALOG are touched; custom,
+ * culinary and batch trips were built by a user and are kept as saved.
+ * Deletes run in transactions of at most batchSize trips so request threads
+ * only ever wait for one small batch.
+ */
+class TripMaintenanceService {
+private:
+    TripRepository& tripRepo;
+    TripMaintenanceConfig config;
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    bool stopping;
+    int runCount;
+    std::thread worker;
+
+public:
+    TripMaintenanceService(TripRepository& tripRepo, const TripMaintenanceConfig& config = TripMaintenanceConfig());
+    ~TripMaintenanceService();
+
+    TripMaintenanceService(const TripMaintenanceService&) = delete;
+    TripMaintenanceService& operator=(const TripMaintenanceService&) = delete;
+
+    /**
+     * @brief Start the background thread (first pass after one interval)
+     */
+    void start();
+
+    /**
+     * @brief Stop the background thread, waiting for a running pass to finish
+     */
+    void stop();
+
+    /**
+     * @brief Run one full maintenance pass on the calling thread
+     */
+    TripMaintenanceReport runOnce();
+
+    /**
+     * @brief Collapse duplicate routes into their oldest trip
+     * @return Number of duplicate trips removed
+     */
+    int deduplicateRoutes();
+
+    /**
+     * @brief Delete unreferenced trips older than the TTL
+     * @return Number of trips removed
+     */
+    int deleteExpiredTrips();
+
+    /**
+     * @brief Release free pages and optionally refresh statistics
+     * @param analyze Also run ANALYZE
+     */
+    void compact(bool analyze);
+
+private:
+    void workerLoop();
+    static V<TripKind> maintainedKinds();
+    bool runBatch(const std::function<bool()>& work);
+};
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef TRIP_PLANNER_HPP
+#define TRIP_PLANNER_HPP
+
+#include "../header.hpp"
+#include "DistanceMatrix.hpp"
+#include <functional>
+
+// Reports planning progress: cities placed so far, cities the trip will have,
+// and the distance of the route built so far
+using TripProgressCallback = std::function<void(int citiesPlanned, int targetCities, double distanceSoFar)>;
+
+/**
+ * @struct PlannedRoute
+ * @brief A route computed in memory, before anything is written to the database
+ */
+struct PlannedRoute {
+    int startCityId = 0;
+    V<int> cityIds;             ///< Cities in visit order, starting with startCityId
+    double totalDistance = 0.0; ///< Sum of the legs between consecutive cities
+    bool closed = false;        ///< Route returns to the start; cityIds then ends with startCityId again
+    int returnDistance = 0;     ///< km of the final leg home (closed routes only, included in totalDistance)
+};
+
+/**
+ * @struct RouteOptions
+ * @brief How a tour is shaped and how hard the planner works on it
+ */
+struct RouteOptions {
+    bool closed = false; ///< Return to the start city at the end
+    bool twoOpt = false; ///< Improve the greedy route with 2-opt moves
+};
+
+/**
+ * @struct TripCostModel
+ * @brief Weighted objective combining travel cost with a food purchase in every city
+ *
+ * Moving to a city costs distanceWeight * km * ratePerKm plus
+ * foodWeight * (price of the food bought there). With ratePerKm = 1,
+ * distanceWeight = 1 and foodWeight = 0 this is plain distance.
+ */
+struct TripCostModel {
+    double ratePerKm = 0.0;          ///< Travel cost in euros per km
+    double distanceWeight = 1.0;     ///< Weight of travel cost in the objective
+    double foodWeight = 1.0;         ///< Weight of food spend in the objective
+    std::vector<double> foodCostByCity; ///< Euros spent on food in each city, indexed by city ID
+
+    double foodCost(int cityId) const {
+        return cityId > 0 && cityId < (int)foodCostByCity.size() ? foodCostByCity[cityId] : 0.0;
+    }
+
+    double travelCost(int distance) const {
+        return distance * ratePerKm;
+    }
+
+    /// Weighted cost of travelling `distance` km and then buying food in toCityId
+    double legCost(int distance, int toCityId) const {
+        return distanceWeight * travelCost(distance) + foodWeight * foodCost(toCityId);
+    }
+};
+
+/**
+ * @struct RouteLeg
+ * @brief Cost of one hop of a route
+ */
+struct RouteLeg {
+    int fromCityId = 0;
+    int toCityId = 0;
+    int distance = 0;          ///< km
+    double travelCost = 0.0;   ///< euros for the km travelled
+    double foodCost = 0.0;     ///< euros for the food bought on arrival
+    double weightedCost = 0.0; ///< contribution to the objective
+};
+
+/**
+ * @struct RouteCostBreakdown
+ * @brief Per-leg and total costs of a route under a TripCostModel
+ */
+struct RouteCostBreakdown {
+    double startFoodCost = 0.0; ///< Food bought in the starting city
+    V<RouteLeg> legs;
+    double travelCost = 0.0;    ///< Sum of leg travel costs
+    double foodCost = 0.0;      ///< Sum of food costs, including the start city
+    double totalCost = 0.0;     ///< travelCost + foodCost, unweighted euros
+    double weightedCost = 0.0;  ///< Value of the objective the planner minimized
+};
+
+/**
+ * @class TripPlanner
+ * @brief Pure in-memory route planning over a DistanceMatrix
+ *
+ * Builds routes with the nearest-unvisited-city rule, reading distances from
+ * the matrix instead of querying city_distances at every step, so many routes
+ * can be planned concurrently against one shared copy of the distances.
+ *
+ * Closed tours (round trips) also pay for the leg back to the start: the last
+ * city is chosen by its distance plus the distance home, and the return leg is
+ * appended to the route.
+ *
+ * When the matrix carries neighbour lists, distance-only steps look at a
+ * city's k nearest cities first and scan the full row only if none of them
+ * is still open, so each step is usually O(k) instead of O(cities).
+ *
+ * Tours of up to 64 distinct cities (every preset tour) are planned by a
+ * kernel instantiated for 16, 32 or 64 cities, picked by tour size: the
+ * tour's distances are copied into a fixed-size tile and the open cities
+ * kept in a 16/32/64-bit mask. Both paths produce the same routes.
+ */
+class TripPlanner {
+public:
+    /**
+     * @brief Plan a route with the greedy nearest-neighbour rule
+     * @param distances Distances between all cities
+     * @param startCityId City the route starts from
+     * @param citiesToVisit Cities the route may visit (the start city is skipped)
+     * @param onProgress Optional callback invoked after each city is placed
+     * @param closed Return to the start city at the end
+     * @return The planned route; stops early if no listed city is reachable
+     */
+    static PlannedRoute planGreedy(const DistanceMatrix& distances, int startCityId,
+                                   const V<int>& citiesToVisit,
+                                   const TripProgressCallback& onProgress = nullptr,
+                                   bool closed = false);
+
+    /**
+     * @brief Plan a route with the greedy rule applied to a weighted cost
+     * @param distances Distances between all cities
+     * @param costs Weights, travel rate and per-city food cost
+     * @param startCityId City the route starts from
+     * @param citiesToVisit Candidate cities (the start city is skipped)
+     * @param maxStops Stop after this many cities besides the start (0 = visit all)
+     * @param onProgress Optional callback invoked after each city is placed
+     * @param closed Return to the start city at the end (the return leg buys no food)
+     * @return The planned route; totalDistance is still in km
+     * @note When maxStops limits the route, food prices decide which cities are visited
+     */
+    static PlannedRoute planGreedyByCost(const DistanceMatrix& distances, const TripCostModel& costs,
+                                         int startCityId, const V<int>& citiesToVisit, int maxStops = 0,
+                                         const TripProgressCallback& onProgress = nullptr,
+                                         bool closed = false);
+
+    /**
+     * @brief Shorten a route with 2-opt moves (reversing a stretch of the route)
+     * @param distances Distances between all cities; its neighbour lists limit
+     *        each city to its k nearest partners when present
+     * @param route Route to improve in place; the start (and, for closed routes,
+     *        the final return to it) never moves
+     * @param maxPasses Give up after this many sweeps without convergence
+     * @return Number of moves applied
+     */
+    static int improveTwoOpt(const DistanceMatrix& distances, PlannedRoute& route, int maxPasses = 50);
+
+    /**
+     * @brief Price a route leg by leg
+     * @param distances Distances between all cities
+     * @param costs Cost model to apply
+     * @param route Any planned route, from any planner
+     */
+    static RouteCostBreakdown breakdown(const DistanceMatrix& distances, const TripCostModel& costs,
+                                        const PlannedRoute& route);
+};
+
+#endif
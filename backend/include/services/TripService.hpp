@@ -7,32 +7,141 @@
 #include "../repositories/TripRepository.hpp"
 #include "../repositories/CityDistanceRepository.hpp"
 #include "../services/tripCityService.hpp"
+#include "../services/ReferenceDataCache.hpp"
+#include "../services/TripPlanner.hpp"
+#include <map>
+
+// One itinerary in a batch planning request
+struct TripPlanRequest {
+    int startCityId = 0;
+    V<int> cityIds;
+    RouteOptions options;
+};
+
+// Outcome of planning one itinerary from a batch
+struct BatchTripResult {
+    bool success = false;
+    std::string error;
+    Trip trip = Trip(0, 0, TripKind::Unknown, 0.0);
+    PlannedRoute route;
+};
+
+// Settings for cost-aware ("culinary") planning
+struct TripCostOptions {
+    double ratePerKm = 0.15;        // travel cost in euros per km
+    double distanceWeight = 1.0;    // weight of travel cost
+    double foodWeight = 1.0;        // weight of food spend
+    std::map<int, int> chosenFoods; // city ID -> food bought there (default: cheapest in that city)
+    int maxStops = 0;               // cities to visit besides the start (0 = all listed)
+    RouteOptions route;             // round trip and 2-opt settings
+};
+
+// A cost-aware route with its per-leg prices and the food bought in each city
+struct CostedRoute {
+    PlannedRoute route;
+    RouteCostBreakdown costs;
+    std::map<int, Food> foodByCity;
+};
+
+// Why an incremental trip edit did or did not happen
+enum class RouteEditStatus {
+    Applied,
+    NotFound,      // no such trip, or the city is not on it
+    Rejected,      // the edit is not allowed or not possible
+    StorageFailed  // the database write failed and was rolled back
+};
+
+// Outcome of inserting, removing or reordering cities in a saved trip
+struct RouteEdit {
+    RouteEditStatus status = RouteEditStatus::Rejected;
+    std::string error;
+    int visitOrder = 0;         // position the city was inserted at or removed from
+    double distanceDelta = 0.0; // change in total_distance
+    double totalDistance = 0.0; // total_distance after the edit
+};
 
 class TripService {
 private:
     TripRepository& tripRepo;
     CityDistanceRepository& cityDistanceRepo;
     TripCityService& tripCityService;
+    ReferenceDataCache& referenceData;
+
+    // Food bought in each city and the resulting cost model;
+    // throws std::invalid_argument for a chosen food that is not sold in its city
+    TripCostModel buildCostModel(const ReferenceDataSnapshot& referenceSnapshot, const TripCostOptions& options,
+                                 std::map<int, Food>& foodByCity);
+
+    // Writes a planned route's trip and trip_cities rows (caller owns the transaction)
+    bool saveRoute(Trip& trip, const PlannedRoute& route);
 
-    // Helper methods moved from Trip entity
-    bool hasCity(const Trip& trip, int cityId);
-    int getTripSize(const Trip& trip);
-    void addCityToTrip(Trip& trip, int cityId);
+    // Reads the trip and its stops inside a transaction and hands them to apply(),
+    // which validates and writes the edit; apply() returning false rolls back
+    RouteEdit editTrip(int tripId,
+                       const std::function<bool(const Trip&, const V<TripCity>&, RouteEdit&)>& apply);
 
-    // Recursive trip planning methods
-    int findNearestUnvisitedCity(Trip& trip, int fromCityId);
-    void CreateShortestTrip(Trip& trip, int startCityId);
-    void CreateShortestTrip(Trip& trip, int startCityId, const V<int>& allowedCities);
-    int findNearestUnvisitedCityFromList(Trip& trip, int fromCityId, const V<int>& allowedCities);
+    // Saves a planned route in its own transaction; the returned trip has ID 0 on failure
+    Trip saveTrip(TripKind tripKind, const PlannedRoute& route);
+
+    // Preset tour definitions, excluding the starting city
+    static V<int> parisTourCities();
+    static V<int> londonTourCities(int numCities);
+    static V<int> berlinTourCities();
 
 public:
-    TripService(TripRepository& tripRepository, CityDistanceRepository& cityDistanceRepo, TripCityService& tripCityService);
+    TripService(TripRepository& tripRepository, CityDistanceRepository& cityDistanceRepo, TripCityService& tripCityService,
+                ReferenceDataCache& referenceData);
     
-    // Main trip planning methods
-    Trip planParisTour();
-    Trip planLondonTour(int numCities = 13);
-    Trip planCustomTour(int startCityId, const V<int>& citiesToVisit);
-    Trip planBerlinTour();
+    // Main trip planning methods. Each route is planned in memory and saved
+    // in one transaction. Closed tours return to the start city: the last
+    // trip_cities row repeats it and total_distance includes the leg home.
+    Trip planParisTour(const RouteOptions& options = RouteOptions());
+    Trip planLondonTour(int numCities = 13, const RouteOptions& options = RouteOptions());
+    Trip planCustomTour(int startCityId, const V<int>& citiesToVisit,
+                        const TripProgressCallback& onProgress = nullptr,
+                        const RouteOptions& options = RouteOptions());
+    Trip planBerlinTour(const RouteOptions& options = RouteOptions());
+
+    // Dry-run planning: computes the route and total in memory and never
+    // touches the trips or trip_cities tables
+    PlannedRoute previewCustomTour(int startCityId, const V<int>& citiesToVisit,
+                                   const TripProgressCallback& onProgress = nullptr,
+                                   const RouteOptions& options = RouteOptions());
+    PlannedRoute previewParisTour(const RouteOptions& options = RouteOptions());
+    PlannedRoute previewLondonTour(int numCities = 13, const RouteOptions& options = RouteOptions());
+    PlannedRoute previewBerlinTour(const RouteOptions& options = RouteOptions());
+
+    // Cost-aware planning: minimizes weighted travel cost (km x rate) plus
+    // a food purchase in every city, and prices the route leg by leg
+    CostedRoute previewCulinaryTour(int startCityId, const V<int>& citiesToVisit, const TripCostOptions& options);
+    Trip planCulinaryTour(int startCityId, const V<int>& citiesToVisit, const TripCostOptions& options,
+                          CostedRoute& planned);
+
+    // Incremental re-planning of a saved trip: the city goes where it adds the
+    // least distance (cheapest insertion), or leaves with the matching saving.
+    // total_distance moves by the delta and only later stops are renumbered,
+    // all in one transaction. The start city and a round trip's return leg stay.
+    RouteEdit insertCityIntoTrip(int tripId, int cityId);
+    RouteEdit removeCityFromTrip(int tripId, int cityId);
+
+    // Visits a saved trip's cities in a new order: same cities, same start
+    // (and same return for a round trip). All visit orders are rewritten in
+    // bulk and total_distance is recomputed, in one transaction.
+    RouteEdit reorderTrip(int tripId, const V<int>& cityIds);
+
+    // Most itineraries one planBatch call accepts; the whole batch is planned
+    // in memory and saved in one transaction, so it has to stay bounded
+    static const size_t MAX_TRIPS_PER_BATCH = 500;
+
+    // Plans every itinerary concurrently against the cached distance matrix,
+    // then saves all successful trips in a single transaction.
+    // Throws std::invalid_argument for more than MAX_TRIPS_PER_BATCH requests.
+    V<BatchTripResult> planBatch(const V<TripPlanRequest>& requests);
+
+    // Keyset-paginated listing: visits up to `limit` trips with id > afterId
+    // in id order without holding the page in memory; TripKind::Unknown lists every kind
+    bool forEachTrip(int afterId, int limit, TripKind tripKind,
+                     const std::function<bool(const Trip&)>& onTrip);
 };
 
 #endif
\ No newline at end of file
@@ -36,6 +36,16 @@ public:
      * @note Validates parameters and checks for duplicates
      */
     bool addCityToTrip(int tripId, int cityId, int visitOrder = -1);
+
+    /**
+     * @brief Store a whole planned route for a newly created trip
+     * @param tripId The ID of the trip (must not have any cities yet)
+     * @param cityIds Cities in visit order; visit orders 1..n are assigned
+     * @return true if every city was saved, false otherwise
+     * @note Skips the per-city duplicate and next-order lookups that
+     *       addCityToTrip performs, since the route is already known
+     */
+    bool addRouteToTrip(int tripId, const V<int>& cityIds);
     
     /**
      * @brief Get all cities for a specific trip
@@ -44,6 +54,17 @@ public:
      */
     V<TripCity> getCitiesForTrip(int tripId);
     
+    /**
+     * @brief Visit one keyset page of trip-city rows in ID order
+     * @param afterId Only rows with an ID greater than this (0 for the first page)
+     * @param limit Maximum number of rows to visit
+     * @param tripId Restrict to one trip, or 0 for every trip
+     * @param onTripCity Called for each row; return false to stop early
+     * @return true if the rows could be read, false otherwise
+     */
+    bool forEachTripCity(int afterId, int limit, int tripId,
+                         const std::function<bool(const TripCity&)>& onTripCity);
+    
     /**
      * @brief Remove a city from a trip
      * @param tripId The ID of the trip
@@ -61,6 +82,35 @@ public:
      */
     bool updateVisitOrder(int tripId, int cityId, int newOrder);
     
+    // Incremental route edits (callers own the transaction)
+    /**
+     * @brief Insert a city at a visit order, moving later stops back by one
+     * @param tripId The ID of the trip
+     * @param cityId The ID of the city to insert
+     * @param visitOrder Position the city takes
+     * @return true if successful, false otherwise
+     * @note Rewrites only the stops at or after visitOrder
+     */
+    bool insertCityAt(int tripId, int cityId, int visitOrder);
+    
+    /**
+     * @brief Remove the stop at a visit order, moving later stops forward by one
+     * @param tripId The ID of the trip
+     * @param visitOrder Position of the stop to remove
+     * @return true if successful, false otherwise
+     * @note Rewrites only the stops after visitOrder
+     */
+    bool removeCityAt(int tripId, int visitOrder);
+    
+    /**
+     * @brief Give a trip's stops new visit orders in a single bulk rewrite
+     * @param tripId The ID of the trip
+     * @param stops Every stop of the trip, in the order it should be visited
+     * @return true if successful, false otherwise
+     * @note Costs two statements however long the trip is
+     */
+    bool reorderStops(int tripId, const V<TripCity>& stops);
+    
     // Utility operations
     /**
      * @brief Check if a city already exists in a trip
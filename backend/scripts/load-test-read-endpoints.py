@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""
+Measure read-endpoint throughput of a running API server
+
+Each client thread keeps one keep-alive connection open and requests the
+read endpoints round-robin for a fixed time. To see how the server scales,
+start it with --threads N and run this with the same client count, e.g.
+
+    ./api_server --threads 4 &
+    python3 scripts/load-test-read-endpoints.py --clients 4
+"""
+
+import argparse
+import http.client
+import threading
+import time
+from urllib.parse import urlparse
+
+READ_ENDPOINTS = [
+    '/api/cities',
+    '/api/cities/distances',
+    '/api/cities/shortest-path?from=1&to=12',
+    '/api/foods/search?max_price=10&limit=50',
+    '/api/cities/9/food',
+]
+
+def run_client(host, port, endpoints, deadline, counts, index):
+    """Request endpoints until the deadline; record (ok, failed) in counts[index]"""
+    conn = http.client.HTTPConnection(host, port, timeout=10)
+    ok = failed = 0
+    i = index
+    while time.monotonic() < deadline:
+        try:
+            conn.request('GET', endpoints[i % len(endpoints)])
+            response = conn.getresponse()
+            response.read()
+            if response.status == 200:
+                ok += 1
+            else:
+                failed += 1
+        except (OSError, http.client.HTTPException):
+            failed += 1
+            conn.close()
+            conn = http.client.HTTPConnection(host, port, timeout=10)
+        i += 1
+    conn.close()
+    counts[index] = (ok, failed)
+
+def measure(host, port, endpoints, clients, seconds):
+    """Requests per second with the given number of concurrent clients"""
+    counts = [(0, 0)] * clients
+    deadline = time.monotonic() + seconds
+    threads = [threading.Thread(target=run_client, args=(host, port, endpoints, deadline, counts, i))
+               for i in range(clients)]
+    start = time.monotonic()
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    elapsed = time.monotonic() - start
+    ok = sum(c[0] for c in counts)
+    failed = sum(c[1] for c in counts)
+    return ok / elapsed, failed
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument('--url', default='http://localhost:3001', help='server base URL')
+    parser.add_argument('--clients', default='1,2,4,8,16',
+                        help='comma-separated concurrent client counts to measure')
+    parser.add_argument('--seconds', type=float, default=10.0, help='duration of each measurement')
+    args = parser.parse_args()
+
+    url = urlparse(args.url)
+    host, port = url.hostname, url.port or 80
+
+    print(f"📈 Read endpoints: {', '.join(READ_ENDPOINTS)}")
+    baseline = None
+    for clients in [int(c) for c in args.clients.split(',')]:
+        rate, failed = measure(host, port, READ_ENDPOINTS, clients, args.seconds)
+        baseline = baseline or rate
+        print(f"  {clients:3d} clients: {rate:10.0f} req/s  ({rate / baseline:.2f}x, {failed} failed)")
+
+if __name__ == "__main__":
+    main()
@@ -1,20 +1,33 @@
 #include <crow.h>
+#include "../../include/routes/apiApp.hpp"
 #include "../../include/routes/cityRoutes.hpp"
 #include "../../include/routes/tripRoutes.hpp"
-#include "../../include/services/CityService.hpp"
+#include "../../include/routes/purchaseRoutes.hpp"
+#include "../../include/routes/spendingRoutes.hpp"
 #include "../../include/services/FoodService.hpp"
 #include "../../include/services/TripService.hpp"
 #include "../../include/services/tripCityService.hpp"
+#include "../../include/services/TripJobService.hpp"
+#include "../../include/databaseExecutor.hpp"
+#include "../../include/services/ReferenceDataCache.hpp"
+#include "../../include/services/TripMaintenanceService.hpp"
+#include "../../include/services/PurchaseService.hpp"
+#include "../../include/services/SpendingService.hpp"
 #include "../../include/repositories/CityRepository.hpp"
 #include "../../include/repositories/FoodRepository.hpp"
 #include "../../include/repositories/TripRepository.hpp"
 #include "../../include/repositories/TripCityRepository.hpp"
 #include "../../include/repositories/CityDistanceRepository.hpp"
+#include "../../include/repositories/PurchaseRepository.hpp"
+#include "../../include/repositories/SpendingRepository.hpp"
 #include "../../include/databaseManager.hpp"
+#include "../../include/serverConfig.hpp"
 #include <iostream>
 
-void startApiServer() {
-    crow::SimpleApp app;
+void startApiServer(const ServerConfig& config) {
+    ApiApp app;
+    app.get_middleware<BodyParseLimit>().maxBytes = config.maxBodyParseBytes;
+    DatabaseExecutor::configure(config.databaseThreads);
 
     // Initialize database using singleton pattern
     DatabaseManager& database = DatabaseManager::getInstance();
@@ -32,16 +45,29 @@ void startApiServer() {
     TripRepository tripRepo(database);
     TripCityRepository tripCityRepo(database);
     CityDistanceRepository cityDistanceRepo(database);
+    PurchaseRepository purchaseRepo(database);
+    SpendingRepository spendingRepo(database);
 
     // Initialize services
-    CityService cityService(cityRepo);
     FoodService foodService(foodRepo);
     TripCityService tripCityService(tripCityRepo);
-    TripService tripService(tripRepo, cityDistanceRepo, tripCityService);
+    ReferenceDataCache referenceData(cityRepo, cityDistanceRepo, foodRepo);
+    TripService tripService(tripRepo, cityDistanceRepo, tripCityService, referenceData);
+    TripJobService tripJobService(tripService);
+
+    // Purchases are queued and written behind the request in grouped transactions
+    PurchaseService purchaseService(purchaseRepo, tripRepo, referenceData);
+    SpendingService spendingService(spendingRepo);
+
+    // Background retention, dedup and compaction of the trips tables
+    TripMaintenanceService tripMaintenance(tripRepo);
+    tripMaintenance.start();
 
     // Register all routes
-    registerCityRoutes(app, cityService, foodService, cityDistanceRepo);
-    registerTripRoutes(app, tripService, cityService, tripCityService);
+    registerCityRoutes(app, foodService, referenceData);
+    registerTripRoutes(app, tripService, referenceData, tripCityService, tripJobService, foodService);
+    registerPurchaseRoutes(app, purchaseService);
+    registerSpendingRoutes(app, spendingService);
 
     // Simple test route
     CROW_ROUTE(app, "/")([]() {
@@ -53,21 +79,59 @@ void startApiServer() {
     std::cout << "📍 Available endpoints:" << std::endl;
     std::cout << "  GET / - API status" << std::endl;
     std::cout << "  GET /api/cities - Get all cities" << std::endl;
-    std::cout << "  GET /api/cities/distances - Get all city distances" << std::endl;
+    std::cout << "  GET /api/cities/distances - Get all city distances (Accept: application/octet-stream for a binary matrix)" << std::endl;
+    std::cout << "  GET /api/cities/shortest-path?from=&to= - Shortest route between two cities" << std::endl;
     std::cout << "  GET /api/cities/food - Get all cities with food" << std::endl;
     std::cout << "  GET /api/cities/{id}/food - Get foods for city" << std::endl;
+    std::cout << "  GET /api/foods/search?min_price=&max_price=&city_id=&prefix=&limit= - Search foods" << std::endl;
     std::cout << "  GET /api/trips/paris - Plan Paris tour (all cities)" << std::endl;
     std::cout << "  GET /api/trips/london - Plan London tour" << std::endl;
     std::cout << "  GET /api/trips/custom - Plan custom tour" << std::endl;
     std::cout << "  GET /api/trips/berlin - Plan Berlin tour" << std::endl;
+    std::cout << "  ?dry_run=true on trip planning routes - plan without saving" << std::endl;
+    std::cout << "  POST /api/trips/batch - Plan many custom tours at once" << std::endl;
+    std::cout << "  POST /api/trips/jobs - Queue custom tour (async)" << std::endl;
+    std::cout << "  GET /api/trips/jobs/{id} - Poll trip planning job" << std::endl;
+    std::cout << "  DELETE /api/trips/jobs/{id} - Cancel trip planning job" << std::endl;
+    std::cout << "  GET /api/trips?type=&after=&limit= - List trips (paginated)" << std::endl;
+    std::cout << "  GET /api/trip-cities?trip_id=&after=&limit= - List trip cities (paginated)" << std::endl;
     std::cout << "  GET /api/trips/{id} - Get trip by ID" << std::endl;
-    std::cout << "🌐 Server running on http://localhost:3001" << std::endl;
+    std::cout << "  POST /api/purchases - Record one or many purchases (?wait=true for durable ack)" << std::endl;
+    std::cout << "  GET /api/purchases/acks/{sequence} - Purchase durability status" << std::endl;
+    std::cout << "  GET /api/purchases/acks/{first}/{last} - Durability of a whole submission" << std::endl;
+    std::cout << "  GET /api/trips/{id}/spending - Total spent on a trip" << std::endl;
+    std::cout << "  POST /api/trips/culinary - Plan a tour minimizing travel cost plus food spend" << std::endl;
+    std::cout << "  POST /api/trips/{id}/cities - Add a city where it adds the least distance" << std::endl;
+    std::cout << "  DELETE /api/trips/{id}/cities/{cityId} - Remove a city from a trip" << std::endl;
+    std::cout << "  PUT /api/trips/{id}/cities - Visit a trip's cities in a new order" << std::endl;
+    std::cout << "  POST /api/trips/{id}/food-plan - Best foods for a trip within a budget" << std::endl;
+    std::cout << "  GET /api/cities/{id}/spending - Total spent in a city" << std::endl;
+    std::cout << "  GET /api/foods/{id}/spending - Total spent on a food" << std::endl;
+    std::cout << "  GET /api/admin/spending/check - Compare spending aggregates with purchases" << std::endl;
+    std::cout << "  POST /api/admin/spending/rebuild - Recount spending aggregates from purchases" << std::endl;
+    std::cout << "  GET /api/admin/reference-data - Cached reference data version" << std::endl;
+    std::cout << "  POST /api/admin/reference-data/reload - Reload cities, distances and foods in the background" << std::endl;
+    std::cout << "  GET /api/admin/scheduler - Task scheduler queue depths and steal counts" << std::endl;
+    std::cout << "⚙️ " << config.describe() << std::endl;
+    std::cout << "🌐 Server running on http://localhost:" << config.port << std::endl;
+
+    app.port(config.port).concurrency(config.workerThreads).timeout(config.keepAliveTimeoutSeconds).run();
 
-    app.port(3001).run();
+    // Finish requests still queued on the database threads while the services they use exist
+    DatabaseExecutor::getInstance().shutdown();
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     std::cout << "🚀 Trip Planning API Server Starting..." << std::endl;
-    startApiServer();
+
+    ServerConfig config;
+    std::string error;
+    if (!ServerConfig::load(argc, argv, config, error)) {
+        std::cerr << "❌ Invalid configuration: " << error << std::endl;
+        std::cerr << "   Options: --port N --threads N --timeout SECONDS --max-body-parse BYTES --db-threads N" << std::endl;
+        return 1;
+    }
+
+    startApiServer(config);
    return 0;
 }
\ No newline at end of file
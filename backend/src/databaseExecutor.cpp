@@ -0,0 +1,125 @@
+/**
+ * Database Executor Implementation
+ * Dedicated threads for database-bound request work
+ */
+
+#include "../include/databaseExecutor.hpp"
+#include <iostream>
+
+namespace {
+    std::mutex instanceMutex;
+    size_t instanceThreadCount = DatabaseExecutor::DEFAULT_THREADS;
+    bool instanceStarted = false;
+
+    // Read once, when getInstance() first builds the executor
+    size_t startInstance() {
+        std::lock_guard<std::mutex> lock(instanceMutex);
+        instanceStarted = true;
+        return instanceThreadCount;
+    }
+}
+
+DatabaseExecutor& DatabaseExecutor::getInstance() {
+    static DatabaseExecutor instance(startInstance());
+    return instance;
+}
+
+bool DatabaseExecutor::configure(size_t threadCount) {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (instanceStarted) {
+        return false;
+    }
+    instanceThreadCount = threadCount;
+    return true;
+}
+
+DatabaseExecutor::DatabaseExecutor(size_t threadCount, size_t maxQueued)
+    : running(0), maxQueued(maxQueued), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(&DatabaseExecutor::workerLoop, this);
+    }
+
+    std::cout << "🗄️ Database executor started with " << threadCount << " threads" << std::endl;
+}
+
+DatabaseExecutor::~DatabaseExecutor() {
+    shutdown();
+}
+
+void DatabaseExecutor::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+bool DatabaseExecutor::post(Work work) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!stopping) {
+            // Backpressure: refuse work instead of letting the queue grow without bound
+            if (queue.size() >= maxQueued) {
+                return false;
+            }
+            queue.push_back(std::move(work));
+            workAvailable.notify_one();
+            return true;
+        }
+    }
+
+    // No threads left to hand it to
+    work();
+    return true;
+}
+
+size_t DatabaseExecutor::queuedCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
+
+size_t DatabaseExecutor::runningCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return running;
+}
+
+size_t DatabaseExecutor::getThreadCount() const {
+    return workers.size();
+}
+
+void DatabaseExecutor::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        workAvailable.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            return; // stopping and nothing left to do
+        }
+
+        Work work = std::move(queue.front());
+        queue.pop_front();
+        running++;
+        lock.unlock();
+
+        try {
+            work();
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Database work failed: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "❌ Database work failed" << std::endl;
+        }
+
+        lock.lock();
+        running--;
+    }
+}
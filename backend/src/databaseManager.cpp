@@ -9,18 +9,223 @@
 
 std::unique_ptr<DatabaseManager> DatabaseManager::instance = nullptr;
 
-DatabaseManager::DatabaseManager() : db(nullptr), isConnected_(false), inTransaction(false) {
+// Schema migrations, applied in order on connect. Each entry upgrades the
+// database from version - 1 to version; sqlite_schema.sql already contains
+// every migration and sets PRAGMA user_version to the latest one.
+struct SchemaMigration {
+    int version;
+    const char* description;
+    const char* sql;
+};
+
+static const SchemaMigration MIGRATIONS[] = {
+    {1, "trip creation timestamps for retention",
+     "ALTER TABLE trips ADD COLUMN created_at INTEGER NOT NULL DEFAULT 0;"
+     "UPDATE trips SET created_at = CAST(strftime('%s', 'now') AS INTEGER);"
+     "CREATE INDEX IF NOT EXISTS idx_trips_created_at ON trips(created_at);"},
+    {2, "trigger-maintained trip, city and food spending aggregates",
+     "CREATE TABLE trip_spending (\n"
+     "    trip_id INTEGER PRIMARY KEY,\n"
+     "    purchase_count INTEGER NOT NULL DEFAULT 0,\n"
+     "    item_count INTEGER NOT NULL DEFAULT 0,\n"
+     "    total_cents INTEGER NOT NULL DEFAULT 0\n"
+     ");\n"
+     "CREATE TABLE city_spending (\n"
+     "    city_id INTEGER PRIMARY KEY,\n"
+     "    purchase_count INTEGER NOT NULL DEFAULT 0,\n"
+     "    item_count INTEGER NOT NULL DEFAULT 0,\n"
+     "    total_cents INTEGER NOT NULL DEFAULT 0\n"
+     ");\n"
+     "CREATE TABLE food_spending (\n"
+     "    food_id INTEGER PRIMARY KEY,\n"
+     "    purchase_count INTEGER NOT NULL DEFAULT 0,\n"
+     "    item_count INTEGER NOT NULL DEFAULT 0,\n"
+     "    total_cents INTEGER NOT NULL DEFAULT 0\n"
+     ");\n"
+     "CREATE TRIGGER purchases_spending_insert AFTER INSERT ON purchases\n"
+     "BEGIN\n"
+     "    INSERT INTO trip_spending (trip_id, purchase_count, item_count, total_cents)\n"
+     "    SELECT NEW.trip_id, 1, NEW.quantity, NEW.quantity * IFNULL((SELECT CAST(ROUND(price * 100) AS INTEGER) FROM foods WHERE id = NEW.food_id), 0)\n"
+     "    WHERE NEW.trip_id IS NOT NULL\n"
+     "    ON CONFLICT(trip_id) DO UPDATE SET purchase_count = purchase_count + 1,\n"
+     "        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;\n"
+     "    INSERT INTO city_spending (city_id, purchase_count, item_count, total_cents)\n"
+     "    SELECT NEW.city_id, 1, NEW.quantity, NEW.quantity * IFNULL((SELECT CAST(ROUND(price * 100) AS INTEGER) FROM foods WHERE id = NEW.food_id), 0)\n"
+     "    WHERE NEW.city_id IS NOT NULL\n"
+     "    ON CONFLICT(city_id) DO UPDATE SET purchase_count = purchase_count + 1,\n"
+     "        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;\n"
+     "    INSERT INTO food_spending (food_id, purchase_count, item_count, total_cents)\n"
+     "    SELECT NEW.food_id, 1, NEW.quantity, NEW.quantity * IFNULL((SELECT CAST(ROUND(price * 100) AS INTEGER) FROM foods WHERE id = NEW.food_id), 0)\n"
+     "    WHERE NEW.food_id IS NOT NULL\n"
+     "    ON CONFLICT(food_id) DO UPDATE SET purchase_count = purchase_count + 1,\n"
+     "        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;\n"
+     "END;\n"
+     "CREATE TRIGGER purchases_spending_delete AFTER DELETE ON purchases\n"
+     "BEGIN\n"
+     "    UPDATE trip_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,\n"
+     "        total_cents = total_cents - OLD.quantity * IFNULL((SELECT CAST(ROUND(price * 100) AS INTEGER) FROM foods WHERE id = OLD.food_id), 0)\n"
+     "    WHERE trip_id = OLD.trip_id;\n"
+     "    DELETE FROM trip_spending WHERE trip_id = OLD.trip_id AND purchase_count <= 0;\n"
+     "    UPDATE city_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,\n"
+     "        total_cents = total_cents - OLD.quantity * IFNULL((SELECT CAST(ROUND(price * 100) AS INTEGER) FROM foods WHERE id = OLD.food_id), 0)\n"
+     "    WHERE city_id = OLD.city_id;\n"
+     "    DELETE FROM city_spending WHERE city_id = OLD.city_id AND purchase_count <= 0;\n"
+     "    UPDATE food_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,\n"
+     "        total_cents = total_cents - OLD.quantity * IFNULL((SELECT CAST(ROUND(price * 100) AS INTEGER) FROM foods WHERE id = OLD.food_id), 0)\n"
+     "    WHERE food_id = OLD.food_id;\n"
+     "    DELETE FROM food_spending WHERE food_id = OLD.food_id AND purchase_count <= 0;\n"
+     "END;\n"
+     "CREATE TRIGGER purchases_spending_update AFTER UPDATE OF city_id, food_id, quantity, trip_id ON purchases\n"
+     "BEGIN\n"
+     "    UPDATE trip_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,\n"
+     "        total_cents = total_cents - OLD.quantity * IFNULL((SELECT CAST(ROUND(price * 100) AS INTEGER) FROM foods WHERE id = OLD.food_id), 0)\n"
+     "    WHERE trip_id = OLD.trip_id;\n"
+     "    DELETE FROM trip_spending WHERE trip_id = OLD.trip_id AND purchase_count <= 0;\n"
+     "    UPDATE city_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,\n"
+     "        total_cents = total_cents - OLD.quantity * IFNULL((SELECT CAST(ROUND(price * 100) AS INTEGER) FROM foods WHERE id = OLD.food_id), 0)\n"
+     "    WHERE city_id = OLD.city_id;\n"
+     "    DELETE FROM city_spending WHERE city_id = OLD.city_id AND purchase_count <= 0;\n"
+     "    UPDATE food_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,\n"
+     "        total_cents = total_cents - OLD.quantity * IFNULL((SELECT CAST(ROUND(price * 100) AS INTEGER) FROM foods WHERE id = OLD.food_id), 0)\n"
+     "    WHERE food_id = OLD.food_id;\n"
+     "    DELETE FROM food_spending WHERE food_id = OLD.food_id AND purchase_count <= 0;\n"
+     "    INSERT INTO trip_spending (trip_id, purchase_count, item_count, total_cents)\n"
+     "    SELECT NEW.trip_id, 1, NEW.quantity, NEW.quantity * IFNULL((SELECT CAST(ROUND(price * 100) AS INTEGER) FROM foods WHERE id = NEW.food_id), 0)\n"
+     "    WHERE NEW.trip_id IS NOT NULL\n"
+     "    ON CONFLICT(trip_id) DO UPDATE SET purchase_count = purchase_count + 1,\n"
+     "        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;\n"
+     "    INSERT INTO city_spending (city_id, purchase_count, item_count, total_cents)\n"
+     "    SELECT NEW.city_id, 1, NEW.quantity, NEW.quantity * IFNULL((SELECT CAST(ROUND(price * 100) AS INTEGER) FROM foods WHERE id = NEW.food_id), 0)\n"
+     "    WHERE NEW.city_id IS NOT NULL\n"
+     "    ON CONFLICT(city_id) DO UPDATE SET purchase_count = purchase_count + 1,\n"
+     "        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;\n"
+     "    INSERT INTO food_spending (food_id, purchase_count, item_count, total_cents)\n"
+     "    SELECT NEW.food_id, 1, NEW.quantity, NEW.quantity * IFNULL((SELECT CAST(ROUND(price * 100) AS INTEGER) FROM foods WHERE id = NEW.food_id), 0)\n"
+     "    WHERE NEW.food_id IS NOT NULL\n"
+     "    ON CONFLICT(food_id) DO UPDATE SET purchase_count = purchase_count + 1,\n"
+     "        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;\n"
+     "END;\n"
+     "CREATE TRIGGER trips_spending_delete AFTER DELETE ON trips\n"
+     "BEGIN\n"
+     "    DELETE FROM trip_spending WHERE trip_id = OLD.id;\n"
+     "END;\n"
+     "INSERT INTO trip_spending (trip_id, purchase_count, item_count, total_cents)\n"
+     "SELECT p.trip_id, COUNT(*), SUM(p.quantity), SUM(p.quantity * IFNULL(CAST(ROUND(f.price * 100) AS INTEGER), 0))\n"
+     "FROM purchases p LEFT JOIN foods f ON f.id = p.food_id WHERE p.trip_id IS NOT NULL GROUP BY p.trip_id;\n"
+     "INSERT INTO city_spending (city_id, purchase_count, item_count, total_cents)\n"
+     "SELECT p.city_id, COUNT(*), SUM(p.quantity), SUM(p.quantity * IFNULL(CAST(ROUND(f.price * 100) AS INTEGER), 0))\n"
+     "FROM purchases p LEFT JOIN foods f ON f.id = p.food_id WHERE p.city_id IS NOT NULL GROUP BY p.city_id;\n"
+     "INSERT INTO food_spending (food_id, purchase_count, item_count, total_cents)\n"
+     "SELECT p.food_id, COUNT(*), SUM(p.quantity), SUM(p.quantity * IFNULL(CAST(ROUND(f.price * 100) AS INTEGER), 0))\n"
+     "FROM purchases p LEFT JOIN foods f ON f.id = p.food_id WHERE p.food_id IS NOT NULL GROUP BY p.food_id;\n"},
+    // The CASE values must match TripKind; custom tours used to be saved as plain "custom"
+    {3, "integer trip kinds",
+     "ALTER TABLE trips ADD COLUMN trip_kind INTEGER NOT NULL DEFAULT 0;\n"
+     "UPDATE trips SET trip_type = 'custom_tour' WHERE trip_type = 'custom';\n"
+     "UPDATE trips SET trip_kind = CASE trip_type\n"
+     "    WHEN 'paris_tour' THEN 1 WHEN 'london_tour' THEN 2 WHEN 'berlin_tour' THEN 3\n"
+     "    WHEN 'custom_tour' THEN 4 WHEN 'culinary_tour' THEN 5 ELSE 0 END;\n"
+     "DROP INDEX IF EXISTS idx_trips_type;\n"
+     "CREATE INDEX idx_trips_kind ON trips(trip_kind);\n"},
+    // Existing purchases are priced at today's food prices, the best record left of what
+    // they cost; from here on the price is fixed when the purchase is written
+    {4, "unit prices stored on purchases",
+     "ALTER TABLE purchases ADD COLUMN unit_price_cents INTEGER NOT NULL DEFAULT 0;\n"
+     "DROP TRIGGER IF EXISTS purchases_spending_insert;\n"
+     "DROP TRIGGER IF EXISTS purchases_spending_delete;\n"
+     "DROP TRIGGER IF EXISTS purchases_spending_update;\n"
+     "UPDATE purchases SET unit_price_cents =\n"
+     "    IFNULL((SELECT CAST(ROUND(price * 100) AS INTEGER) FROM foods WHERE id = purchases.food_id), 0);\n"
+     "CREATE TRIGGER purchases_spending_insert AFTER INSERT ON purchases\n"
+     "BEGIN\n"
+     "    INSERT INTO trip_spending (trip_id, purchase_count, item_count, total_cents)\n"
+     "    SELECT NEW.trip_id, 1, NEW.quantity, NEW.quantity * NEW.unit_price_cents\n"
+     "    WHERE NEW.trip_id IS NOT NULL\n"
+     "    ON CONFLICT(trip_id) DO UPDATE SET purchase_count = purchase_count + 1,\n"
+     "        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;\n"
+     "    INSERT INTO city_spending (city_id, purchase_count, item_count, total_cents)\n"
+     "    SELECT NEW.city_id, 1, NEW.quantity, NEW.quantity * NEW.unit_price_cents\n"
+     "    WHERE NEW.city_id IS NOT NULL\n"
+     "    ON CONFLICT(city_id) DO UPDATE SET purchase_count = purchase_count + 1,\n"
+     "        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;\n"
+     "    INSERT INTO food_spending (food_id, purchase_count, item_count, total_cents)\n"
+     "    SELECT NEW.food_id, 1, NEW.quantity, NEW.quantity * NEW.unit_price_cents\n"
+     "    WHERE NEW.food_id IS NOT NULL\n"
+     "    ON CONFLICT(food_id) DO UPDATE SET purchase_count = purchase_count + 1,\n"
+     "        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;\n"
+     "END;\n"
+     "CREATE TRIGGER purchases_spending_delete AFTER DELETE ON purchases\n"
+     "BEGIN\n"
+     "    UPDATE trip_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,\n"
+     "        total_cents = total_cents - OLD.quantity * OLD.unit_price_cents\n"
+     "    WHERE trip_id = OLD.trip_id;\n"
+     "    DELETE FROM trip_spending WHERE trip_id = OLD.trip_id AND purchase_count <= 0;\n"
+     "    UPDATE city_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,\n"
+     "        total_cents = total_cents - OLD.quantity * OLD.unit_price_cents\n"
+     "    WHERE city_id = OLD.city_id;\n"
+     "    DELETE FROM city_spending WHERE city_id = OLD.city_id AND purchase_count <= 0;\n"
+     "    UPDATE food_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,\n"
+     "        total_cents = total_cents - OLD.quantity * OLD.unit_price_cents\n"
+     "    WHERE food_id = OLD.food_id;\n"
+     "    DELETE FROM food_spending WHERE food_id = OLD.food_id AND purchase_count <= 0;\n"
+     "END;\n"
+     "CREATE TRIGGER purchases_spending_update AFTER UPDATE OF city_id, food_id, quantity, trip_id, unit_price_cents ON purchases\n"
+     "BEGIN\n"
+     "    UPDATE trip_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,\n"
+     "        total_cents = total_cents - OLD.quantity * OLD.unit_price_cents\n"
+     "    WHERE trip_id = OLD.trip_id;\n"
+     "    DELETE FROM trip_spending WHERE trip_id = OLD.trip_id AND purchase_count <= 0;\n"
+     "    UPDATE city_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,\n"
+     "        total_cents = total_cents - OLD.quantity * OLD.unit_price_cents\n"
+     "    WHERE city_id = OLD.city_id;\n"
+     "    DELETE FROM city_spending WHERE city_id = OLD.city_id AND purchase_count <= 0;\n"
+     "    UPDATE food_spending SET purchase_count = purchase_count - 1, item_count = item_count - OLD.quantity,\n"
+     "        total_cents = total_cents - OLD.quantity * OLD.unit_price_cents\n"
+     "    WHERE food_id = OLD.food_id;\n"
+     "    DELETE FROM food_spending WHERE food_id = OLD.food_id AND purchase_count <= 0;\n"
+     "    INSERT INTO trip_spending (trip_id, purchase_count, item_count, total_cents)\n"
+     "    SELECT NEW.trip_id, 1, NEW.quantity, NEW.quantity * NEW.unit_price_cents\n"
+     "    WHERE NEW.trip_id IS NOT NULL\n"
+     "    ON CONFLICT(trip_id) DO UPDATE SET purchase_count = purchase_count + 1,\n"
+     "        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;\n"
+     "    INSERT INTO city_spending (city_id, purchase_count, item_count, total_cents)\n"
+     "    SELECT NEW.city_id, 1, NEW.quantity, NEW.quantity * NEW.unit_price_cents\n"
+     "    WHERE NEW.city_id IS NOT NULL\n"
+     "    ON CONFLICT(city_id) DO UPDATE SET purchase_count = purchase_count + 1,\n"
+     "        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;\n"
+     "    INSERT INTO food_spending (food_id, purchase_count, item_count, total_cents)\n"
+     "    SELECT NEW.food_id, 1, NEW.quantity, NEW.quantity * NEW.unit_price_cents\n"
+     "    WHERE NEW.food_id IS NOT NULL\n"
+     "    ON CONFLICT(food_id) DO UPDATE SET purchase_count = purchase_count + 1,\n"
+     "        item_count = item_count + excluded.item_count, total_cents = total_cents + excluded.total_cents;\n"
+     "END;\n"
+     "DELETE FROM trip_spending;\n"
+     "INSERT INTO trip_spending (trip_id, purchase_count, item_count, total_cents)\n"
+     "SELECT trip_id, COUNT(*), SUM(quantity), SUM(quantity * unit_price_cents)\n"
+     "FROM purchases WHERE trip_id IS NOT NULL GROUP BY trip_id;\n"
+     "DELETE FROM city_spending;\n"
+     "INSERT INTO city_spending (city_id, purchase_count, item_count, total_cents)\n"
+     "SELECT city_id, COUNT(*), SUM(quantity), SUM(quantity * unit_price_cents)\n"
+     "FROM purchases WHERE city_id IS NOT NULL GROUP BY city_id;\n"
+     "DELETE FROM food_spending;\n"
+     "INSERT INTO food_spending (food_id, purchase_count, item_count, total_cents)\n"
+     "SELECT food_id, COUNT(*), SUM(quantity), SUM(quantity * unit_price_cents)\n"
+     "FROM purchases WHERE food_id IS NOT NULL GROUP BY food_id;\n"},
+};
+
+DatabaseManager::DatabaseManager() : db(nullptr), isConnected_(false), transactionDepth(0), rollbackOnly(false) {
     dbPath = "database/cs1d_lab3.db";
 }
 
 DatabaseManager& DatabaseManager::getInstance() {
-    if (instance == nullptr) {
-        instance = std::unique_ptr<DatabaseManager>(new DatabaseManager());
-    }
+    // Request threads may race to the first call
+    static std::once_flag created;
+    std::call_once(created, []() { instance = std::unique_ptr<DatabaseManager>(new DatabaseManager()); });
     return *instance;
 }
 
 bool DatabaseManager::connect() {
+    std::lock_guard<std::recursive_mutex> lock(connectionMutex);
     if (isConnected_) {
         return true;
     }
@@ -33,16 +238,56 @@ bool DatabaseManager::connect() {
     
     isConnected_ = true;
     std::cout << "Connected to SQLite database: " << dbPath << std::endl;
+    
+    if (!applyMigrations()) {
+        std::cerr << "Failed to migrate database schema" << std::endl;
+        disconnect();
+        return false;
+    }
+    return true;
+}
+
+int DatabaseManager::getSchemaVersion() {
+    auto result = executeSelect("PRAGMA user_version;");
+    if (result.empty() || result[0].empty()) {
+        return 0;
+    }
+    return std::stoi(result[0][0]);
+}
+
+bool DatabaseManager::applyMigrations() {
+    int currentVersion = getSchemaVersion();
+    
+    for (const auto& migration : MIGRATIONS) {
+        if (migration.version <= currentVersion) {
+            continue;
+        }
+        
+        std::cout << "Migrating database to version " << migration.version
+                  << " (" << migration.description << ")" << std::endl;
+        
+        Transaction transaction(*this);
+        if (!transaction.isActive() ||
+            !executeQuery(migration.sql) ||
+            !executeQuery("PRAGMA user_version = " + std::to_string(migration.version) + ";") ||
+            !transaction.commit()) {
+            return false;
+        }
+        currentVersion = migration.version;
+    }
+    
     return true;
 }
 
 void DatabaseManager::disconnect() {
+    std::lock_guard<std::recursive_mutex> lock(connectionMutex);
     if (db) {
         sqlite3_close(db);
         db = nullptr;
     }
     isConnected_ = false;
-    inTransaction = false;
+    transactionDepth = 0;
+    rollbackOnly = false;
     std::cout << "Disconnected from database" << std::endl;
 }
 
@@ -51,6 +296,7 @@ bool DatabaseManager::isConnected() const {
 }
 
 bool DatabaseManager::executeQuery(const std::string& query) {
+    std::lock_guard<std::recursive_mutex> lock(connectionMutex);
     if (!isConnected()) {
         std::cerr << "Database not connected" << std::endl;
         return false;
@@ -69,6 +315,7 @@ bool DatabaseManager::executeQuery(const std::string& query) {
 }
 
 V<std::vector<std::string>> DatabaseManager::executeSelect(const std::string& query) {
+    std::lock_guard<std::recursive_mutex> lock(connectionMutex);
     V<std::vector<std::string>> results;
     
     if (!isConnected()) {
@@ -99,7 +346,44 @@ V<std::vector<std::string>> DatabaseManager::executeSelect(const std::string& qu
     return results;
 }
 
+bool DatabaseManager::executeSelectEach(const std::string& query,
+                                        const std::function<bool(const std::vector<std::string>&)>& onRow) {
+    std::lock_guard<std::recursive_mutex> lock(connectionMutex);
+    if (!isConnected()) {
+        std::cerr << "Database not connected" << std::endl;
+        return false;
+    }
+    
+    sqlite3_stmt* stmt;
+    int rc = sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+    
+    // One row buffer reused for every row, so memory doesn't grow with the result size
+    std::vector<std::string> row;
+    int columnCount = sqlite3_column_count(stmt);
+    
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        row.resize(columnCount);
+        for (int i = 0; i < columnCount; i++) {
+            const char* value = (const char*)sqlite3_column_text(stmt, i);
+            row[i] = value ? value : "";
+        }
+        if (!onRow(row)) {
+            rc = SQLITE_DONE;
+            break;
+        }
+    }
+    
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE;
+}
+
 int DatabaseManager::executeInsert(const std::string& query) {
+    std::lock_guard<std::recursive_mutex> lock(connectionMutex);
     if (!isConnected()) {
         std::cerr << "Database not connected" << std::endl;
         return -1;
@@ -125,39 +409,71 @@ bool DatabaseManager::executeDelete(const std::string& query) {
     return executeQuery(query);
 }
 
+// A transaction holds the connection lock from BEGIN until COMMIT/ROLLBACK so
+// statements from other threads can't end up inside it
+// Each level of a transaction holds one count of the connection lock until it
+// commits or rolls back. Only the outermost level talks to SQLite: an inner
+// commit just leaves its level, and an inner rollback marks the whole
+// transaction so the outer commit rolls back instead of keeping half the work
 bool DatabaseManager::beginTransaction() {
-    if (inTransaction) {
+    connectionMutex.lock();
+    if (transactionDepth > 0) {
+        transactionDepth++;
         return true;
     }
     
-    bool result = executeQuery("BEGIN TRANSACTION;");
-    if (result) {
-        inTransaction = true;
+    if (!executeQuery("BEGIN TRANSACTION;")) {
+        connectionMutex.unlock();
+        return false;
     }
-    return result;
+    transactionDepth = 1;
+    rollbackOnly = false;
+    return true;
 }
 
 bool DatabaseManager::commitTransaction() {
-    if (!inTransaction) {
+    std::lock_guard<std::recursive_mutex> lock(connectionMutex);
+    if (transactionDepth == 0) {
+        return false;
+    }
+    
+    if (rollbackOnly) {
+        // A failed commit leaves the level open for the caller to roll back
+        std::cerr << "Commit refused: an inner transaction rolled back" << std::endl;
+        return false;
+    }
+    
+    if (transactionDepth > 1) {
+        transactionDepth--;
+        connectionMutex.unlock(); // release this level's lock
         return true;
     }
     
     bool result = executeQuery("COMMIT;");
     if (result) {
-        inTransaction = false;
+        transactionDepth = 0;
+        connectionMutex.unlock(); // release the lock taken in beginTransaction
     }
     return result;
 }
 
 bool DatabaseManager::rollbackTransaction() {
-    if (!inTransaction) {
-        return true;
+    std::lock_guard<std::recursive_mutex> lock(connectionMutex);
+    if (transactionDepth == 0) {
+        return false;
     }
     
-    bool result = executeQuery("ROLLBACK;");
-    if (result) {
-        inTransaction = false;
+    bool result = true;
+    if (transactionDepth > 1) {
+        rollbackOnly = true;
+    } else {
+        // Release the level even if ROLLBACK fails; SQLite may already have
+        // rolled back on its own after the error that brought us here
+        result = executeQuery("ROLLBACK;");
+        rollbackOnly = false;
     }
+    transactionDepth--;
+    connectionMutex.unlock(); // release this level's lock
     return result;
 }
 
@@ -1,29 +1,30 @@
 #include "../../include/entities/City.hpp"
+#include "../../include/entities/NamePool.hpp"
 
-City::City() : id(0), name("") {
+City::City() : id(0), name(&NamePool::getInstance().empty()) {
 }
 
-City::City(int id, const std::string& name) : id(id), name(name) {
+City::City(int id, std::string_view name) : id(id), name(&NamePool::getInstance().intern(name)) {
 }
 
 int City::getId() const {
     return id;
 }
 
-std::string City::getName() const {
-    return name;
+const std::string& City::getName() const {
+    return *name;
 }
 
 void City::setId(int id) {
     this->id = id;
 }
 
-void City::setName(const std::string& name) {
-    this->name = name;
+void City::setName(std::string_view name) {
+    this->name = &NamePool::getInstance().intern(name);
 }
 
 
 void City::print() const {
-    std::cout << "ID: " << id << ", Name: " << name << std::endl;
+    std::cout << "ID: " << id << ", Name: " << *name << std::endl;
     // Example output: "ID: 1, Name: Paris"
 }
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "../../include/entities/CityDistanceTable.hpp"
+#include <algorithm>
+
+CityDistanceTable::CityDistanceTable() : maxCityId(0) {}
+
+CityDistanceTable::CityDistanceTable(const V<CityDistance>& rows) : maxCityId(0) {
+    // Counting sort by from_city_id: count each city's legs, then lay the
+    // cities out back to back and drop every leg into its city's slice
+    int maxFromCityId = 0;
+    for (const auto& row : rows) {
+        if (row.getFromCityId() > 0 && row.getToCityId() > 0) {
+            maxFromCityId = std::max(maxFromCityId, row.getFromCityId());
+            maxCityId = std::max(maxCityId, std::max(row.getFromCityId(), row.getToCityId()));
+        }
+    }
+
+    rowOffsets.assign((size_t)maxFromCityId + 1, 0);
+    size_t legCount = 0;
+    for (const auto& row : rows) {
+        if (row.getFromCityId() > 0 && row.getToCityId() > 0) {
+            rowOffsets[row.getFromCityId()]++;
+            legCount++;
+        }
+    }
+
+    size_t start = 0;
+    for (size_t from = 0; from < rowOffsets.size(); from++) {
+        size_t count = rowOffsets[from];
+        rowOffsets[from] = start;
+        start += count;
+    }
+
+    fromCityIds.resize(legCount);
+    toCityIds.resize(legCount);
+    distances.resize(legCount);
+
+    std::vector<size_t> next(rowOffsets);
+    for (const auto& row : rows) {
+        if (row.getFromCityId() <= 0 || row.getToCityId() <= 0) {
+            continue;
+        }
+        size_t slot = next[row.getFromCityId()]++;
+        fromCityIds[slot] = row.getFromCityId();
+        toCityIds[slot] = row.getToCityId();
+        distances[slot] = row.getDistance();
+    }
+}
+
+bool CityDistanceTable::append(int fromCityId, int toCityId, int distance) {
+    if (fromCityId <= 0 || toCityId <= 0) {
+        return true;
+    }
+    if (!fromCityIds.empty() && fromCityId < fromCityIds.back()) {
+        return false;
+    }
+
+    // Open empty slices for any cities skipped since the previous leg
+    while (rowOffsets.size() <= (size_t)fromCityId) {
+        rowOffsets.push_back(toCityIds.size());
+    }
+
+    fromCityIds.push_back(fromCityId);
+    toCityIds.push_back(toCityId);
+    distances.push_back(distance);
+    maxCityId = std::max(maxCityId, std::max(fromCityId, toCityId));
+    return true;
+}
+
+int CityDistanceTable::findDistance(int fromCityId, int toCityId) const {
+    Row row = getRow(fromCityId);
+    for (size_t i = 0; i < row.size; i++) {
+        if (row.toCityIds[i] == toCityId) {
+            return row.distances[i];
+        }
+    }
+    return -1;
+}
+
+CityDistance CityDistanceTable::at(size_t index) const {
+    return CityDistance(fromCityIds[index], toCityIds[index], distances[index]);
+}
+
+size_t CityDistanceTable::size() const {
+    return toCityIds.size();
+}
+
+int CityDistanceTable::getMaxCityId() const {
+    return maxCityId;
+}
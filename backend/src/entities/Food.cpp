@@ -1,19 +1,20 @@
 #include "../../include/entities/Food.hpp"
+#include "../../include/entities/NamePool.hpp"
 
 
-Food::Food() : id(0), name(""), cityId(0), price(0.0) {
+Food::Food() : id(0), name(&NamePool::getInstance().empty()), cityId(0), price(0.0) {
 }
 
-Food::Food(int id, const std::string& name, int cityId, double price)
-    : id(id), name(name), cityId(cityId), price(price) {
+Food::Food(int id, std::string_view name, int cityId, double price)
+    : id(id), name(&NamePool::getInstance().intern(name)), cityId(cityId), price(price) {
 }
 
 int Food::getId() const {
     return id;
 }
 
-std::string Food::getName() const {
-    return name;
+const std::string& Food::getName() const {
+    return *name;
 }
 
 int Food::getCityId() const {
@@ -28,8 +29,8 @@ void Food::setId(int id) {
     this->id = id;
 }
 
-void Food::setName(const std::string& name) {
-    this->name = name;
+void Food::setName(std::string_view name) {
+    this->name = &NamePool::getInstance().intern(name);
 }
 
 void Food::setCityId(int cityId) {
@@ -41,6 +42,6 @@ void Food::setPrice(double price) {
 }
 
 void Food::print() const {
-    std::cout << "  - " << name << " (€" << std::fixed << std::setprecision(2) << price << ")" << std::endl;
+    std::cout << "  - " << *name << " (€" << std::fixed << std::setprecision(2) << price << ")" << std::endl;
     // Example output: "  - Croissant (€2.50)"
 }
\ No newline at end of file
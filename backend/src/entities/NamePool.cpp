@@ -0,0 +1,34 @@
+#include "../../include/entities/NamePool.hpp"
+
+NamePool::NamePool() {
+    names.push_back(std::string());
+    lookup[names.back()] = &names.back();
+}
+
+NamePool& NamePool::getInstance() {
+    static NamePool instance;
+    return instance;
+}
+
+const std::string& NamePool::intern(std::string_view name) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto existing = lookup.find(name);
+    if (existing != lookup.end()) {
+        return *existing->second;
+    }
+
+    names.push_back(std::string(name));
+    const std::string& pooled = names.back();
+    lookup[pooled] = &pooled;
+    return pooled;
+}
+
+const std::string& NamePool::empty() const {
+    return names.front();
+}
+
+size_t NamePool::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return names.size();
+}
@@ -0,0 +1,58 @@
+#include "../../include/entities/Purchase.hpp"
+
+
+Purchase::Purchase() : id(0), cityId(0), foodId(0), quantity(0), tripId(0) {
+}
+
+Purchase::Purchase(int id, int cityId, int foodId, int quantity, int tripId)
+    : id(id), cityId(cityId), foodId(foodId), quantity(quantity), tripId(tripId) {
+}
+
+int Purchase::getId() const {
+    return id;
+}
+
+int Purchase::getCityId() const {
+    return cityId;
+}
+
+int Purchase::getFoodId() const {
+    return foodId;
+}
+
+int Purchase::getQuantity() const {
+    return quantity;
+}
+
+int Purchase::getTripId() const {
+    return tripId;
+}
+
+void Purchase::setId(int id) {
+    this->id = id;
+}
+
+void Purchase::setCityId(int cityId) {
+    this->cityId = cityId;
+}
+
+void Purchase::setFoodId(int foodId) {
+    this->foodId = foodId;
+}
+
+void Purchase::setQuantity(int quantity) {
+    this->quantity = quantity;
+}
+
+void Purchase::setTripId(int tripId) {
+    this->tripId = tripId;
+}
+
+void Purchase::print() const {
+    std::cout << "  - " << quantity << " x food " << foodId << " in city " << cityId;
+    if (tripId > 0) {
+        std::cout << " (trip " << tripId << ")";
+    }
+    std::cout << std::endl;
+    // Example output: "  - 3 x food 12 in city 4 (trip 7)"
+}
@@ -2,14 +2,14 @@
 #include "../../include/entities/Trip.hpp"
 
     // Constructors
-Trip::Trip() {}
+Trip::Trip() : id(0), start_city_id(0), trip_kind(TripKind::Unknown), total_distance(0) {}
 
-Trip::Trip(int id, int start_city_id, std::string trip_type, double total_distance) :
-    id(id), start_city_id(start_city_id), trip_type(trip_type),
+Trip::Trip(int id, int start_city_id, TripKind trip_kind, double total_distance) :
+    id(id), start_city_id(start_city_id), trip_kind(trip_kind),
      total_distance(total_distance) {}
 
-Trip::Trip(int start_city_id, std::string trip_type, double total_distance) :
-    start_city_id(start_city_id), trip_type(trip_type),
+Trip::Trip(int start_city_id, TripKind trip_kind, double total_distance) :
+    id(0), start_city_id(start_city_id), trip_kind(trip_kind),
      total_distance(total_distance) {}
 
 // Getters
@@ -21,9 +21,13 @@ int Trip::getStartCityId() const
     {
         return start_city_id;
     }
-std::string Trip::getTripType() const
+TripKind Trip::getTripKind() const
     {
-        return trip_type;
+        return trip_kind;
+    }
+const char* Trip::getTripType() const
+    {
+        return tripKindLabel(trip_kind);
     }
 double Trip::getTotalDistance() const
     {
@@ -40,9 +44,9 @@ void Trip::setStartCityId(int start_city_id)
     {
         this->start_city_id = start_city_id;
     }
-void Trip::setTripType(std::string trip_type)
+void Trip::setTripKind(TripKind trip_kind)
     {
-        this->trip_type = trip_type;
+        this->trip_kind = trip_kind;
     }
 void Trip::setTotalDistance(double total_distance)
     {
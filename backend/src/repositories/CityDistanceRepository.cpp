@@ -56,6 +56,23 @@ V<CityDistance> CityDistanceRepository::findAll() {
     return result;
 }
 
+CityDistanceTable CityDistanceRepository::findAllColumnar() {
+    CityDistanceTable table;
+    
+    // Rows come back grouped by from_city_id, nearest first, which is
+    // exactly the order CityDistanceTable::append builds its slices in
+    std::string query = "SELECT from_city_id, to_city_id, distance FROM city_distances ORDER BY from_city_id, distance;";
+    
+    database.executeSelectEach(query, [&table](const std::vector<std::string>& row) {
+        if (row.size() >= 3) {
+            table.append(std::stoi(row[0]), std::stoi(row[1]), std::stoi(row[2]));
+        }
+        return true;
+    });
+    
+    return table;
+}
+
 CityDistance CityDistanceRepository::mapRowToEntity(const std::vector<std::string>& row) {
     int fromCityId = std::stoi(row[0]);
     int toCityId = std::stoi(row[1]);
@@ -0,0 +1,79 @@
+#include "../../include/repositories/PurchaseRepository.hpp"
+#include "../../include/databaseManager.hpp"
+#include <algorithm>
+
+// Rows per INSERT statement in saveAll - keeps each statement well under
+// SQLite's limits on statement length and VALUES terms
+static const size_t ROWS_PER_INSERT = 200;
+
+PurchaseRepository::PurchaseRepository(DatabaseManager& db) : database(db) {
+}
+
+// A trip ID of 0 means "not part of a trip" and is stored as NULL. The unit
+// price is read from foods as the row is written and kept with the purchase,
+// so the spending triggers add and later subtract the same amount
+std::string PurchaseRepository::buildValues(const Purchase& purchase) {
+    std::string foodId = std::to_string(purchase.getFoodId());
+    return "(" + std::to_string(purchase.getCityId()) + ", " + foodId + ", " +
+           std::to_string(purchase.getQuantity()) + ", " +
+           (purchase.getTripId() > 0 ? std::to_string(purchase.getTripId()) : "NULL") + ", " +
+           "IFNULL((SELECT CAST(ROUND(price * 100) AS INTEGER) FROM foods WHERE id = " + foodId + "), 0))";
+}
+
+bool PurchaseRepository::save(Purchase& purchase) {
+    std::string query = "INSERT INTO purchases (city_id, food_id, quantity, trip_id, unit_price_cents) VALUES " +
+                        buildValues(purchase) + ";";
+
+    int newId = database.executeInsert(query);
+    if (newId <= 0) {
+        return false;
+    }
+
+    purchase.setId(newId);
+    return true;
+}
+
+bool PurchaseRepository::saveAll(const V<Purchase>& purchases) {
+    size_t start = 0;
+
+    while (start < purchases.size()) {
+        size_t end = std::min(start + ROWS_PER_INSERT, purchases.size());
+
+        std::string query = "INSERT INTO purchases (city_id, food_id, quantity, trip_id, unit_price_cents) VALUES ";
+        for (size_t i = start; i < end; i++) {
+            if (i > start) {
+                query += ", ";
+            }
+            query += buildValues(purchases[i]);
+        }
+        query += ";";
+
+        if (!database.executeQuery(query)) {
+            return false;
+        }
+        start = end;
+    }
+
+    return true;
+}
+
+V<Purchase> PurchaseRepository::findByTrip(int tripId) {
+    V<Purchase> result;
+
+    std::string query = "SELECT id, city_id, food_id, quantity, IFNULL(trip_id, 0) FROM purchases "
+                        "WHERE trip_id = " + std::to_string(tripId) + " ORDER BY id;";
+
+    auto dbResult = database.executeSelect(query);
+    for (const auto& row : dbResult) {
+        if (row.size() >= 5) {
+            result.push_back(mapRowToEntity(row));
+        }
+    }
+
+    return result;
+}
+
+Purchase PurchaseRepository::mapRowToEntity(const std::vector<std::string>& row) {
+    return Purchase(std::stoi(row[0]), std::stoi(row[1]), std::stoi(row[2]),
+                    std::stoi(row[3]), std::stoi(row[4]));
+}
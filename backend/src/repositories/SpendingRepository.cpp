@@ -0,0 +1,91 @@
+#include "../../include/repositories/SpendingRepository.hpp"
+#include "../../include/databaseManager.hpp"
+
+SpendingRepository::SpendingRepository(DatabaseManager& db) : database(db) {
+}
+
+std::string SpendingRepository::scopeToString(SpendingScope scope) {
+    switch (scope) {
+        case SpendingScope::Trip: return "trip";
+        case SpendingScope::City: return "city";
+        default:                  return "food";
+    }
+}
+
+std::string SpendingRepository::tableFor(SpendingScope scope) {
+    return scopeToString(scope) + "_spending";
+}
+
+std::string SpendingRepository::keyFor(SpendingScope scope) {
+    return scopeToString(scope) + "_id";
+}
+
+// Same arithmetic as the purchases_spending_* triggers in sqlite_schema.sql
+std::string SpendingRepository::buildRecountQuery(SpendingScope scope) {
+    std::string key = keyFor(scope);
+    return "SELECT p." + key + " AS id, COUNT(*) AS purchase_count, SUM(p.quantity) AS item_count, "
+           "SUM(p.quantity * p.unit_price_cents) AS total_cents "
+           "FROM purchases p "
+           "WHERE p." + key + " IS NOT NULL GROUP BY p." + key;
+}
+
+bool SpendingRepository::findTotals(SpendingScope scope, int id, SpendingTotals& totals) {
+    std::string query = "SELECT " + keyFor(scope) + ", purchase_count, item_count, total_cents FROM " +
+                        tableFor(scope) + " WHERE " + keyFor(scope) + " = " + std::to_string(id) + ";";
+
+    auto dbResult = database.executeSelect(query);
+    if (dbResult.empty() || dbResult[0].size() < 4) {
+        return false;
+    }
+
+    totals.id = std::stoi(dbResult[0][0]);
+    totals.purchaseCount = std::stoi(dbResult[0][1]);
+    totals.itemCount = std::stoll(dbResult[0][2]);
+    totals.totalCents = std::stoll(dbResult[0][3]);
+    return true;
+}
+
+V<SpendingMismatch> SpendingRepository::findMismatches(SpendingScope scope) {
+    V<SpendingMismatch> result;
+    std::string table = tableFor(scope);
+    std::string key = keyFor(scope);
+
+    // Rows that are missing or wrong, then aggregate rows with no purchases left
+    std::string query = "WITH expected AS (" + buildRecountQuery(scope) + ") "
+                        "SELECT e.id, IFNULL(s.purchase_count, 0), IFNULL(s.item_count, 0), IFNULL(s.total_cents, 0), "
+                        "e.purchase_count, e.item_count, e.total_cents "
+                        "FROM expected e LEFT JOIN " + table + " s ON s." + key + " = e.id "
+                        "WHERE s." + key + " IS NULL OR s.purchase_count != e.purchase_count "
+                        "OR s.item_count != e.item_count OR s.total_cents != e.total_cents "
+                        "UNION ALL "
+                        "SELECT s." + key + ", s.purchase_count, s.item_count, s.total_cents, 0, 0, 0 "
+                        "FROM " + table + " s WHERE NOT EXISTS (SELECT 1 FROM expected e WHERE e.id = s." + key + ");";
+
+    auto dbResult = database.executeSelect(query);
+    for (const auto& row : dbResult) {
+        if (row.size() < 7) {
+            continue;
+        }
+
+        SpendingMismatch mismatch;
+        mismatch.scope = scope;
+        mismatch.stored.id = mismatch.expected.id = std::stoi(row[0]);
+        mismatch.stored.purchaseCount = std::stoi(row[1]);
+        mismatch.stored.itemCount = std::stoll(row[2]);
+        mismatch.stored.totalCents = std::stoll(row[3]);
+        mismatch.expected.purchaseCount = std::stoi(row[4]);
+        mismatch.expected.itemCount = std::stoll(row[5]);
+        mismatch.expected.totalCents = std::stoll(row[6]);
+        result.push_back(mismatch);
+    }
+
+    return result;
+}
+
+bool SpendingRepository::rebuild(SpendingScope scope) {
+    std::string table = tableFor(scope);
+
+    return database.executeQuery("DELETE FROM " + table + ";") &&
+           database.executeQuery("INSERT INTO " + table + " (" + keyFor(scope) +
+                                 ", purchase_count, item_count, total_cents) " + buildRecountQuery(scope) + ";");
+}
@@ -7,15 +7,15 @@ TripRepository::TripRepository(DatabaseManager& db) : database(db) {
 }
 
 // This function will return a vector of trip objects
-// that match the trip type (starting city)
-V<Trip> TripRepository::findByType(const std::string& tripType) {
+// that match the trip kind
+V<Trip> TripRepository::findByType(TripKind tripKind) {
     //Creating a trip container/vector to hold trip objects
     V<Trip> result;
 
     // SQL query to get all trips by type
-    std::string query = "SELECT id, start_city_id, trip_type, total_distance "
+    std::string query = "SELECT id, start_city_id, trip_kind, total_distance "
                         "FROM trips "
-                        "WHERE trip_type = '" + tripType + "' "
+                        "WHERE trip_kind = " + std::to_string((int)tripKind) + " "
                         "ORDER BY id;";
     // Execute the query
     auto dbResult = database.executeSelect(query);
@@ -41,7 +41,7 @@ V<Trip> TripRepository::findByStartCity(int startCityId) {
     }
 
     // Create the SQL query
-    std::string query = "SELECT id, start_city_id, trip_type, total_distance "
+    std::string query = "SELECT id, start_city_id, trip_kind, total_distance "
                         "FROM trips "
                         "WHERE start_city_id = " + std::to_string(startCityId) + " "
                         "ORDER BY id;";
@@ -63,21 +63,21 @@ V<Trip> TripRepository::findByStartCity(int startCityId) {
 // Expected row format from database:
 // row[0] = "5"           // id as string
 // row[1] = "1"           // start_city_id as string
-// row[2] = "paris_tour"  // trip_type as string
+// row[2] = "1"           // trip_kind as string
 // row[3] = "2847.5"      // total_distance as string
 
 // Converts to:
-// Trip(5, 1, "paris_tour", 2847.5)
+// Trip(5, 1, TripKind::Paris, 2847.5)
 Trip TripRepository::mapRowToEntity(const std::vector<std::string>& row) {
     try {
         // Convert string values to appropriate types
         int id = std::stoi(row[0]);                    // id column
         int startCityId = std::stoi(row[1]);          // start_city_id column
-        std::string tripType = row[2];                 // trip_type column
+        TripKind tripKind = tripKindFromValue(std::stoi(row[2])); // trip_kind column
         double totalDistance = std::stod(row[3]);      // total_distance column
 
         // Create and return Trip object
-        return Trip(id, startCityId, tripType, totalDistance);
+        return Trip(id, startCityId, tripKind, totalDistance);
 
     } catch (const std::exception& e) {
         std::cerr << "Error converting database row to Trip: " << e.what() << std::endl;
@@ -90,15 +90,21 @@ Trip TripRepository::mapRowToEntity(const std::vector<std::string>& row) {
     // trip table
 std::string TripRepository::buildInsertQuery(const Trip& trip) {
     // Build INSERT query - don't include ID since it's auto-increment
-    std::string query = "INSERT INTO trips (start_city_id, trip_type, total_distance) VALUES (";
+    std::string query = "INSERT INTO trips (start_city_id, trip_type, trip_kind, total_distance, created_at) VALUES (";
     // Add start_city_id
     query += std::to_string(trip.getStartCityId()) + ", ";
 
-    // Add trip_type (with quotes since it's a string)
-    query += "'" + trip.getTripType() + "', ";
+    // Add trip_type (with quotes since it's a string) - catalog labels never contain quotes
+    query += "'" + std::string(trip.getTripType()) + "', ";
+
+    // Add trip_kind, the column lookups filter on
+    query += std::to_string((int)trip.getTripKind()) + ", ";
 
     // Add total_distance
-    query += std::to_string(trip.getTotalDistance());
+    query += std::to_string(trip.getTotalDistance()) + ", ";
+
+    // Add created_at explicitly - migrated databases have no default for it
+    query += "CAST(strftime('%s', 'now') AS INTEGER)";
 
     // Close the VALUES clause
     query += ");";
@@ -113,7 +119,8 @@ std::string TripRepository::buildInsertQuery(const Trip& trip) {
 
         // Set each field that can be updated
         query += "start_city_id = " + std::to_string(trip.getStartCityId()) + ", ";
-        query += "trip_type = '" + trip.getTripType() + "', ";
+        query += "trip_type = '" + std::string(trip.getTripType()) + "', ";
+        query += "trip_kind = " + std::to_string((int)trip.getTripKind()) + ", ";
         query += "total_distance = " + std::to_string(trip.getTotalDistance());
 
         // Add WHERE clause to specify which record to update
@@ -130,24 +137,15 @@ bool TripRepository::save(Trip& trip) {
             // New trip - use INSERT
             query = buildInsertQuery(trip);
 
-            if (database.executeQuery(query)) {
-                // ✅ PROPER FIX: Get the actual auto-generated ID from database
-                std::string getIdQuery = "SELECT last_insert_rowid()";
-                auto result = database.executeSelect(getIdQuery);
-
-                if (!result.empty() && !result[0].empty()) {
-                    int newId = std::stoi(result[0][0]);
-                    trip.setId(newId);
-                    std::cout << "✅ Trip saved with database ID: " << newId << std::endl;
-                } else {
-                    // Fallback to incremental ID if database query fails
-                    static int dummyId = 1;
-                    trip.setId(dummyId++);
-                    std::cout << "⚠️ Using fallback ID: " << trip.getId() << std::endl;
-                }
-
+            // executeInsert reads last_insert_rowid() under the same connection lock,
+            // so trips saved concurrently from worker threads can't swap IDs
+            int newId = database.executeInsert(query);
+            if (newId > 0) {
+                trip.setId(newId);
+                std::cout << "✅ Trip saved with database ID: " << newId << std::endl;
                 return true;
             }
+            return false;
         } else {
             // Existing trip - use UPDATE
             query = buildUpdateQuery(trip);
@@ -168,7 +166,7 @@ bool TripRepository::load(int id, Trip& trip) {
 
     try {
         // Build SELECT query for specific ID
-        std::string query = "SELECT id, start_city_id, trip_type, total_distance "
+        std::string query = "SELECT id, start_city_id, trip_kind, total_distance "
                            "FROM trips "
                            "WHERE id = " + std::to_string(id) + ";";
 
@@ -203,7 +201,7 @@ bool TripRepository::load(int id, Trip& trip) {
 V<Trip> TripRepository::findAll() {
     V<Trip> result;
     
-    std::string query = "SELECT id, start_city_id, trip_type, total_distance FROM trips ORDER BY id;";
+    std::string query = "SELECT id, start_city_id, trip_kind, total_distance FROM trips ORDER BY id;";
     
     auto dbResult = database.executeSelect(query);
     
@@ -216,4 +214,144 @@ V<Trip> TripRepository::findAll() {
     return result;
 }
 
+std::string TripRepository::buildPageQuery(int afterId, int limit, TripKind tripKind) {
+    std::string query = "SELECT id, start_city_id, trip_kind, total_distance "
+                        "FROM trips "
+                        "WHERE id > " + std::to_string(afterId) + " ";
+
+    if (tripKind != TripKind::Unknown) {
+        query += "AND trip_kind = " + std::to_string((int)tripKind) + " ";
+    }
+
+    query += "ORDER BY id LIMIT " + std::to_string(limit) + ";";
+    return query;
+}
+
+V<Trip> TripRepository::findPage(int afterId, int limit, TripKind tripKind) {
+    V<Trip> result;
+
+    forEachInPage(afterId, limit, tripKind, [&result](const Trip& trip) {
+        result.push_back(trip);
+        return true;
+    });
+
+    return result;
+}
+
+bool TripRepository::forEachInPage(int afterId, int limit, TripKind tripKind,
+                                   const std::function<bool(const Trip&)>& onTrip) {
+    if (limit <= 0) {
+        return true;
+    }
+
+    return database.executeSelectEach(buildPageQuery(afterId, limit, tripKind),
+                                      [this, &onTrip](const std::vector<std::string>& row) {
+        if (row.size() < 4) {
+            return true;
+        }
+        return onTrip(mapRowToEntity(row));
+    });
+}
+
+// Comma separated id list for IN (...) clauses
+std::string TripRepository::joinIds(const V<int>& ids) {
+    std::string list;
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (i > 0) {
+            list += ", ";
+        }
+        list += std::to_string(ids[i]);
+    }
+    return list;
+}
+
+std::string TripRepository::joinKinds(const V<TripKind>& kinds) {
+    V<int> values;
+    for (size_t i = 0; i < kinds.size(); i++) {
+        values.push_back((int)kinds[i]);
+    }
+    return joinIds(values);
+}
+
+V<int> TripRepository::findExpiredUnreferencedIds(const V<TripKind>& kinds, long long createdBefore, int limit) {
+    V<int> result;
+    if (kinds.empty()) {
+        return result;
+    }
+
+    std::string query = "SELECT id FROM trips "
+                        "WHERE trip_kind IN (" + joinKinds(kinds) + ") "
+                        "AND created_at < " + std::to_string(createdBefore) + " "
+                        "AND NOT EXISTS (SELECT 1 FROM purchases WHERE purchases.trip_id = trips.id) "
+                        "ORDER BY id LIMIT " + std::to_string(limit) + ";";
+
+    auto dbResult = database.executeSelect(query);
+    for (const auto& row : dbResult) {
+        if (!row.empty()) {
+            result.push_back(std::stoi(row[0]));
+        }
+    }
+
+    return result;
+}
+
+V<TripDuplicate> TripRepository::findDuplicateRoutes(const V<TripKind>& kinds, long long createdBefore, int limit) {
+    V<TripDuplicate> result;
+    if (kinds.empty()) {
+        return result;
+    }
+
+    // The inner ORDER BY fixes the order group_concat sees the cities in
+    std::string query = "WITH routes AS ("
+                        "SELECT t.id, t.trip_kind || ':' || IFNULL(t.start_city_id, 0) || ':' || "
+                        "IFNULL((SELECT group_concat(city_id, ',') FROM "
+                        "(SELECT city_id FROM trip_cities WHERE trip_id = t.id ORDER BY visit_order)), '') AS signature "
+                        "FROM trips t "
+                        "WHERE t.trip_kind IN (" + joinKinds(kinds) + ") "
+                        "AND t.created_at < " + std::to_string(createdBefore) + "), "
+                        "canonical AS (SELECT signature, MIN(id) AS id FROM routes "
+                        "GROUP BY signature HAVING COUNT(*) > 1) "
+                        "SELECT c.id, r.id FROM routes r JOIN canonical c ON c.signature = r.signature "
+                        "WHERE r.id <> c.id ORDER BY r.id LIMIT " + std::to_string(limit) + ";";
+
+    auto dbResult = database.executeSelect(query);
+    for (const auto& row : dbResult) {
+        if (row.size() >= 2) {
+            result.push_back(TripDuplicate{std::stoi(row[0]), std::stoi(row[1])});
+        }
+    }
 
+    return result;
+}
+
+bool TripRepository::addToTotalDistance(int tripId, double delta) {
+    return database.executeUpdate("UPDATE trips SET total_distance = total_distance + (" + std::to_string(delta) +
+                                  ") WHERE id = " + std::to_string(tripId) + ";");
+}
+
+bool TripRepository::setTotalDistance(int tripId, double totalDistance) {
+    return database.executeUpdate("UPDATE trips SET total_distance = " + std::to_string(totalDistance) +
+                                  " WHERE id = " + std::to_string(tripId) + ";");
+}
+
+bool TripRepository::mergeDuplicates(int canonicalId, const V<int>& duplicateIds) {
+    if (duplicateIds.empty()) {
+        return true;
+    }
+
+    std::string ids = joinIds(duplicateIds);
+    return database.executeUpdate("UPDATE purchases SET trip_id = " + std::to_string(canonicalId) +
+                                  " WHERE trip_id IN (" + ids + ");") &&
+           deleteByIds(duplicateIds);
+}
+
+bool TripRepository::deleteByIds(const V<int>& ids) {
+    if (ids.empty()) {
+        return true;
+    }
+
+    // foreign_keys is off, so trip_cities rows are removed explicitly
+    std::string list = joinIds(ids);
+    return database.executeDelete("DELETE FROM trip_cities WHERE trip_id IN (" + list + ");") &&
+           database.executeDelete("DELETE FROM trips WHERE id IN (" + list + ");");
+}
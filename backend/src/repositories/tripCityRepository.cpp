@@ -12,6 +12,14 @@
 #include "../include/repositories/TripCityRepository.hpp"
 #include <iostream>
 
+// Rows per INSERT statement in saveAll - keeps each statement well under
+// SQLite's limits on statement length and VALUES terms
+static const size_t ROWS_PER_INSERT = 200;
+
+// Visit orders are lifted above this while being rewritten, clear of every
+// real order, so UNIQUE(trip_id, visit_order) never sees a transient clash
+static const int PARKING_OFFSET = 1000000;
+
 /**
  * @brief Constructor for TripCityRepository
  * @param database Reference to DatabaseManager for SQLite operations
@@ -106,6 +114,50 @@ V<TripCity> TripCityRepository::findAll() {
     return result;
 }
 
+/**
+ * @brief Retrieves one keyset page of TripCity records
+ * @param afterId Only rows with an ID greater than this
+ * @param limit Maximum number of rows to return
+ * @param tripId Restrict to one trip, or 0 for every trip
+ * @return V<TripCity> Up to limit TripCity objects ordered by ID
+ */
+V<TripCity> TripCityRepository::findPage(int afterId, int limit, int tripId) {
+    V<TripCity> result;
+    
+    forEachInPage(afterId, limit, tripId, [&result](const TripCity& tripCity) {
+        result.push_back(tripCity);
+        return true;
+    });
+    
+    return result;
+}
+
+/**
+ * @brief Visits one keyset page of TripCity records
+ * @param afterId Only rows with an ID greater than this
+ * @param limit Maximum number of rows to visit
+ * @param tripId Restrict to one trip, or 0 for every trip
+ * @param onTripCity Called for each row; return false to stop early
+ * @return true if the query ran, false on a database error
+ * 
+ * Rows are mapped and handed over one at a time, so memory use does not
+ * depend on the size of the trip_cities table.
+ */
+bool TripCityRepository::forEachInPage(int afterId, int limit, int tripId,
+                                       const std::function<bool(const TripCity&)>& onTripCity) {
+    if (limit <= 0) {
+        return true;
+    }
+    
+    return db.executeSelectEach(buildSelectPageQuery(afterId, limit, tripId),
+                                [this, &onTripCity](const std::vector<std::string>& row) {
+        if (row.size() < 4) {
+            return true;
+        }
+        return onTripCity(mapRowToEntity(row));
+    });
+}
+
 /**
  * @brief Loads a specific TripCity record by ID
  * @param id The ID of the record to load
@@ -180,20 +232,74 @@ bool TripCityRepository::existsByTripAndOrder(int tripId, int visitOrder) {
  * @param tripCities Vector of TripCity objects to save
  * @return true if all saves were successful, false if any failed
  * 
- * Performs batch save operation. If any individual save fails,
- * the entire operation is considered failed.
+ * Performs batch save operation. New rows are grouped into multi-row
+ * INSERTs of up to ROWS_PER_INSERT rows; existing rows are updated one by
+ * one. If any statement fails, the entire operation is considered failed.
  * 
  * @note This is not a transactional operation - partial saves may occur
  *       if the operation fails partway through.
  */
 bool TripCityRepository::saveAll(const V<TripCity>& tripCities) {
+    std::string insert;
+    size_t pending = 0;
+    
     for (const auto& tripCity : tripCities) {
-        TripCity temp = tripCity; // Create non-const copy
-        if (!save(temp)) {
-            return false;
+        if (tripCity.getId() != 0) {
+            TripCity temp = tripCity; // Create non-const copy
+            if (!save(temp)) {
+                return false;
+            }
+            continue;
+        }
+        
+        insert += pending == 0 ? "INSERT INTO trip_cities (trip_id, city_id, visit_order) VALUES " : ", ";
+        insert += "(" + std::to_string(tripCity.getTripId()) + ", " +
+                  std::to_string(tripCity.getCityId()) + ", " +
+                  std::to_string(tripCity.getVisitOrder()) + ")";
+        pending++;
+        
+        if (pending == ROWS_PER_INSERT) {
+            if (!db.executeQuery(insert + ";")) {
+                return false;
+            }
+            insert.clear();
+            pending = 0;
         }
     }
-    return true;
+    
+    return pending == 0 || db.executeQuery(insert + ";");
+}
+
+/**
+ * @brief Rewrites the visit order of every stop of a trip
+ * @param tripId The ID of the trip
+ * @param tripCityIds IDs of the trip's rows; row i gets visit order i + 1
+ * @return true if both updates succeeded, false otherwise
+ * 
+ * Saving the rows one at a time costs a statement per stop and has to
+ * dodge UNIQUE(trip_id, visit_order) while orders are half rewritten.
+ * Instead the new orders go in with one CASE over the row IDs, parked
+ * above PARKING_OFFSET, and a second statement drops them all into place.
+ * Rows missing from tripCityIds keep their order, which makes the second
+ * statement fail on a clash rather than silently mixing two orderings.
+ */
+bool TripCityRepository::reorderTrip(int tripId, const V<int>& tripCityIds) {
+    if (tripCityIds.empty()) {
+        return true;
+    }
+    
+    std::string trip = std::to_string(tripId);
+    std::string offset = std::to_string(PARKING_OFFSET);
+    
+    std::string park = "UPDATE trip_cities SET visit_order = " + offset + " + CASE id";
+    for (size_t i = 0; i < tripCityIds.size(); i++) {
+        park += " WHEN " + std::to_string(tripCityIds[i]) + " THEN " + std::to_string(i + 1);
+    }
+    park += " ELSE visit_order END WHERE trip_id = " + trip + ";";
+    
+    return db.executeUpdate(park) &&
+           db.executeUpdate("UPDATE trip_cities SET visit_order = visit_order - " + offset +
+                            " WHERE trip_id = " + trip + " AND visit_order > " + offset + ";");
 }
 
 /**
@@ -209,6 +315,40 @@ bool TripCityRepository::removeByTrip(int tripId) {
     return db.executeQuery(query);
 }
 
+/**
+ * @brief Moves the stops at or after a visit order by delta positions
+ * @param tripId The ID of the trip
+ * @param fromOrder First visit order to move
+ * @param delta Positions to move by
+ * @return true if the update succeeded, false otherwise
+ * 
+ * UNIQUE(trip_id, visit_order) is checked row by row, so shifting the rows
+ * straight to their new orders can collide with a neighbour that has not
+ * moved yet, and CHECK(visit_order > 0) rules out parking them at negative
+ * orders. The moved rows are first lifted above any real order, then
+ * dropped onto their final orders.
+ */
+bool TripCityRepository::shiftVisitOrders(int tripId, int fromOrder, int delta) {
+    std::string trip = std::to_string(tripId);
+    std::string offset = std::to_string(PARKING_OFFSET);
+    return db.executeUpdate("UPDATE trip_cities SET visit_order = visit_order + " + offset +
+                            " WHERE trip_id = " + trip + " AND visit_order >= " + std::to_string(fromOrder) + ";") &&
+           db.executeUpdate("UPDATE trip_cities SET visit_order = visit_order - " + offset + " + (" +
+                            std::to_string(delta) + ") WHERE trip_id = " + trip +
+                            " AND visit_order >= " + offset + ";");
+}
+
+/**
+ * @brief Removes the stop at one visit order of a trip
+ * @param tripId The ID of the trip
+ * @param visitOrder The visit order to remove
+ * @return true if the delete succeeded, false otherwise
+ */
+bool TripCityRepository::removeByTripAndOrder(int tripId, int visitOrder) {
+    return db.executeDelete("DELETE FROM trip_cities WHERE trip_id = " + std::to_string(tripId) +
+                            " AND visit_order = " + std::to_string(visitOrder) + ";");
+}
+
 // ============================================================================
 // HELPER METHODS
 // ============================================================================
@@ -310,6 +450,21 @@ std::string TripCityRepository::buildSelectByTripQuery(int tripId) {
            std::to_string(tripId) + " ORDER BY visit_order;";
 }
 
-
-
-
+/**
+ * @brief Builds a keyset page SELECT SQL query
+ * @param afterId Only rows with an ID greater than this
+ * @param limit Maximum number of rows
+ * @param tripId Restrict to one trip, or 0 for every trip
+ * @return std::string The complete SELECT SQL query
+ * 
+ * Seeks on the primary key instead of using OFFSET, so every page costs
+ * the same no matter how far into the table it starts.
+ */
+std::string TripCityRepository::buildSelectPageQuery(int afterId, int limit, int tripId) {
+    std::string query = "SELECT id, trip_id, city_id, visit_order FROM trip_cities WHERE id > " +
+                        std::to_string(afterId);
+    if (tripId > 0) {
+        query += " AND trip_id = " + std::to_string(tripId);
+    }
+    return query + " ORDER BY id LIMIT " + std::to_string(limit) + ";";
+}
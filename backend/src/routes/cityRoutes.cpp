@@ -1,54 +1,168 @@
 #include <crow.h>
+#include "../../include/routes/apiApp.hpp"
 #include "../../include/entities/City.hpp"
 #include "../../include/entities/CityDistance.hpp"
-#include "../../include/services/CityService.hpp"
 #include "../../include/services/FoodService.hpp"
-#include "../../include/repositories/CityDistanceRepository.hpp"
+#include "../../include/services/ReferenceDataCache.hpp"
+#include "../../include/services/ResponseCache.hpp"
+#include "../../include/routes/asyncResponse.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <functional>
+#include <map>
 
-void registerCityRoutes(crow::SimpleApp& app, CityService& cityService, FoodService& foodService, CityDistanceRepository& cityDistanceRepo) {
-    // GET /api/cities - Get all cities from database
-    CROW_ROUTE(app, "/api/cities").methods("GET"_method)([&cityService]() {
-        // Fetch cities directly from your existing database
-        V<City> cities = cityService.getAllCities();
+// Most foods a single search may return
+static const size_t MAX_FOOD_SEARCH_RESULTS = 500;
 
-        // Create JSON response using Crow's built-in support
-        crow::json::wvalue result;
-        result["cities"] = crow::json::wvalue::list();
+// Reads a price query parameter; returns false if it is present but not a number
+static bool readPrice(const crow::request& req, const char* name, double& price) {
+    const char* value = req.url_params.get(name);
+    if (!value || !*value) {
+        return true;
+    }
+    try {
+        size_t used = 0;
+        price = std::stod(value, &used);
+        return used == std::string(value).size() && price >= 0;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+// Reference responses, built and compressed once per snapshot version
+static ResponseCache referenceResponses;
+
+// Answers with the body stored for key at this version, in the best coding the
+// client accepts; build() only runs for the first request after a reload
+static crow::response cachedResponse(const crow::request& req, const std::string& key, uint64_t version,
+                                     const std::string& contentType, const std::function<std::string()>& build) {
+    std::shared_ptr<const CachedResponse> cached = referenceResponses.get(key, version, contentType, build);
+
+    ContentEncoding encoding = negotiateEncoding(req.get_header_value("Accept-Encoding"));
+    crow::response res(200);
+    res.body = cached->bodyFor(encoding);
+    res.set_header("Content-Type", cached->contentType);
+    res.set_header("Vary", "Accept-Encoding");
+    if (encoding != ContentEncoding::Identity) {
+        res.set_header("Content-Encoding", contentEncodingName(encoding));
+    }
+    return res;
+}
+
+static crow::response referenceResponse(const crow::request& req, const std::string& key, uint64_t version,
+                                        const std::function<crow::json::wvalue()>& build) {
+    return cachedResponse(req, key, version, "application/json", [&build]() { return build().dump(); });
+}
+
+// True if the Accept header weighs application/octet-stream above JSON.
+// JSON inherits the weight of application/* or */* when not listed itself.
+static bool acceptsBinary(const crow::request& req) {
+    const std::string& accept = req.get_header_value("Accept");
+    double binary = 0.0;
+    double json = -1.0;
+    double wildcard = -1.0;
+
+    size_t start = 0;
+    while (start < accept.size()) {
+        size_t comma = accept.find(',', start);
+        std::string element = accept.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        start = comma == std::string::npos ? accept.size() : comma + 1;
 
-        for (size_t i = 0; i < cities.size(); i++) {
-            result["cities"][i]["id"] = cities[i].getId();
-            result["cities"][i]["name"] = cities[i].getName();
+        size_t semicolon = element.find(';');
+        std::string type = element.substr(0, semicolon);
+        type.erase(0, type.find_first_not_of(" \t"));
+        type.erase(type.find_last_not_of(" \t") + 1);
+        std::transform(type.begin(), type.end(), type.begin(), [](unsigned char c) { return std::tolower(c); });
+
+        double quality = 1.0;
+        size_t q = semicolon == std::string::npos ? std::string::npos : element.find("q=", semicolon);
+        if (q != std::string::npos) {
+            quality = std::atof(element.c_str() + q + 2);
+        }
+
+        if (type == "application/octet-stream") {
+            binary = quality;
+        } else if (type == "application/json") {
+            json = quality;
+        } else if (type == "application/*" || (type == "*/*" && wildcard < 0)) {
+            wildcard = quality;
         }
+    }
 
-        result["count"] = (int)cities.size();
+    if (json < 0) {
+        json = wildcard < 0 ? 0.0 : wildcard;
+    }
+    return binary > 0 && binary > json;
+}
 
-        return crow::response(200, result);
+void registerCityRoutes(ApiApp& app, FoodService& foodService, ReferenceDataCache& referenceData) {
+    // GET /api/cities - Get all cities from database
+    CROW_ROUTE(app, "/api/cities").methods("GET"_method)([&referenceData](const crow::request& req) {
+        // Cities come from the cached reference data snapshot
+        std::shared_ptr<const ReferenceDataSnapshot> snapshot = referenceData.getSnapshot();
+
+        return referenceResponse(req, "cities", snapshot->version, [&snapshot]() {
+            const V<City>& cities = snapshot->cities;
+
+            // Create JSON response using Crow's built-in support
+            crow::json::wvalue result;
+            result["cities"] = crow::json::wvalue::list();
+
+            for (size_t i = 0; i < cities.size(); i++) {
+                result["cities"][i]["id"] = cities[i].getId();
+                result["cities"][i]["name"] = cities[i].getName();
+            }
+
+            result["count"] = (int)cities.size();
+            return result;
+        });
     });
 
     // GET /api/cities/distances - Get all city distances
-    CROW_ROUTE(app, "/api/cities/distances").methods("GET"_method)([&cityDistanceRepo]() {
+    CROW_ROUTE(app, "/api/cities/distances").methods("GET"_method)([&referenceData](const crow::request& req) {
         try {
             std::cout << "🔍 API: Fetching all city distances..." << std::endl;
             
-            // Fetch all distances from the database
-            V<CityDistance> distances = cityDistanceRepo.findAll();
-            
-            std::cout << "📊 API: Found " << distances.size() << " distance records" << std::endl;
-
-            // Create JSON response
-            crow::json::wvalue result;
-            result["distances"] = crow::json::wvalue::list();
+            // The direct legs held by the current reference data snapshot
+            std::shared_ptr<const ReferenceDataSnapshot> snapshot = referenceData.getSnapshot();
 
-            for (size_t i = 0; i < distances.size(); i++) {
-                result["distances"][i]["from_city_id"] = distances[i].getFromCityId();
-                result["distances"][i]["to_city_id"] = distances[i].getToCityId();
-                result["distances"][i]["distance"] = distances[i].getDistance();
+            // Accept: application/octet-stream gets the legs as one dense int32
+            // matrix (see DistanceMatrix::appendBinary) instead of an object per pair
+            if (acceptsBinary(req)) {
+                crow::response res = cachedResponse(req, "distances-binary", snapshot->version,
+                                                    "application/octet-stream", [&snapshot]() {
+                    std::string body;
+                    DistanceMatrix(snapshot->directDistances).appendBinary(body, snapshot->version);
+                    return body;
+                });
+                res.set_header("Vary", "Accept, Accept-Encoding");
+                return res;
             }
 
-            result["count"] = (int)distances.size();
-            result["message"] = "All city distances retrieved successfully";
+            crow::response res = referenceResponse(req, "distances", snapshot->version, [&snapshot]() {
+                const CityDistanceTable& distances = snapshot->directDistances;
+                std::cout << "📊 API: Found " << distances.size() << " distance records" << std::endl;
 
-            return crow::response(200, result);
+                // Create JSON response
+                crow::json::wvalue result;
+                result["distances"] = crow::json::wvalue::list();
+
+                const int* fromCityIds = distances.getFromCityIds();
+                const int* toCityIds = distances.getToCityIds();
+                const int* kilometres = distances.getDistances();
+                for (size_t i = 0; i < distances.size(); i++) {
+                    result["distances"][i]["from_city_id"] = fromCityIds[i];
+                    result["distances"][i]["to_city_id"] = toCityIds[i];
+                    result["distances"][i]["distance"] = kilometres[i];
+                }
+
+                result["count"] = (int)distances.size();
+                result["message"] = "All city distances retrieved successfully";
+                return result;
+            });
+            res.set_header("Vary", "Accept, Accept-Encoding");
+            return res;
         } catch (const std::exception& e) {
             std::cout << "❌ API Error fetching distances: " << e.what() << std::endl;
             crow::json::wvalue error;
@@ -58,127 +172,236 @@ void registerCityRoutes(crow::SimpleApp& app, CityService& cityService, FoodServ
         }
     });
 
-    // GET /api/cities/food - Get all cities with their corresponding food
-    CROW_ROUTE(app, "/api/cities/food").methods("GET"_method)([&cityService, &foodService]() {
-        // Fetch cities directly from your existing database
-        V<City> cities = cityService.getAllCities();
+    // GET /api/cities/shortest-path?from=1&to=5 - Shortest chain of known legs between two cities
+    CROW_ROUTE(app, "/api/cities/shortest-path").methods("GET"_method)([&referenceData](const crow::request& req) {
+        try {
+            const char* fromParam = req.url_params.get("from");
+            const char* toParam = req.url_params.get("to");
+            if (!fromParam || !toParam) {
+                crow::json::wvalue error;
+                error["error"] = "Missing required query parameters: from, to";
+                return crow::response(400, error);
+            }
 
-        // Create JSON response using Crow's built-in support
-        crow::json::wvalue result;
-        result["cities"] = crow::json::wvalue::list();
+            int fromCityId = std::stoi(fromParam);
+            int toCityId = std::stoi(toParam);
 
-        for (size_t i = 0; i < cities.size(); i++) {
-            result["cities"][i]["id"] = cities[i].getId();
-            result["cities"][i]["name"] = cities[i].getName();
-            
-            // Get foods for this city
-            V<Food> foods = foodService.getFoodsByCityId(cities[i].getId());
-            result["cities"][i]["foods"] = crow::json::wvalue::list();
-            
-            for (size_t j = 0; j < foods.size(); j++) {
-                result["cities"][i]["foods"][j]["id"] = foods[j].getId();
-                result["cities"][i]["foods"][j]["name"] = foods[j].getName();
-                result["cities"][i]["foods"][j]["price"] = foods[j].getPrice();
+            // Paths and city names from one snapshot
+            std::shared_ptr<const ReferenceDataSnapshot> snapshot = referenceData.getSnapshot();
+            const ShortestPaths* paths = &snapshot->shortestPaths;
+            V<int> path = paths->getPath(fromCityId, toCityId);
+            if (path.empty()) {
+                crow::json::wvalue error;
+                error["error"] = "No route between these cities";
+                error["from_city_id"] = fromCityId;
+                error["to_city_id"] = toCityId;
+                return crow::response(404, error);
             }
+
+            crow::json::wvalue result;
+            result["from_city_id"] = fromCityId;
+            result["to_city_id"] = toCityId;
+            result["distance"] = paths->getDistance(fromCityId, toCityId);
+            result["path"] = crow::json::wvalue::list();
+            for (size_t i = 0; i < path.size(); i++) {
+                result["path"][i]["city_id"] = path[i];
+                result["path"][i]["city_name"] = snapshot->cityName(path[i]);
+                if (i > 0) {
+                    result["path"][i]["leg_distance"] = paths->getDistance(path[i - 1], path[i]);
+                }
+            }
+            result["stops"] = (int)path.size();
+
+            return crow::response(200, result);
+        } catch (const std::exception& e) {
+            crow::json::wvalue error;
+            error["error"] = "Failed to find shortest path";
+            error["details"] = e.what();
+            return crow::response(400, error);
         }
+    });
+
+    // GET /api/cities/food - Get all cities with their corresponding food
+    CROW_ROUTE(app, "/api/cities/food").methods("GET"_method)([&referenceData](const crow::request& req) {
+        // Cities and foods come from one snapshot, so the body only changes on reload
+        std::shared_ptr<const ReferenceDataSnapshot> snapshot = referenceData.getSnapshot();
 
-        result["count"] = (int)cities.size();
+        return referenceResponse(req, "cities-food", snapshot->version, [&snapshot]() {
+            const V<City>& cities = snapshot->cities;
 
-        return crow::response(200, result);
+            // Each city's foods by name, as the foods table lists them
+            std::map<int, std::vector<const Food*>> foodsByCity;
+            for (const Food& food : snapshot->foodIndex.getAll()) {
+                foodsByCity[food.getCityId()].push_back(&food);
+            }
+            for (auto& cityFoods : foodsByCity) {
+                std::stable_sort(cityFoods.second.begin(), cityFoods.second.end(),
+                                 [](const Food* a, const Food* b) { return a->getName() < b->getName(); });
+            }
+
+            // Create JSON response using Crow's built-in support
+            crow::json::wvalue result;
+            result["cities"] = crow::json::wvalue::list();
+
+            for (size_t i = 0; i < cities.size(); i++) {
+                result["cities"][i]["id"] = cities[i].getId();
+                result["cities"][i]["name"] = cities[i].getName();
+                
+                const std::vector<const Food*>& foods = foodsByCity[cities[i].getId()];
+                result["cities"][i]["foods"] = crow::json::wvalue::list();
+                
+                for (size_t j = 0; j < foods.size(); j++) {
+                    result["cities"][i]["foods"][j]["id"] = foods[j]->getId();
+                    result["cities"][i]["foods"][j]["name"] = foods[j]->getName();
+                    result["cities"][i]["foods"][j]["price"] = foods[j]->getPrice();
+                }
+            }
+
+            result["count"] = (int)cities.size();
+            return result;
+        });
     });
 
     // GET /api/cities/{id}/food - Get foods for a specific city
-    CROW_ROUTE(app, "/api/cities/<int>/food").methods("GET"_method)([&cityService, &foodService](int cityId) {
-        try {
-            // Get the city first to validate it exists
-            V<City> cities = cityService.getAllCities();
-            bool cityExists = false;
-            std::string cityName;
-            
-            for (const auto& city : cities) {
-                if (city.getId() == cityId) {
-                    cityExists = true;
-                    cityName = city.getName();
-                    break;
+    CROW_ROUTE(app, "/api/cities/<int>/food").methods("GET"_method)([&referenceData, &foodService](const crow::request&, crow::response& res, int cityId) {
+        respondAsync(res, [&referenceData, &foodService, cityId]() -> crow::response {
+            try {
+                // Get the city first to validate it exists
+                std::shared_ptr<const ReferenceDataSnapshot> reference = referenceData.getSnapshot();
+                const City* city = reference->findCity(cityId);
+                
+                if (!city) {
+                    crow::json::wvalue error;
+                    error["error"] = "City not found";
+                    error["city_id"] = cityId;
+                    return crow::response(404, error);
+                }
+                
+                // Get food for this specific city
+                V<Food> food = foodService.getFoodsByCityId(cityId);
+                
+                // Create JSON response
+                crow::json::wvalue result;
+                result["city_id"] = cityId;
+                result["city_name"] = city->getName();
+                result["food"] = crow::json::wvalue::list();
+                
+                for (size_t i = 0; i < food.size(); i++) {
+                    result["food"][i]["id"] = food[i].getId();
+                    result["food"][i]["name"] = food[i].getName();
+                    result["food"][i]["price"] = food[i].getPrice();
                 }
+                
+                result["count"] = (int)food.size();
+                
+                return crow::response(200, result);
+            } catch (const std::exception& e) {
+                crow::json::wvalue error;
+                error["error"] = "Failed to fetch foods for city";
+                return crow::response(500, error);
             }
-            
-            if (!cityExists) {
+        });
+    });
+
+    // GET /api/foods/search - Search foods by price range, city and name prefix
+    // ?min_price=2&max_price=10&city_id=3&prefix=cro&limit=20
+    // Results are cheapest first (name order with a prefix); limit=k gives the k cheapest
+    CROW_ROUTE(app, "/api/foods/search").methods("GET"_method)([&referenceData](const crow::request& req) {
+        try {
+            FoodQuery query;
+            bool valid = readPrice(req, "min_price", query.minPrice) && readPrice(req, "max_price", query.maxPrice);
+
+            const char* cityParam = req.url_params.get("city_id");
+            const char* limitParam = req.url_params.get("limit");
+            const char* prefixParam = req.url_params.get("prefix");
+            if (cityParam) {
+                query.cityId = std::stoi(cityParam);
+            }
+            if (limitParam) {
+                query.limit = std::stoul(limitParam);
+            }
+            if (prefixParam) {
+                query.namePrefix = prefixParam;
+            }
+
+            if (!valid || query.cityId < 0 || query.limit == 0 || query.limit > MAX_FOOD_SEARCH_RESULTS) {
                 crow::json::wvalue error;
-                error["error"] = "City not found";
-                error["city_id"] = cityId;
-                return crow::response(404, error);
+                error["error"] = "Invalid search parameters";
+                error["expected"] = "?min_price=2&max_price=10&city_id=3&prefix=cro&limit=1.." +
+                                    std::to_string(MAX_FOOD_SEARCH_RESULTS);
+                return crow::response(400, error);
             }
-            
-            // Get food for this specific city
-            V<Food> food = foodService.getFoodsByCityId(cityId);
-            
-            // Create JSON response
+
+            auto index = referenceData.getFoodIndex();
+            V<Food> foods = index->search(query);
+
             crow::json::wvalue result;
-            result["city_id"] = cityId;
-            result["city_name"] = cityName;
-            result["food"] = crow::json::wvalue::list();
-            
-            for (size_t i = 0; i < food.size(); i++) {
-                result["food"][i]["id"] = food[i].getId();
-                result["food"][i]["name"] = food[i].getName();
-                result["food"][i]["price"] = food[i].getPrice();
+            result["foods"] = crow::json::wvalue::list();
+            for (size_t i = 0; i < foods.size(); i++) {
+                result["foods"][i]["id"] = foods[i].getId();
+                result["foods"][i]["name"] = foods[i].getName();
+                result["foods"][i]["city_id"] = foods[i].getCityId();
+                result["foods"][i]["price"] = foods[i].getPrice();
             }
-            
-            result["count"] = (int)food.size();
-            
+            result["count"] = (int)foods.size();
+
+            // Without a prefix the full match count comes from the price index for free
+            if (query.namePrefix.empty()) {
+                result["total_matches"] = (int)index->countInPriceRange(query.minPrice, query.maxPrice, query.cityId);
+            }
+
             return crow::response(200, result);
         } catch (const std::exception& e) {
             crow::json::wvalue error;
-            error["error"] = "Failed to fetch foods for city";
-            return crow::response(500, error);
+            error["error"] = "Invalid search parameters";
+            error["details"] = e.what();
+            return crow::response(400, error);
         }
     });
 
     // Might not need - was trying to figure out how to display city distances in custom trip frontend
     // GET /api/cities/with-distances - Get cities with distances from previous city
-    CROW_ROUTE(app, "/api/cities/with-distances").methods("GET"_method)([&cityService, &cityDistanceRepo]() {
+    CROW_ROUTE(app, "/api/cities/with-distances").methods("GET"_method)([&referenceData](const crow::request& req) {
         try {
-            // Fetch all cities
-            V<City> cities = cityService.getAllCities();
-            
-            // Create JSON response
-            crow::json::wvalue result;
-            result["cities"] = crow::json::wvalue::list();
+            // Cities and legs from one snapshot; each lookup below only scans one city's slice
+            std::shared_ptr<const ReferenceDataSnapshot> snapshot = referenceData.getSnapshot();
 
-            for (size_t i = 0; i < cities.size(); i++) {
-                result["cities"][i]["id"] = cities[i].getId();
-                result["cities"][i]["name"] = cities[i].getName();
+            return referenceResponse(req, "cities-with-distances", snapshot->version, [&snapshot]() {
+                const V<City>& cities = snapshot->cities;
+                const CityDistanceTable& allDistances = snapshot->directDistances;
                 
-                // Calculate distance from previous city (if not first city)
-                if (i > 0) {
-                    int prevCityId = cities[i-1].getId();
-                    int currentCityId = cities[i].getId();
-                    
-                    // Find distance between previous city and current city
-                    V<CityDistance> allDistances = cityDistanceRepo.findAll();
-                    int distanceFromPrev = -1;
+                // Create JSON response
+                crow::json::wvalue result;
+                result["cities"] = crow::json::wvalue::list();
+
+                for (size_t i = 0; i < cities.size(); i++) {
+                    result["cities"][i]["id"] = cities[i].getId();
+                    result["cities"][i]["name"] = cities[i].getName();
+                
+                    // Calculate distance from previous city (if not first city)
+                    if (i > 0) {
+                        int prevCityId = cities[i-1].getId();
+                        int currentCityId = cities[i].getId();
                     
-                    for (const auto& dist : allDistances) {
-                        if ((dist.getFromCityId() == prevCityId && dist.getToCityId() == currentCityId) ||
-                            (dist.getFromCityId() == currentCityId && dist.getToCityId() == prevCityId)) {
-                            distanceFromPrev = dist.getDistance();
-                            break;
+                        // Find distance between previous city and current city, in either direction
+                        int distanceFromPrev = allDistances.findDistance(prevCityId, currentCityId);
+                        if (distanceFromPrev < 0) {
+                            distanceFromPrev = allDistances.findDistance(currentCityId, prevCityId);
                         }
-                    }
                     
-                    result["cities"][i]["distance_from_previous"] = distanceFromPrev;
-                    result["cities"][i]["previous_city"] = cities[i-1].getName();
-                } else {
-                    result["cities"][i]["distance_from_previous"] = 0;
-                    result["cities"][i]["previous_city"] = "Starting point";
+                        result["cities"][i]["distance_from_previous"] = distanceFromPrev;
+                        result["cities"][i]["previous_city"] = cities[i-1].getName();
+                    } else {
+                        result["cities"][i]["distance_from_previous"] = 0;
+                        result["cities"][i]["previous_city"] = "Starting point";
+                    }
                 }
-            }
 
-            result["count"] = (int)cities.size();
-            result["message"] = "Cities with distances from previous city";
+                result["count"] = (int)cities.size();
+                result["message"] = "Cities with distances from previous city";
 
-            return crow::response(200, result);
+                return result;
+            });
         } catch (const std::exception& e) {
             crow::json::wvalue error;
             error["error"] = "Failed to fetch cities with distances";
@@ -186,4 +409,31 @@ void registerCityRoutes(crow::SimpleApp& app, CityService& cityService, FoodServ
             return crow::response(500, error);
         }
     });
+
+    // GET /api/admin/reference-data - Version and size of the cached reference data
+    CROW_ROUTE(app, "/api/admin/reference-data").methods("GET"_method)([&referenceData]() {
+        std::shared_ptr<const ReferenceDataSnapshot> snapshot = referenceData.getSnapshot();
+
+        crow::json::wvalue result;
+        result["version"] = snapshot->version;
+        result["cities"] = (int)snapshot->cities.size();
+        result["distances"] = (int)snapshot->directDistances.size();
+        result["foods"] = (int)snapshot->foodIndex.size();
+        result["response_cache"]["hits"] = referenceResponses.getHits();
+        result["response_cache"]["builds"] = referenceResponses.getBuilds();
+        result["response_cache"]["stored_bytes"] = referenceResponses.storedBytes();
+        return crow::response(200, result);
+    });
+
+    // POST /api/admin/reference-data/reload - Rebuild the cache after an import or edit
+    // The new snapshot is built in the background; requests keep reading the
+    // current one until it is swapped in, so poll the GET route for the new version
+    CROW_ROUTE(app, "/api/admin/reference-data/reload").methods("POST"_method)([&referenceData]() {
+        referenceData.requestReload();
+
+        crow::json::wvalue result;
+        result["message"] = "Reference data reload started";
+        result["version"] = referenceData.getVersion();
+        return crow::response(202, result);
+    });
 }
\ No newline at end of file
@@ -0,0 +1,222 @@
+#include <crow.h>
+#include "../../include/routes/apiApp.hpp"
+#include "../../include/entities/Purchase.hpp"
+#include "../../include/services/PurchaseService.hpp"
+#include "../../include/routes/asyncResponse.hpp"
+#include "../../include/routes/jsonFields.hpp"
+#include <atomic>
+
+// Largest bulk submission accepted in one request
+static const size_t MAX_PURCHASES_PER_REQUEST = 1000;
+
+// How long ?wait=true holds the request open for the durability acknowledgement
+static const int ACK_WAIT_MS = 2000;
+
+// Requests currently blocked in ?wait=true. A waiter holds a DB thread for up
+// to ACK_WAIT_MS, so at most all but one thread may wait; past that the
+// request is answered straight away with the pending ticket
+static std::atomic<size_t> ackWaiters(0);
+
+static bool tryStartAckWait() {
+    size_t limit = DatabaseExecutor::getInstance().getThreadCount() - 1;
+    if (ackWaiters.fetch_add(1) >= limit) {
+        ackWaiters.fetch_sub(1);
+        return false;
+    }
+    return true;
+}
+
+// Reads one purchase object; returns an error message, or "" on success
+static std::string parsePurchase(const crow::json::rvalue& json, Purchase& purchase) {
+    if (json.t() != crow::json::type::Object) {
+        return "each purchase must be an object";
+    }
+
+    int cityId, foodId, quantity;
+    if (!readInteger(json, "city_id", cityId)) {
+        return "missing or invalid field: city_id";
+    }
+    if (!readInteger(json, "food_id", foodId)) {
+        return "missing or invalid field: food_id";
+    }
+    if (!readInteger(json, "quantity", quantity)) {
+        return "missing or invalid field: quantity (must be a whole number)";
+    }
+    purchase.setCityId(cityId);
+    purchase.setFoodId(foodId);
+    purchase.setQuantity(quantity);
+
+    if (json.has("trip_id") && json["trip_id"].t() != crow::json::type::Null) {
+        int tripId;
+        if (!readInteger(json, "trip_id", tripId)) {
+            return "invalid field: trip_id";
+        }
+        purchase.setTripId(tripId);
+    }
+
+    return "";
+}
+
+void registerPurchaseRoutes(ApiApp& app, PurchaseService& purchaseService) {
+    // POST /api/purchases - Record one or many food purchases
+    // Body: { "city_id": 1, "food_id": 2, "quantity": 3, "trip_id": 4 },
+    //       an array of those, or { "purchases": [...], "wait": true }
+    // Purchases are queued and written in batches; the response carries the
+    // sequence numbers to poll, or waits for the write with ?wait=true.
+    // Validation reads trips and ?wait=true blocks, so both run on a DB thread;
+    // waiting is skipped once all but one DB thread are already waiting
+    CROW_ROUTE(app, "/api/purchases").methods("POST"_method)([&purchaseService](const crow::request& req, crow::response& res) {
+        respondAsync(res, [&purchaseService, &req]() -> crow::response {
+            try {
+                crow::json::rvalue json = crow::json::load(req.body);
+                if (!json) {
+                    crow::json::wvalue error;
+                    error["error"] = "Invalid JSON in request body";
+                    error["expected"] = "{ \"city_id\": 1, \"food_id\": 2, \"quantity\": 3, \"trip_id\": 4 }";
+                    return crow::response(400, error);
+                }
+
+                bool wait = false;
+                const char* waitParam = req.url_params.get("wait");
+                if (waitParam) {
+                    std::string value = waitParam;
+                    wait = value == "1" || value == "true" || value == "yes";
+                }
+
+                V<Purchase> purchases;
+                std::string parseError;
+
+                if (json.t() == crow::json::type::Object && json.has("purchases")) {
+                    if (json.has("wait") && json["wait"].t() == crow::json::type::True) {
+                        wait = true;
+                    }
+                    if (json["purchases"].t() != crow::json::type::List) {
+                        crow::json::wvalue error;
+                        error["error"] = "Field purchases must be an array";
+                        return crow::response(400, error);
+                    }
+                    for (const auto& purchaseJson : json["purchases"]) {
+                        Purchase purchase;
+                        parseError = parsePurchase(purchaseJson, purchase);
+                        if (!parseError.empty()) {
+                            break;
+                        }
+                        purchases.push_back(purchase);
+                    }
+                } else if (json.t() == crow::json::type::List) {
+                    for (const auto& purchaseJson : json) {
+                        Purchase purchase;
+                        parseError = parsePurchase(purchaseJson, purchase);
+                        if (!parseError.empty()) {
+                            break;
+                        }
+                        purchases.push_back(purchase);
+                    }
+                } else {
+                    Purchase purchase;
+                    parseError = parsePurchase(json, purchase);
+                    purchases.push_back(purchase);
+                }
+
+                if (!parseError.empty()) {
+                    crow::json::wvalue error;
+                    error["error"] = parseError;
+                    error["index"] = (int)purchases.size();
+                    return crow::response(400, error);
+                }
+
+                if (purchases.size() == 0 || purchases.size() > MAX_PURCHASES_PER_REQUEST) {
+                    crow::json::wvalue error;
+                    error["error"] = "A request must contain between 1 and " +
+                                     std::to_string(MAX_PURCHASES_PER_REQUEST) + " purchases";
+                    return crow::response(400, error);
+                }
+
+                for (size_t i = 0; i < purchases.size(); i++) {
+                    std::string invalid = purchaseService.validate(purchases[i]);
+                    if (!invalid.empty()) {
+                        crow::json::wvalue error;
+                        error["error"] = invalid;
+                        error["index"] = (int)i;
+                        return crow::response(400, error);
+                    }
+                }
+
+                PurchaseTicket ticket;
+                if (!purchaseService.submit(purchases, ticket)) {
+                    crow::json::wvalue error;
+                    error["error"] = "Purchase queue is full";
+                    error["message"] = "Too many purchases are waiting to be written, retry shortly";
+                    crow::response busy(429, error);
+                    busy.set_header("Retry-After", "1");
+                    return busy;
+                }
+
+                PurchaseAckStatus status = PurchaseAckStatus::Pending;
+                bool waited = wait && tryStartAckWait();
+                if (waited) {
+                    status = purchaseService.waitFor(ticket, ACK_WAIT_MS);
+                    ackWaiters.fetch_sub(1);
+                }
+
+                crow::json::wvalue result;
+                result["accepted"] = (int)purchases.size();
+                result["first_sequence"] = ticket.firstSequence;
+                result["last_sequence"] = ticket.lastSequence;
+                result["status"] = PurchaseService::statusToString(status);
+                result["status_url"] = "/api/purchases/acks/" + std::to_string(ticket.firstSequence) +
+                                       "/" + std::to_string(ticket.lastSequence);
+                if (wait) {
+                    result["waited"] = waited;
+                }
+
+                if (status == PurchaseAckStatus::Failed) {
+                    result["success"] = false;
+                    result["error"] = "Some purchases could not be written";
+                    return crow::response(500, result);
+                }
+
+                result["success"] = true;
+                return crow::response(status == PurchaseAckStatus::Durable ? 201 : 202, result);
+
+            } catch (const std::exception& e) {
+                crow::json::wvalue error;
+                error["error"] = "Failed to record purchases";
+                error["message"] = e.what();
+                return crow::response(500, error);
+            }
+        });
+    });
+
+    // GET /api/purchases/acks/{sequence} - Durability of a queued purchase
+    CROW_ROUTE(app, "/api/purchases/acks/<int>").methods("GET"_method)([&purchaseService](int sequence) {
+        PurchaseAckStatus status = purchaseService.getStatus(sequence);
+
+        crow::json::wvalue result;
+        result["sequence"] = sequence;
+        result["status"] = PurchaseService::statusToString(status);
+        result["queued"] = (int)purchaseService.queuedCount();
+
+        return crow::response(status == PurchaseAckStatus::Unknown ? 404 : 200, result);
+    });
+
+    // GET /api/purchases/acks/{first}/{last} - Durability of a whole submission
+    // Failed if any purchase in the range was dropped, durable once all were written
+    CROW_ROUTE(app, "/api/purchases/acks/<int>/<int>").methods("GET"_method)([&purchaseService](int first, int last) {
+        if (first > last) {
+            crow::json::wvalue error;
+            error["error"] = "first sequence must not be greater than last";
+            return crow::response(400, error);
+        }
+
+        PurchaseAckStatus status = purchaseService.getStatus(first, last);
+
+        crow::json::wvalue result;
+        result["first_sequence"] = first;
+        result["last_sequence"] = last;
+        result["status"] = PurchaseService::statusToString(status);
+        result["queued"] = (int)purchaseService.queuedCount();
+
+        return crow::response(status == PurchaseAckStatus::Unknown ? 404 : 200, result);
+    });
+}
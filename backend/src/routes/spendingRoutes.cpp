@@ -0,0 +1,102 @@
+#include <crow.h>
+#include "../../include/routes/apiApp.hpp"
+#include "../../include/services/SpendingService.hpp"
+#include "../../include/routes/asyncResponse.hpp"
+
+// Writes one set of totals into a JSON object
+static void writeTotals(crow::json::wvalue& json, const SpendingTotals& totals) {
+    json["purchase_count"] = totals.purchaseCount;
+    json["item_count"] = totals.itemCount;
+    json["total_cents"] = totals.totalCents;
+    json["total_spent"] = totals.totalCents / 100.0;
+}
+
+static crow::response spendingResponse(SpendingService& spendingService, SpendingScope scope, int id) {
+    SpendingTotals totals = spendingService.getTotals(scope, id);
+
+    crow::json::wvalue result;
+    result[SpendingRepository::scopeToString(scope) + "_id"] = id;
+    writeTotals(result, totals);
+    result["success"] = true;
+
+    return crow::response(200, result);
+}
+
+void registerSpendingRoutes(ApiApp& app, SpendingService& spendingService) {
+    // GET /api/trips/{id}/spending - Total spent on a trip
+    CROW_ROUTE(app, "/api/trips/<int>/spending").methods("GET"_method)([&spendingService](const crow::request&, crow::response& res, int tripId) {
+        respondAsync(res, [&spendingService, tripId]() {
+            return spendingResponse(spendingService, SpendingScope::Trip, tripId);
+        });
+    });
+
+    // GET /api/cities/{id}/spending - Total spent in a city across all trips
+    CROW_ROUTE(app, "/api/cities/<int>/spending").methods("GET"_method)([&spendingService](const crow::request&, crow::response& res, int cityId) {
+        respondAsync(res, [&spendingService, cityId]() {
+            return spendingResponse(spendingService, SpendingScope::City, cityId);
+        });
+    });
+
+    // GET /api/foods/{id}/spending - Total spent on one food
+    CROW_ROUTE(app, "/api/foods/<int>/spending").methods("GET"_method)([&spendingService](const crow::request&, crow::response& res, int foodId) {
+        respondAsync(res, [&spendingService, foodId]() {
+            return spendingResponse(spendingService, SpendingScope::Food, foodId);
+        });
+    });
+
+    // GET /api/admin/spending/check - Recount from purchases and report differences (read only)
+    CROW_ROUTE(app, "/api/admin/spending/check").methods("GET"_method)([&spendingService](const crow::request&, crow::response& res) {
+        // A full recount holds the database for a while
+        respondAsync(res, [&spendingService]() -> crow::response {
+            try {
+                V<SpendingMismatch> mismatches = spendingService.checkConsistency();
+
+                crow::json::wvalue result;
+                result["consistent"] = mismatches.empty();
+                result["mismatch_count"] = (int)mismatches.size();
+                result["mismatches"] = crow::json::wvalue::list();
+
+                for (size_t i = 0; i < mismatches.size(); i++) {
+                    result["mismatches"][i]["scope"] = SpendingRepository::scopeToString(mismatches[i].scope);
+                    result["mismatches"][i]["id"] = mismatches[i].stored.id;
+                    writeTotals(result["mismatches"][i]["stored"], mismatches[i].stored);
+                    writeTotals(result["mismatches"][i]["expected"], mismatches[i].expected);
+                }
+
+                result["success"] = true;
+
+                return crow::response(200, result);
+
+            } catch (const std::exception& e) {
+                crow::json::wvalue error;
+                error["error"] = "Failed to check spending aggregates";
+                error["message"] = e.what();
+                return crow::response(500, error);
+            }
+        });
+    });
+
+    // POST /api/admin/spending/rebuild - Recount every aggregate from purchases
+    CROW_ROUTE(app, "/api/admin/spending/rebuild").methods("POST"_method)([&spendingService](const crow::request&, crow::response& res) {
+        respondAsync(res, [&spendingService]() -> crow::response {
+            try {
+                if (!spendingService.rebuild()) {
+                    crow::json::wvalue error;
+                    error["error"] = "Failed to rebuild spending aggregates";
+                    return crow::response(500, error);
+                }
+
+                crow::json::wvalue result;
+                result["rebuilt"] = true;
+                result["success"] = true;
+                return crow::response(200, result);
+
+            } catch (const std::exception& e) {
+                crow::json::wvalue error;
+                error["error"] = "Failed to rebuild spending aggregates";
+                error["message"] = e.what();
+                return crow::response(500, error);
+            }
+        });
+    });
+}
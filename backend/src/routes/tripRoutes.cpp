@@ -1,464 +1,1370 @@
 #include <crow.h>
+#include "../../include/routes/apiApp.hpp"
 #include "../../include/entities/Trip.hpp"
 #include "../../include/entities/City.hpp"
 #include "../../include/services/TripService.hpp"
-#include "../../include/services/CityService.hpp"
+#include "../../include/services/ReferenceDataCache.hpp"
 #include "../../include/services/tripCityService.hpp"
+#include "../../include/services/TripJobService.hpp"
+#include "../../include/services/TaskScheduler.hpp"
+#include "../../include/routes/asyncResponse.hpp"
+#include "../../include/routes/jsonFields.hpp"
+#include "../../include/services/FoodService.hpp"
+#include <cmath>
+#include <map>
+#include <type_traits>
 
-void registerTripRoutes(crow::SimpleApp& app, TripService& tripService, CityService& cityService, TripCityService& tripCityService) {
-    
-    // GET /api/trips/paris - Plan and return Paris tour
-    CROW_ROUTE(app, "/api/trips/paris").methods("GET"_method)([&tripService, &cityService, &tripCityService]() {
+// A saved route is closed when its last stop (by visit order) is the start city again
+static bool returnsToStart(const V<TripCity>& sortedCities) {
+    return sortedCities.size() > 1 &&
+           sortedCities[0].getCityId() == sortedCities[sortedCities.size() - 1].getCityId();
+}
+
+// Adds the visited cities (sorted by visit order, with names) to a trip JSON object
+static void writeTripCities(crow::json::wvalue& tripJson, const ReferenceDataSnapshot& reference, V<TripCity> tripCities) {
+    tripJson["cities"] = crow::json::wvalue::list();
+    std::sort(tripCities.begin(), tripCities.end(),
+              [](const TripCity& a, const TripCity& b) {
+                  return a.getVisitOrder() < b.getVisitOrder();
+              });
+
+    for (size_t i = 0; i < tripCities.size(); i++) {
+        std::string cityName = reference.cityName(tripCities[i].getCityId());
+
+        tripJson["cities"][i]["city_id"] = tripCities[i].getCityId();
+        tripJson["cities"][i]["city_name"] = cityName;
+        tripJson["cities"][i]["visit_order"] = tripCities[i].getVisitOrder();
+    }
+
+    tripJson["total_cities"] = (int)tripCities.size();
+    tripJson["closed"] = returnsToStart(tripCities);
+}
+
+// True when a boolean query parameter is set (?name=true, 1 or yes)
+static bool queryFlag(const crow::request& req, const char* name) {
+    const char* flag = req.url_params.get(name);
+    if (!flag) {
+        return false;
+    }
+    std::string value = flag;
+    return value == "1" || value == "true" || value == "yes";
+}
+
+// True when a JSON body field is literally true
+static bool bodyFlag(const crow::json::rvalue& json, const char* name) {
+    return json.t() == crow::json::type::Object && json.has(name) && json[name].t() == crow::json::type::True;
+}
+
+// True when the request asks for a what-if plan (?dry_run=true) that must not be saved
+static bool isDryRun(const crow::request& req) {
+    return queryFlag(req, "dry_run");
+}
+
+// Route shape from the query string: ?closed=true for a round trip back to
+// the start city, ?two_opt=true to polish the greedy route with 2-opt
+static RouteOptions routeOptions(const crow::request& req) {
+    RouteOptions options;
+    options.closed = queryFlag(req, "closed");
+    options.twoOpt = queryFlag(req, "two_opt");
+    return options;
+}
+
+// Same as above, also honouring "closed" / "two_opt" fields in a JSON body
+static RouteOptions routeOptions(const crow::request& req, const crow::json::rvalue& json) {
+    RouteOptions options = routeOptions(req);
+    options.closed = options.closed || bodyFlag(json, "closed");
+    options.twoOpt = options.twoOpt || bodyFlag(json, "two_opt");
+    return options;
+}
+
+// Builds the response for a dry-run plan: same shape as a saved trip, minus the trip ID
+static crow::response plannedRouteResponse(const PlannedRoute& route, TripKind tripKind,
+                                           ReferenceDataCache& referenceData, const std::string& message) {
+    std::shared_ptr<const ReferenceDataSnapshot> reference = referenceData.getSnapshot();
+
+    crow::json::wvalue result;
+    result["trip"]["type"] = tripKindLabel(tripKind);
+    result["trip"]["start_city_id"] = route.startCityId;
+    result["trip"]["total_distance"] = route.totalDistance;
+    result["trip"]["distance"] = route.totalDistance;
+    result["distance"] = route.totalDistance;
+    result["totalDistance"] = route.totalDistance;
+    result["trip"]["totalDistance"] = route.totalDistance;
+    result["trip"]["distance_string"] = std::to_string((int)route.totalDistance) + " km";
+    result["distance_string"] = std::to_string((int)route.totalDistance) + " km";
+
+    std::string startCityName = reference->cityName(route.startCityId);
+    result["trip"]["start_city_name"] = startCityName;
+
+    V<TripCity> routeCities;
+    for (size_t i = 0; i < route.cityIds.size(); i++) {
+        routeCities.push_back(TripCity(0, route.cityIds[i], i + 1));
+    }
+    writeTripCities(result["trip"], *reference, routeCities);
+    result["trip"]["return_distance"] = route.returnDistance;
+
+    result["dry_run"] = true;
+    result["success"] = true;
+    result["message"] = message;
+
+    return crow::response(200, result);
+}
+
+// Most units of a single food a food plan may include
+static const int MAX_FOOD_QUANTITY = 100;
+
+// Largest food-plan budget in euros; keeps the conversion to cents well inside a long long
+static const double MAX_FOOD_BUDGET = 1000000.0;
+
+// Reads an object of "id": number pairs (JSON keys are always strings).
+// Keys must be whole IDs, and so must the values of an integer map.
+template <class T>
+static bool readIdMap(const crow::json::rvalue& json, std::map<int, T>& out) {
+    if (json.t() != crow::json::type::Object) {
+        return false;
+    }
+    for (const auto& entry : json) {
+        int id;
+        size_t parsed = 0;
         try {
-            // Plan the Paris tour
-            Trip parisTrip = tripService.planParisTour();
-            
-            if (parisTrip.getId() == 0) {
-                crow::json::wvalue error;
-                error["error"] = "Failed to create Paris tour";
-                error["message"] = "Not enough cities in database or trip creation failed";
-                return crow::response(400, error);
+            id = std::stoi(entry.key(), &parsed);
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (parsed != entry.key().size()) {
+            return false;
+        }
+
+        if constexpr (std::is_integral_v<T>) {
+            int value;
+            if (!readIntegerValue(entry, value)) {
+                return false;
             }
-            
-            // Get all cities for name lookup
-            V<City> allCities = cityService.getAllCities();
-            
-            // Get cities in the trip
-            V<TripCity> tripCities = tripCityService.getCitiesForTrip(parisTrip.getId());
-            
-            // Create JSON response
-            crow::json::wvalue result;
-            result["trip"]["id"] = parisTrip.getId();
-            result["trip"]["type"] = parisTrip.getTripType();
-            result["trip"]["start_city_id"] = parisTrip.getStartCityId();
-            result["trip"]["total_distance"] = parisTrip.getTotalDistance();
-            double debugDistance = parisTrip.getTotalDistance();
-            std::cout << "🔍 API DEBUG: Trip ID = " << parisTrip.getId() << std::endl;
-            std::cout << "🔍 API DEBUG: Trip distance = " << debugDistance << std::endl;
-            std::cout << "🔍 API DEBUG: Trip type = " << parisTrip.getTripType() << std::endl;
-
-            // Add distance in multiple formats to ensure frontend can find it
-            result["trip"]["distance"] = debugDistance;           // Alternative name
-            result["distance"] = debugDistance;                   // Root level
-            result["totalDistance"] = debugDistance;              // Root level camelCase
-            result["trip"]["totalDistance"] = debugDistance;      // Trip level camelCase
-
-            // Add as string in case there's a number parsing issue
-            result["trip"]["distance_string"] = std::to_string((int)debugDistance) + " km";
-            result["distance_string"] = std::to_string((int)debugDistance) + " km";
-            
-            // Find start city name
-            std::string startCityName = "Unknown";
-            for (const auto& city : allCities) {
-                if (city.getId() == parisTrip.getStartCityId()) {
-                    startCityName = city.getName();
-                    break;
-                }
+            out[id] = value;
+        } else {
+            if (entry.t() != crow::json::type::Number) {
+                return false;
             }
-            result["trip"]["start_city_name"] = startCityName;
-            
-            // Add cities in route
-            result["trip"]["cities"] = crow::json::wvalue::list();
-            
-            // Sort trip cities by visit order
-            std::sort(tripCities.begin(), tripCities.end(), 
-                      [](const TripCity& a, const TripCity& b) {
-                          return a.getVisitOrder() < b.getVisitOrder();
-                      });
-            
-            for (size_t i = 0; i < tripCities.size(); i++) {
-                // Find city name
-                std::string cityName = "Unknown";
-                for (const auto& city : allCities) {
-                    if (city.getId() == tripCities[i].getCityId()) {
-                        cityName = city.getName();
-                        break;
-                    }
+            out[id] = (T)entry.d();
+        }
+    }
+    return true;
+}
+
+// Writes the per-leg prices of a cost-aware route and the food bought in each city
+static void writeCostBreakdown(crow::json::wvalue& json, const CostedRoute& planned, const ReferenceDataSnapshot& reference) {
+    auto nameOf = [&reference](int cityId) {
+        return reference.cityName(cityId);
+    };
+
+    const RouteCostBreakdown& costs = planned.costs;
+    json["legs"] = crow::json::wvalue::list();
+    for (size_t i = 0; i < costs.legs.size(); i++) {
+        const RouteLeg& leg = costs.legs[i];
+        json["legs"][i]["from_city_id"] = leg.fromCityId;
+        json["legs"][i]["from_city_name"] = nameOf(leg.fromCityId);
+        json["legs"][i]["to_city_id"] = leg.toCityId;
+        json["legs"][i]["to_city_name"] = nameOf(leg.toCityId);
+        json["legs"][i]["distance"] = leg.distance;
+        json["legs"][i]["travel_cost"] = leg.travelCost;
+        json["legs"][i]["food_cost"] = leg.foodCost;
+        json["legs"][i]["weighted_cost"] = leg.weightedCost;
+    }
+
+    json["foods"] = crow::json::wvalue::list();
+    size_t foodIndex = 0;
+    for (int cityId : planned.route.cityIds) {
+        auto food = planned.foodByCity.find(cityId);
+        if (food == planned.foodByCity.end()) {
+            continue;
+        }
+        json["foods"][foodIndex]["city_id"] = cityId;
+        json["foods"][foodIndex]["city_name"] = nameOf(cityId);
+        json["foods"][foodIndex]["food_id"] = food->second.getId();
+        json["foods"][foodIndex]["name"] = food->second.getName();
+        json["foods"][foodIndex]["price"] = food->second.getPrice();
+        foodIndex++;
+    }
+
+    json["start_food_cost"] = costs.startFoodCost;
+    json["travel_cost"] = costs.travelCost;
+    json["food_cost"] = costs.foodCost;
+    json["total_cost"] = costs.totalCost;
+    json["weighted_cost"] = costs.weightedCost;
+}
+
+// Result of an incremental trip edit: the change plus the trip's new route
+static crow::response routeEditResponse(const RouteEdit& edit, int tripId, ReferenceDataCache& referenceData,
+                                        TripCityService& tripCityService) {
+    crow::json::wvalue result;
+    result["trip_id"] = tripId;
+
+    if (edit.status != RouteEditStatus::Applied) {
+        result["success"] = false;
+        result["error"] = edit.error;
+        int code = edit.status == RouteEditStatus::NotFound ? 404
+                   : edit.status == RouteEditStatus::StorageFailed ? 500 : 422;
+        return crow::response(code, result);
+    }
+
+    result["visit_order"] = edit.visitOrder;
+    result["distance_delta"] = edit.distanceDelta;
+    result["total_distance"] = edit.totalDistance;
+    writeTripCities(result["trip"], *referenceData.getSnapshot(), tripCityService.getCitiesForTrip(tripId));
+    result["trip"]["id"] = tripId;
+    result["trip"]["total_distance"] = edit.totalDistance;
+    result["success"] = true;
+
+    return crow::response(200, result);
+}
+
+// Page sizes for the keyset-paginated listings; the cap bounds per-request memory
+static const int DEFAULT_PAGE_SIZE = 100;
+static const int MAX_PAGE_SIZE = 1000;
+
+// Reads a non-negative integer query parameter; returns -1 if it is present but malformed
+static int queryInt(const crow::request& req, const char* name, int fallback) {
+    const char* value = req.url_params.get(name);
+    if (!value || !*value) {
+        return fallback;
+    }
+    try {
+        size_t used = 0;
+        int parsed = std::stoi(value, &used);
+        return used == std::string(value).size() && parsed >= 0 ? parsed : -1;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+// Writes the closing part of a paginated listing: the count and the cursor for the next page
+static void endPage(crow::response& res, int count, int limit, int lastId) {
+    crow::json::wvalue tail;
+    tail["count"] = count;
+    tail["limit"] = limit;
+    // A short page means there is nothing after it
+    if (count == limit && lastId > 0) {
+        tail["next_after"] = lastId;
+    } else {
+        tail["next_after"] = nullptr;
+    }
+    std::string tailJson = tail.dump();
+    res.write("]," + tailJson.substr(1));
+    res.end();
+}
+
+void registerTripRoutes(ApiApp& app, TripService& tripService, ReferenceDataCache& referenceData, TripCityService& tripCityService,
+                        TripJobService& tripJobService, FoodService& foodService) {
+    // Handlers that touch the database finish on the database executor (see
+    // respondAsync), so a slow insert never holds up cached reads on the same
+    // Crow worker; job bookkeeping and scheduler stats answer inline
+    
+    // GET /api/trips/paris - Plan and return Paris tour
+    CROW_ROUTE(app, "/api/trips/paris").methods("GET"_method)([&tripService, &referenceData, &tripCityService](const crow::request& req, crow::response& res) {
+        respondAsync(res, [&tripService, &referenceData, &tripCityService, &req]() -> crow::response {
+            try {
+                RouteOptions options = routeOptions(req);
+                if (isDryRun(req)) {
+                    return plannedRouteResponse(tripService.previewParisTour(options), TripKind::Paris, referenceData,
+                                                "Paris tour planned (dry run, not saved)");
+                }
+
+                // Plan the Paris tour
+                Trip parisTrip = tripService.planParisTour(options);
+                
+                if (parisTrip.getId() == 0) {
+                    crow::json::wvalue error;
+                    error["error"] = "Failed to create Paris tour";
+                    error["message"] = "Not enough cities in database or trip creation failed";
+                    return crow::response(400, error);
+                }
+                
+                // Reference snapshot for city name lookup
+                std::shared_ptr<const ReferenceDataSnapshot> reference = referenceData.getSnapshot();
+                
+                // Get cities in the trip
+                V<TripCity> tripCities = tripCityService.getCitiesForTrip(parisTrip.getId());
+                
+                // Create JSON response
+                crow::json::wvalue result;
+                result["trip"]["id"] = parisTrip.getId();
+                result["trip"]["type"] = parisTrip.getTripType();
+                result["trip"]["start_city_id"] = parisTrip.getStartCityId();
+                result["trip"]["total_distance"] = parisTrip.getTotalDistance();
+                double debugDistance = parisTrip.getTotalDistance();
+                std::cout << "🔍 API DEBUG: Trip ID = " << parisTrip.getId() << std::endl;
+                std::cout << "🔍 API DEBUG: Trip distance = " << debugDistance << std::endl;
+                std::cout << "🔍 API DEBUG: Trip type = " << parisTrip.getTripType() << std::endl;
+
+                // Add distance in multiple formats to ensure frontend can find it
+                result["trip"]["distance"] = debugDistance;           // Alternative name
+                result["distance"] = debugDistance;                   // Root level
+                result["totalDistance"] = debugDistance;              // Root level camelCase
+                result["trip"]["totalDistance"] = debugDistance;      // Trip level camelCase
+
+                // Add as string in case there's a number parsing issue
+                result["trip"]["distance_string"] = std::to_string((int)debugDistance) + " km";
+                result["distance_string"] = std::to_string((int)debugDistance) + " km";
+                
+                // Find start city name
+                std::string startCityName = reference->cityName(parisTrip.getStartCityId());
+                result["trip"]["start_city_name"] = startCityName;
+                
+                // Add cities in route
+                result["trip"]["cities"] = crow::json::wvalue::list();
+                
+                // Sort trip cities by visit order
+                std::sort(tripCities.begin(), tripCities.end(), 
+                          [](const TripCity& a, const TripCity& b) {
+                              return a.getVisitOrder() < b.getVisitOrder();
+                          });
+                
+                for (size_t i = 0; i < tripCities.size(); i++) {
+                    // Find city name
+                    std::string cityName = reference->cityName(tripCities[i].getCityId());
+                    
+                    result["trip"]["cities"][i]["city_id"] = tripCities[i].getCityId();
+                    result["trip"]["cities"][i]["city_name"] = cityName;
+                    result["trip"]["cities"][i]["visit_order"] = tripCities[i].getVisitOrder();
                 }
                 
-                result["trip"]["cities"][i]["city_id"] = tripCities[i].getCityId();
-                result["trip"]["cities"][i]["city_name"] = cityName;
-                result["trip"]["cities"][i]["visit_order"] = tripCities[i].getVisitOrder();
+                result["trip"]["total_cities"] = (int)tripCities.size();
+                result["trip"]["closed"] = returnsToStart(tripCities);
+                result["success"] = true;
+                result["message"] = "Paris tour created successfully";
+                
+                return crow::response(200, result);
+                
+            } catch (const std::exception& e) {
+                crow::json::wvalue error;
+                error["error"] = "Failed to create Paris tour";
+                error["message"] = e.what();
+                return crow::response(500, error);
             }
-            
-            result["trip"]["total_cities"] = (int)tripCities.size();
-            result["success"] = true;
-            result["message"] = "Paris tour created successfully";
-            
-            return crow::response(200, result);
-            
-        } catch (const std::exception& e) {
-            crow::json::wvalue error;
-            error["error"] = "Failed to create Paris tour";
-            error["message"] = e.what();
-            return crow::response(500, error);
-        }
+        });
     });
     
     // GET /api/trips/london - Plan and return London tour
-    CROW_ROUTE(app, "/api/trips/london").methods("GET"_method)([&tripService, &cityService, &tripCityService](const crow::request& req) {
-        try {
-            // ✅ NEW: Parse the 'cities' query parameter
-            int numCities = 13; // Default to all cities
-            auto citiesParam = req.url_params.get("cities");
-            if (citiesParam) {
-                try {
-                    numCities = std::stoi(citiesParam);
-                    std::cout << "🔍 London tour requested with " << numCities << " cities" << std::endl;
-                } catch (const std::exception& e) {
-                    std::cout << "⚠️ Invalid cities parameter, using default (13)" << std::endl;
-                    numCities = 13;
+    CROW_ROUTE(app, "/api/trips/london").methods("GET"_method)([&tripService, &referenceData, &tripCityService](const crow::request& req, crow::response& res) {
+        respondAsync(res, [&tripService, &referenceData, &tripCityService, &req]() -> crow::response {
+            try {
+                // ✅ NEW: Parse the 'cities' query parameter
+                int numCities = 13; // Default to all cities
+                auto citiesParam = req.url_params.get("cities");
+                if (citiesParam) {
+                    try {
+                        numCities = std::stoi(citiesParam);
+                        std::cout << "🔍 London tour requested with " << numCities << " cities" << std::endl;
+                    } catch (const std::exception& e) {
+                        std::cout << "⚠️ Invalid cities parameter, using default (13)" << std::endl;
+                        numCities = 13;
+                    }
                 }
-            }
-            
-            // ✅ UPDATED: Pass numCities to the service
-            Trip londonTrip = tripService.planLondonTour(numCities);
-            
-            if (londonTrip.getId() == 0) {
+                
+                RouteOptions options = routeOptions(req);
+                if (isDryRun(req)) {
+                    return plannedRouteResponse(tripService.previewLondonTour(numCities, options), TripKind::London, referenceData,
+                                                "London tour planned (dry run, not saved)");
+                }
+
+                // ✅ UPDATED: Pass numCities to the service
+                Trip londonTrip = tripService.planLondonTour(numCities, options);
+                
+                if (londonTrip.getId() == 0) {
+                    crow::json::wvalue error;
+                    error["error"] = "Failed to create London tour";
+                    return crow::response(400, error);
+                }
+                
+                // Reference snapshot for city name lookup
+                std::shared_ptr<const ReferenceDataSnapshot> reference = referenceData.getSnapshot();
+                V<TripCity> tripCities = tripCityService.getCitiesForTrip(londonTrip.getId());
+                
+                // Create JSON response (same structure as Paris tour)
+                crow::json::wvalue result;
+                result["trip"]["id"] = londonTrip.getId();
+                result["trip"]["type"] = londonTrip.getTripType();
+                result["trip"]["start_city_id"] = londonTrip.getStartCityId();
+                result["trip"]["total_distance"] = londonTrip.getTotalDistance();
+
+
+    // ✅ ADD THESE DEBUG LINES (same as Paris tour):
+                double debugDistance = londonTrip.getTotalDistance();
+                std::cout << "🔍 API DEBUG: London Trip ID = " << londonTrip.getId() << std::endl;
+                std::cout << "🔍 API DEBUG: London Trip distance = " << debugDistance << std::endl;
+                std::cout << "🔍 API DEBUG: London Trip type = " << londonTrip.getTripType() << std::endl;
+
+                // Add distance in multiple formats to ensure frontend can find it
+                result["trip"]["distance"] = debugDistance;           // Alternative name
+                result["distance"] = debugDistance;                   // Root level
+                result["totalDistance"] = debugDistance;              // Root level camelCase
+                result["trip"]["totalDistance"] = debugDistance;      // Trip level camelCase
+
+                // Add as string in case there's a number parsing issue
+                result["trip"]["distance_string"] = std::to_string((int)debugDistance) + " km";
+                result["distance_string"] = std::to_string((int)debugDistance) + " km";
+                
+                // Find start city name
+                std::string startCityName = reference->cityName(londonTrip.getStartCityId());
+                result["trip"]["start_city_name"] = startCityName;
+                
+                // Add cities in route
+                result["trip"]["cities"] = crow::json::wvalue::list();
+                std::sort(tripCities.begin(), tripCities.end(), 
+                          [](const TripCity& a, const TripCity& b) {
+                              return a.getVisitOrder() < b.getVisitOrder();
+                          });
+                
+                for (size_t i = 0; i < tripCities.size(); i++) {
+                    std::string cityName = reference->cityName(tripCities[i].getCityId());
+                    
+                    result["trip"]["cities"][i]["city_id"] = tripCities[i].getCityId();
+                    result["trip"]["cities"][i]["city_name"] = cityName;
+                    result["trip"]["cities"][i]["visit_order"] = tripCities[i].getVisitOrder();
+                }
+                
+                result["trip"]["total_cities"] = (int)tripCities.size();
+                result["trip"]["closed"] = returnsToStart(tripCities);
+                result["success"] = true;
+                result["message"] = "London tour created successfully";
+                
+                return crow::response(200, result);
+                
+            } catch (const std::exception& e) {
                 crow::json::wvalue error;
                 error["error"] = "Failed to create London tour";
-                return crow::response(400, error);
+                error["message"] = e.what();
+                return crow::response(500, error);
             }
-            
-            // Get all cities for name lookup
-            V<City> allCities = cityService.getAllCities();
-            V<TripCity> tripCities = tripCityService.getCitiesForTrip(londonTrip.getId());
-            
-            // Create JSON response (same structure as Paris tour)
-            crow::json::wvalue result;
-            result["trip"]["id"] = londonTrip.getId();
-            result["trip"]["type"] = londonTrip.getTripType();
-            result["trip"]["start_city_id"] = londonTrip.getStartCityId();
-            result["trip"]["total_distance"] = londonTrip.getTotalDistance();
-
-
-// ✅ ADD THESE DEBUG LINES (same as Paris tour):
-            double debugDistance = londonTrip.getTotalDistance();
-            std::cout << "🔍 API DEBUG: London Trip ID = " << londonTrip.getId() << std::endl;
-            std::cout << "🔍 API DEBUG: London Trip distance = " << debugDistance << std::endl;
-            std::cout << "🔍 API DEBUG: London Trip type = " << londonTrip.getTripType() << std::endl;
-
-            // Add distance in multiple formats to ensure frontend can find it
-            result["trip"]["distance"] = debugDistance;           // Alternative name
-            result["distance"] = debugDistance;                   // Root level
-            result["totalDistance"] = debugDistance;              // Root level camelCase
-            result["trip"]["totalDistance"] = debugDistance;      // Trip level camelCase
-
-            // Add as string in case there's a number parsing issue
-            result["trip"]["distance_string"] = std::to_string((int)debugDistance) + " km";
-            result["distance_string"] = std::to_string((int)debugDistance) + " km";
-            
-            // Find start city name
-            std::string startCityName = "Unknown";
-            for (const auto& city : allCities) {
-                if (city.getId() == londonTrip.getStartCityId()) {
-                    startCityName = city.getName();
-                    break;
+        });
+    });
+    
+    // POST /api/trips/custom - Plan and return custom tour with user parameters
+    CROW_ROUTE(app, "/api/trips/custom").methods("POST"_method)([&tripService, &referenceData, &tripCityService](const crow::request& req, crow::response& res) {
+        respondAsync(res, [&tripService, &referenceData, &tripCityService, &req]() -> crow::response {
+            try {
+                // Debug: Log the incoming request
+                std::cout << "🔍 Custom Trip API Request:" << std::endl;
+                std::cout << "   Method: " << static_cast<int>(req.method) << std::endl;
+                std::cout << "   Body: " << req.body << std::endl;
+                std::cout << "   Content-Type: " << req.get_header_value("Content-Type") << std::endl;
+                
+                // Parse JSON request body
+                crow::json::rvalue json = crow::json::load(req.body);
+                if (!json) {
+                    std::cout << "❌ Failed to parse JSON" << std::endl;
+                    crow::json::wvalue error;
+                    error["error"] = "Invalid JSON in request body";
+                    error["expected"] = "{ \"start_city_id\": 1, \"city_ids\": [2, 3, 4, 5] }";
+                    error["received_body"] = req.body;
+                    return crow::response(400, error);
                 }
-            }
-            result["trip"]["start_city_name"] = startCityName;
-            
-            // Add cities in route
-            result["trip"]["cities"] = crow::json::wvalue::list();
-            std::sort(tripCities.begin(), tripCities.end(), 
-                      [](const TripCity& a, const TripCity& b) {
-                          return a.getVisitOrder() < b.getVisitOrder();
-                      });
-            
-            for (size_t i = 0; i < tripCities.size(); i++) {
-                std::string cityName = "Unknown";
-                for (const auto& city : allCities) {
-                    if (city.getId() == tripCities[i].getCityId()) {
-                        cityName = city.getName();
-                        break;
-                    }
+
+                // Extract start city ID
+                int startCityId;
+                if (!readInteger(json, "start_city_id", startCityId)) {
+                    std::cout << "❌ Missing or invalid start_city_id field" << std::endl;
+                    crow::json::wvalue error;
+                    error["error"] = "Missing or invalid field: start_city_id (must be a city ID)";
+                    error["example"] = "{ \"start_city_id\": 1, \"city_ids\": [2, 3, 4] }";
+                    return crow::response(400, error);
+                }
+
+                // Extract cities to visit
+                V<int> citiesToVisit;
+                if (!readIntegerList(json, "city_ids", citiesToVisit)) {
+                    std::cout << "❌ Missing or invalid field: city_ids (must be array of city IDs)" << std::endl;
+                    crow::json::wvalue error;
+                    error["error"] = "Missing or invalid field: city_ids (must be array of city IDs)";
+                    error["example"] = "{ \"start_city_id\": 1, \"city_ids\": [2, 3, 4] }";
+                    return crow::response(400, error);
+                }
+
+                if (citiesToVisit.size() == 0) {
+                    std::cout << "❌ At least one city must be specified in city_ids" << std::endl;
+                    crow::json::wvalue error;
+                    error["error"] = "At least one city must be specified in city_ids";
+                    return crow::response(400, error);
                 }
+
+                std::cout << "🔍 API: Custom trip request - Start: " << startCityId 
+                          << ", Cities: " << citiesToVisit.size() << std::endl;
+
+                RouteOptions options = routeOptions(req, json);
+
+                // What-if requests are planned in memory and never saved
+                if (isDryRun(req) || bodyFlag(json, "dry_run")) {
+                    return plannedRouteResponse(tripService.previewCustomTour(startCityId, citiesToVisit, nullptr, options),
+                                                TripKind::Custom, referenceData, "Custom tour planned (dry run, not saved)");
+                }
+
+                // Plan the custom trip with user parameters
+                Trip customTrip = tripService.planCustomTour(startCityId, citiesToVisit, nullptr, options);
                 
-                result["trip"]["cities"][i]["city_id"] = tripCities[i].getCityId();
-                result["trip"]["cities"][i]["city_name"] = cityName;
-                result["trip"]["cities"][i]["visit_order"] = tripCities[i].getVisitOrder();
+                if (customTrip.getId() == 0) {
+                    crow::json::wvalue error;
+                    error["error"] = "Failed to create custom tour";
+                    return crow::response(400, error);
+                }
+                
+                // Reference snapshot for city name lookup
+                std::shared_ptr<const ReferenceDataSnapshot> reference = referenceData.getSnapshot();
+                V<TripCity> tripCities = tripCityService.getCitiesForTrip(customTrip.getId());
+                
+                // Create JSON response (same structure as other trips)
+                crow::json::wvalue result;
+                result["trip"]["id"] = customTrip.getId();
+                result["trip"]["type"] = customTrip.getTripType();
+                result["trip"]["start_city_id"] = customTrip.getStartCityId();
+                result["trip"]["total_distance"] = customTrip.getTotalDistance();
+
+                // Add debug and multiple formats
+                double debugDistance = customTrip.getTotalDistance();
+                std::cout << "🔍 API DEBUG: Custom Trip ID = " << customTrip.getId() << std::endl;
+                std::cout << "🔍 API DEBUG: Custom Trip distance = " << debugDistance << std::endl;
+                std::cout << "🔍 API DEBUG: Custom Trip type = " << customTrip.getTripType() << std::endl;
+
+                result["trip"]["distance"] = debugDistance;
+                result["distance"] = debugDistance;
+                result["totalDistance"] = debugDistance;
+                result["trip"]["totalDistance"] = debugDistance;
+                result["trip"]["distance_string"] = std::to_string((int)debugDistance) + " km";
+                result["distance_string"] = std::to_string((int)debugDistance) + " km";
+                
+                // Find start city name
+                std::string startCityName = reference->cityName(customTrip.getStartCityId());
+                result["trip"]["start_city_name"] = startCityName;
+                
+                // Add cities in route
+                result["trip"]["cities"] = crow::json::wvalue::list();
+                std::sort(tripCities.begin(), tripCities.end(), 
+                          [](const TripCity& a, const TripCity& b) {
+                              return a.getVisitOrder() < b.getVisitOrder();
+                          });
+                
+                for (size_t i = 0; i < tripCities.size(); i++) {
+                    std::string cityName = reference->cityName(tripCities[i].getCityId());
+                    
+                    result["trip"]["cities"][i]["city_id"] = tripCities[i].getCityId();
+                    result["trip"]["cities"][i]["city_name"] = cityName;
+                    result["trip"]["cities"][i]["visit_order"] = tripCities[i].getVisitOrder();
+                }
+                
+                result["trip"]["total_cities"] = (int)tripCities.size();
+                result["trip"]["closed"] = returnsToStart(tripCities);
+                result["success"] = true;
+                result["message"] = "Custom tour created successfully";
+                
+                return crow::response(200, result);
+                
+            } catch (const std::exception& e) {
+                crow::json::wvalue error;
+                error["error"] = "Failed to create custom tour";
+                error["message"] = e.what();
+                return crow::response(500, error);
             }
-            
-            result["trip"]["total_cities"] = (int)tripCities.size();
-            result["success"] = true;
-            result["message"] = "London tour created successfully";
-            
-            return crow::response(200, result);
-            
-        } catch (const std::exception& e) {
-            crow::json::wvalue error;
-            error["error"] = "Failed to create London tour";
-            error["message"] = e.what();
-            return crow::response(500, error);
-        }
+        });
     });
     
-    // POST /api/trips/custom - Plan and return custom tour with user parameters
-    CROW_ROUTE(app, "/api/trips/custom").methods("POST"_method)([&tripService, &cityService, &tripCityService](const crow::request& req) {
+    // POST /api/trips/jobs - Queue a custom tour and return a job ID immediately
+    CROW_ROUTE(app, "/api/trips/jobs").methods("POST"_method)([&tripJobService](const crow::request& req) {
         try {
-            // Debug: Log the incoming request
-            std::cout << "🔍 Custom Trip API Request:" << std::endl;
-            std::cout << "   Method: " << static_cast<int>(req.method) << std::endl;
-            std::cout << "   Body: " << req.body << std::endl;
-            std::cout << "   Content-Type: " << req.get_header_value("Content-Type") << std::endl;
-            
-            // Parse JSON request body
             crow::json::rvalue json = crow::json::load(req.body);
             if (!json) {
-                std::cout << "❌ Failed to parse JSON" << std::endl;
                 crow::json::wvalue error;
                 error["error"] = "Invalid JSON in request body";
                 error["expected"] = "{ \"start_city_id\": 1, \"city_ids\": [2, 3, 4, 5] }";
-                error["received_body"] = req.body;
                 return crow::response(400, error);
             }
 
-            // Extract start city ID
-            if (!json.has("start_city_id")) {
-                std::cout << "❌ Missing start_city_id field" << std::endl;
+            int startCityId;
+            if (!readInteger(json, "start_city_id", startCityId)) {
                 crow::json::wvalue error;
-                error["error"] = "Missing required field: start_city_id";
+                error["error"] = "Missing or invalid field: start_city_id (must be a city ID)";
                 error["example"] = "{ \"start_city_id\": 1, \"city_ids\": [2, 3, 4] }";
                 return crow::response(400, error);
             }
-            int startCityId = json["start_city_id"].i();
 
-            // Extract cities to visit
-            if (!json.has("city_ids") || json["city_ids"].t() != crow::json::type::List) {
-                std::cout << "❌ Missing or invalid field: city_ids (must be array)" << std::endl;
+            V<int> citiesToVisit;
+            if (!readIntegerList(json, "city_ids", citiesToVisit)) {
                 crow::json::wvalue error;
-                error["error"] = "Missing or invalid field: city_ids (must be array)";
+                error["error"] = "Missing or invalid field: city_ids (must be array of city IDs)";
                 error["example"] = "{ \"start_city_id\": 1, \"city_ids\": [2, 3, 4] }";
                 return crow::response(400, error);
             }
 
-            V<int> citiesToVisit;
-            for (const auto& cityJson : json["city_ids"]) {
-                citiesToVisit.push_back(cityJson.i());
-            }
-
             if (citiesToVisit.size() == 0) {
-                std::cout << "❌ At least one city must be specified in city_ids" << std::endl;
                 crow::json::wvalue error;
                 error["error"] = "At least one city must be specified in city_ids";
                 return crow::response(400, error);
             }
 
-            std::cout << "🔍 API: Custom trip request - Start: " << startCityId 
-                      << ", Cities: " << citiesToVisit.size() << std::endl;
-
-            // Plan the custom trip with user parameters
-            Trip customTrip = tripService.planCustomTour(startCityId, citiesToVisit);
-            
-            if (customTrip.getId() == 0) {
+            int jobId = tripJobService.submit(startCityId, citiesToVisit, routeOptions(req, json));
+            if (jobId < 0) {
                 crow::json::wvalue error;
-                error["error"] = "Failed to create custom tour";
-                return crow::response(400, error);
+                error["error"] = "Trip planning queue is full";
+                error["message"] = "Too many trips are waiting to be planned, retry shortly";
+                crow::response res(429, error);
+                res.set_header("Retry-After", "1");
+                return res;
             }
-            
-            // Get all cities for name lookup
-            V<City> allCities = cityService.getAllCities();
-            V<TripCity> tripCities = tripCityService.getCitiesForTrip(customTrip.getId());
-            
-            // Create JSON response (same structure as other trips)
+
             crow::json::wvalue result;
-            result["trip"]["id"] = customTrip.getId();
-            result["trip"]["type"] = customTrip.getTripType();
-            result["trip"]["start_city_id"] = customTrip.getStartCityId();
-            result["trip"]["total_distance"] = customTrip.getTotalDistance();
-
-            // Add debug and multiple formats
-            double debugDistance = customTrip.getTotalDistance();
-            std::cout << "🔍 API DEBUG: Custom Trip ID = " << customTrip.getId() << std::endl;
-            std::cout << "🔍 API DEBUG: Custom Trip distance = " << debugDistance << std::endl;
-            std::cout << "🔍 API DEBUG: Custom Trip type = " << customTrip.getTripType() << std::endl;
-
-            result["trip"]["distance"] = debugDistance;
-            result["distance"] = debugDistance;
-            result["totalDistance"] = debugDistance;
-            result["trip"]["totalDistance"] = debugDistance;
-            result["trip"]["distance_string"] = std::to_string((int)debugDistance) + " km";
-            result["distance_string"] = std::to_string((int)debugDistance) + " km";
-            
-            // Find start city name
-            std::string startCityName = "Unknown";
-            for (const auto& city : allCities) {
-                if (city.getId() == customTrip.getStartCityId()) {
-                    startCityName = city.getName();
-                    break;
-                }
-            }
-            result["trip"]["start_city_name"] = startCityName;
-            
-            // Add cities in route
-            result["trip"]["cities"] = crow::json::wvalue::list();
-            std::sort(tripCities.begin(), tripCities.end(), 
-                      [](const TripCity& a, const TripCity& b) {
-                          return a.getVisitOrder() < b.getVisitOrder();
-                      });
-            
-            for (size_t i = 0; i < tripCities.size(); i++) {
-                std::string cityName = "Unknown";
-                for (const auto& city : allCities) {
-                    if (city.getId() == tripCities[i].getCityId()) {
-                        cityName = city.getName();
-                        break;
-                    }
-                }
-                
-                result["trip"]["cities"][i]["city_id"] = tripCities[i].getCityId();
-                result["trip"]["cities"][i]["city_name"] = cityName;
-                result["trip"]["cities"][i]["visit_order"] = tripCities[i].getVisitOrder();
-            }
-            
-            result["trip"]["total_cities"] = (int)tripCities.size();
+            result["job_id"] = jobId;
+            result["status"] = TripJobService::statusToString(TripJobStatus::Queued);
+            result["status_url"] = "/api/trips/jobs/" + std::to_string(jobId);
             result["success"] = true;
-            result["message"] = "Custom tour created successfully";
-            
-            return crow::response(200, result);
-            
+
+            return crow::response(202, result);
+
         } catch (const std::exception& e) {
             crow::json::wvalue error;
-            error["error"] = "Failed to create custom tour";
+            error["error"] = "Failed to queue custom tour";
             error["message"] = e.what();
             return crow::response(500, error);
         }
     });
-    
-    // GET /api/trips/berlin - Plan and return Berlin tour
-    CROW_ROUTE(app, "/api/trips/berlin").methods("GET"_method)([&tripService, &cityService, &tripCityService]() {
-        try {
-            Trip berlinTrip = tripService.planBerlinTour();
-            
-            if (berlinTrip.getId() == 0) {
+
+    // GET /api/trips/jobs/{id} - Poll an asynchronous trip planning job
+    CROW_ROUTE(app, "/api/trips/jobs/<int>").methods("GET"_method)([&tripJobService, &referenceData, &tripCityService](const crow::request&, crow::response& res, int jobId) {
+        respondAsync(res, [&tripJobService, &referenceData, &tripCityService, jobId]() -> crow::response {
+            try {
+                TripJob job;
+                if (!tripJobService.getJob(jobId, job)) {
+                    crow::json::wvalue error;
+                    error["error"] = "Job not found";
+                    error["job_id"] = jobId;
+                    return crow::response(404, error);
+                }
+
+                crow::json::wvalue result;
+                result["job_id"] = job.id;
+                result["status"] = TripJobService::statusToString(job.status);
+                result["progress"]["cities_planned"] = job.citiesPlanned;
+                result["progress"]["target_cities"] = job.targetCities;
+                result["progress"]["percent"] = job.targetCities > 0 ? (100 * job.citiesPlanned) / job.targetCities : 0;
+                result["best_distance"] = job.bestDistance;
+
+                if (job.status == TripJobStatus::Completed) {
+                    std::shared_ptr<const ReferenceDataSnapshot> reference = referenceData.getSnapshot();
+
+                    result["trip"]["id"] = job.trip.getId();
+                    result["trip"]["type"] = job.trip.getTripType();
+                    result["trip"]["start_city_id"] = job.trip.getStartCityId();
+                    result["trip"]["total_distance"] = job.trip.getTotalDistance();
+                    writeTripCities(result["trip"], *reference, tripCityService.getCitiesForTrip(job.trip.getId()));
+                } else if (job.status == TripJobStatus::Failed) {
+                    result["error"] = job.error;
+                }
+
+                result["success"] = job.status != TripJobStatus::Failed;
+
+                return crow::response(200, result);
+
+            } catch (const std::exception& e) {
                 crow::json::wvalue error;
-                error["error"] = "Failed to create Berlin tour";
-                return crow::response(400, error);
+                error["error"] = "Failed to fetch trip job";
+                error["message"] = e.what();
+                return crow::response(500, error);
             }
-            
-            // Get all cities for name lookup
-            V<City> allCities = cityService.getAllCities();
-            V<TripCity> tripCities = tripCityService.getCitiesForTrip(berlinTrip.getId());
-            
-            // Create JSON response (same structure)
-            crow::json::wvalue result;
-            result["trip"]["id"] = berlinTrip.getId();
-            result["trip"]["type"] = berlinTrip.getTripType();
-            result["trip"]["start_city_id"] = berlinTrip.getStartCityId();
-            result["trip"]["total_distance"] = berlinTrip.getTotalDistance();
-
-
-            // ✅ ADD DEBUG AND MULTIPLE FORMATS:
-            double debugDistance = berlinTrip.getTotalDistance();
-            std::cout << "🔍 API DEBUG: Berlin Trip ID = " << berlinTrip.getId() << std::endl;
-            std::cout << "🔍 API DEBUG: Berlin Trip distance = " << debugDistance << std::endl;
-            std::cout << "🔍 API DEBUG: Berlin Trip type = " << berlinTrip.getTripType() << std::endl;
-
-            result["trip"]["distance"] = debugDistance;
-            result["distance"] = debugDistance;
-            result["totalDistance"] = debugDistance;
-            result["trip"]["totalDistance"] = debugDistance;
-            result["trip"]["distance_string"] = std::to_string((int)debugDistance) + " km";
-            result["distance_string"] = std::to_string((int)debugDistance) + " km";
-
-
-            
-            // Find start city name
-            std::string startCityName = "Unknown";
-            for (const auto& city : allCities) {
-                if (city.getId() == berlinTrip.getStartCityId()) {
-                    startCityName = city.getName();
-                    break;
+        });
+    });
+
+    // DELETE /api/trips/jobs/{id} - Cancel a queued or running trip planning job
+    CROW_ROUTE(app, "/api/trips/jobs/<int>").methods("DELETE"_method)([&tripJobService](int jobId) {
+        TripJob job;
+        if (!tripJobService.getJob(jobId, job)) {
+            crow::json::wvalue error;
+            error["error"] = "Job not found";
+            error["job_id"] = jobId;
+            return crow::response(404, error);
+        }
+
+        if (!tripJobService.cancel(jobId)) {
+            crow::json::wvalue error;
+            error["error"] = "Job already finished";
+            error["job_id"] = jobId;
+            error["status"] = TripJobService::statusToString(job.status);
+            return crow::response(409, error);
+        }
+
+        // A running job stops at its next progress update; poll for "cancelled"
+        crow::json::wvalue result;
+        result["job_id"] = jobId;
+        result["message"] = "Cancellation requested";
+        result["status_url"] = "/api/trips/jobs/" + std::to_string(jobId);
+        result["success"] = true;
+        return crow::response(202, result);
+    });
+
+    // GET /api/admin/scheduler - Queue depths and steal counts of the shared task scheduler,
+    // plus the trip job and database executor queues
+    CROW_ROUTE(app, "/api/admin/scheduler").methods("GET"_method)([&tripJobService]() {
+        TaskSchedulerStats stats = TaskScheduler::getInstance().getStats();
+
+        crow::json::wvalue result;
+        result["workers"] = stats.workerCount;
+        result["queued_tasks"] = stats.queuedTasks;
+        result["submitted"] = stats.submitted;
+        result["executed"] = stats.executed;
+        result["steals"] = stats.steals;
+        result["helped"] = stats.helped;
+        result["queue_depths"] = crow::json::wvalue::list();
+        for (size_t i = 0; i < stats.queueDepths.size(); i++) {
+            result["queue_depths"][i] = stats.queueDepths[i];
+        }
+        result["trip_jobs"]["queued"] = tripJobService.queuedJobCount();
+        result["trip_jobs"]["running"] = tripJobService.runningJobCount();
+
+        DatabaseExecutor& databaseExecutor = DatabaseExecutor::getInstance();
+        result["database"]["threads"] = databaseExecutor.getThreadCount();
+        result["database"]["queued"] = databaseExecutor.queuedCount();
+        result["database"]["running"] = databaseExecutor.runningCount();
+        return crow::response(200, result);
+    });
+
+    // POST /api/trips/batch - Plan many custom tours in one request
+    // Body: [{ "start_city_id": 1, "city_ids": [2, 3] }, ...] or { "trips": [...] }
+    // Response: newline-delimited JSON, one line per requested trip in request order
+    CROW_ROUTE(app, "/api/trips/batch").methods("POST"_method)([&tripService, &referenceData](const crow::request& req, crow::response& res) {
+        respondAsync(res, [&tripService, &referenceData, &req](crow::response& res) {
+            try {
+                crow::json::rvalue json = crow::json::load(req.body);
+                if (!json) {
+                    crow::json::wvalue error;
+                    error["error"] = "Invalid JSON in request body";
+                    error["expected"] = "[{ \"start_city_id\": 1, \"city_ids\": [2, 3, 4] }, ...]";
+                    res = crow::response(400, error);
+                    res.end();
+                    return;
                 }
-            }
-            result["trip"]["start_city_name"] = startCityName;
-            
-            // Add cities in route
-            result["trip"]["cities"] = crow::json::wvalue::list();
-            std::sort(tripCities.begin(), tripCities.end(), 
-                      [](const TripCity& a, const TripCity& b) {
-                          return a.getVisitOrder() < b.getVisitOrder();
-                      });
-            
-            for (size_t i = 0; i < tripCities.size(); i++) {
-                std::string cityName = "Unknown";
-                for (const auto& city : allCities) {
-                    if (city.getId() == tripCities[i].getCityId()) {
-                        cityName = city.getName();
-                        break;
+
+                crow::json::rvalue tripsJson = json;
+                if (json.t() == crow::json::type::Object && json.has("trips")) {
+                    tripsJson = json["trips"];
+                }
+                if (tripsJson.t() != crow::json::type::List) {
+                    crow::json::wvalue error;
+                    error["error"] = "Request body must be an array of trips";
+                    error["expected"] = "[{ \"start_city_id\": 1, \"city_ids\": [2, 3, 4] }, ...]";
+                    res = crow::response(400, error);
+                    res.end();
+                    return;
+                }
+                if (tripsJson.size() > TripService::MAX_TRIPS_PER_BATCH) {
+                    crow::json::wvalue error;
+                    error["error"] = "Too many trips in one batch";
+                    error["max_trips"] = (int)TripService::MAX_TRIPS_PER_BATCH;
+                    res = crow::response(413, error);
+                    res.end();
+                    return;
+                }
+
+                // Query flags apply to every trip; "closed" / "two_opt" on a trip apply to that trip only
+                RouteOptions sharedOptions = routeOptions(req);
+
+                // A missing field fails only its own trip; a malformed ID rejects the request
+                V<TripPlanRequest> requests;
+                for (const auto& tripJson : tripsJson) {
+                    TripPlanRequest request;
+                    request.options = sharedOptions;
+                    request.options.closed = request.options.closed || bodyFlag(tripJson, "closed");
+                    request.options.twoOpt = request.options.twoOpt || bodyFlag(tripJson, "two_opt");
+                    bool isObject = tripJson.t() == crow::json::type::Object;
+                    if ((isObject && tripJson.has("start_city_id") &&
+                         !readInteger(tripJson, "start_city_id", request.startCityId)) ||
+                        (isObject && tripJson.has("city_ids") &&
+                         !readIntegerList(tripJson, "city_ids", request.cityIds))) {
+                        crow::json::wvalue error;
+                        error["error"] = "start_city_id must be a city ID and city_ids an array of city IDs";
+                        error["index"] = (int)requests.size();
+                        res = crow::response(400, error);
+                        res.end();
+                        return;
+                    }
+                    requests.push_back(request);
+                }
+
+                std::cout << "🔍 API: Batch trip request with " << requests.size() << " trips" << std::endl;
+
+                V<BatchTripResult> results = tripService.planBatch(requests);
+
+                // One reference snapshot serves the whole batch
+                std::shared_ptr<const ReferenceDataSnapshot> reference = referenceData.getSnapshot();
+
+                res.code = 200;
+                res.set_header("Content-Type", "application/x-ndjson");
+
+                for (size_t i = 0; i < results.size(); i++) {
+                    crow::json::wvalue line;
+                    line["index"] = (int)i;
+                    line["success"] = results[i].success;
+
+                    if (!results[i].success) {
+                        line["error"] = results[i].error;
+                    } else {
+                        const Trip& trip = results[i].trip;
+                        const V<int>& route = results[i].route.cityIds;
+
+                        line["trip"]["id"] = trip.getId();
+                        line["trip"]["type"] = trip.getTripType();
+                        line["trip"]["start_city_id"] = trip.getStartCityId();
+                        line["trip"]["total_distance"] = trip.getTotalDistance();
+                        line["trip"]["cities"] = crow::json::wvalue::list();
+                        for (size_t j = 0; j < route.size(); j++) {
+                            line["trip"]["cities"][j]["city_id"] = route[j];
+                            line["trip"]["cities"][j]["city_name"] = reference->cityName(route[j]);
+                            line["trip"]["cities"][j]["visit_order"] = (int)(j + 1);
+                        }
+                        line["trip"]["total_cities"] = (int)route.size();
+                        line["trip"]["closed"] = results[i].route.closed;
+                        line["trip"]["return_distance"] = results[i].route.returnDistance;
                     }
+
+                    res.write(line.dump() + "\n");
                 }
+
+                res.end();
+
+            } catch (const std::exception& e) {
+                crow::json::wvalue error;
+                error["error"] = "Failed to plan batch trips";
+                error["message"] = e.what();
+                res = crow::response(500, error);
+                res.end();
+            }
+        });
+    });
+
+    // GET /api/trips/berlin - Plan and return Berlin tour
+    CROW_ROUTE(app, "/api/trips/berlin").methods("GET"_method)([&tripService, &referenceData, &tripCityService](const crow::request& req, crow::response& res) {
+        respondAsync(res, [&tripService, &referenceData, &tripCityService, &req]() -> crow::response {
+            try {
+                RouteOptions options = routeOptions(req);
+                if (isDryRun(req)) {
+                    return plannedRouteResponse(tripService.previewBerlinTour(options), TripKind::Berlin, referenceData,
+                                                "Berlin tour planned (dry run, not saved)");
+                }
+
+                Trip berlinTrip = tripService.planBerlinTour(options);
+                
+                if (berlinTrip.getId() == 0) {
+                    crow::json::wvalue error;
+                    error["error"] = "Failed to create Berlin tour";
+                    return crow::response(400, error);
+                }
+                
+                // Reference snapshot for city name lookup
+                std::shared_ptr<const ReferenceDataSnapshot> reference = referenceData.getSnapshot();
+                V<TripCity> tripCities = tripCityService.getCitiesForTrip(berlinTrip.getId());
+                
+                // Create JSON response (same structure)
+                crow::json::wvalue result;
+                result["trip"]["id"] = berlinTrip.getId();
+                result["trip"]["type"] = berlinTrip.getTripType();
+                result["trip"]["start_city_id"] = berlinTrip.getStartCityId();
+                result["trip"]["total_distance"] = berlinTrip.getTotalDistance();
+
+
+                // ✅ ADD DEBUG AND MULTIPLE FORMATS:
+                double debugDistance = berlinTrip.getTotalDistance();
+                std::cout << "🔍 API DEBUG: Berlin Trip ID = " << berlinTrip.getId() << std::endl;
+                std::cout << "🔍 API DEBUG: Berlin Trip distance = " << debugDistance << std::endl;
+                std::cout << "🔍 API DEBUG: Berlin Trip type = " << berlinTrip.getTripType() << std::endl;
+
+                result["trip"]["distance"] = debugDistance;
+                result["distance"] = debugDistance;
+                result["totalDistance"] = debugDistance;
+                result["trip"]["totalDistance"] = debugDistance;
+                result["trip"]["distance_string"] = std::to_string((int)debugDistance) + " km";
+                result["distance_string"] = std::to_string((int)debugDistance) + " km";
+
+
+                
+                // Find start city name
+                std::string startCityName = reference->cityName(berlinTrip.getStartCityId());
+                result["trip"]["start_city_name"] = startCityName;
+                
+                // Add cities in route
+                result["trip"]["cities"] = crow::json::wvalue::list();
+                std::sort(tripCities.begin(), tripCities.end(), 
+                          [](const TripCity& a, const TripCity& b) {
+                              return a.getVisitOrder() < b.getVisitOrder();
+                          });
+                
+                for (size_t i = 0; i < tripCities.size(); i++) {
+                    std::string cityName = reference->cityName(tripCities[i].getCityId());
+                    
+                    result["trip"]["cities"][i]["city_id"] = tripCities[i].getCityId();
+                    result["trip"]["cities"][i]["city_name"] = cityName;
+                    result["trip"]["cities"][i]["visit_order"] = tripCities[i].getVisitOrder();
+                }
+                
+                result["trip"]["total_cities"] = (int)tripCities.size();
+                result["trip"]["closed"] = returnsToStart(tripCities);
+                result["success"] = true;
+                result["message"] = "Berlin tour created successfully";
                 
-                result["trip"]["cities"][i]["city_id"] = tripCities[i].getCityId();
-                result["trip"]["cities"][i]["city_name"] = cityName;
-                result["trip"]["cities"][i]["visit_order"] = tripCities[i].getVisitOrder();
+                return crow::response(200, result);
+                
+            } catch (const std::exception& e) {
+                crow::json::wvalue error;
+                error["error"] = "Failed to create Berlin tour";
+                error["message"] = e.what();
+                return crow::response(500, error);
             }
-            
-            result["trip"]["total_cities"] = (int)tripCities.size();
-            result["success"] = true;
-            result["message"] = "Berlin tour created successfully";
-            
-            return crow::response(200, result);
-            
-        } catch (const std::exception& e) {
-            crow::json::wvalue error;
-            error["error"] = "Failed to create Berlin tour";
-            error["message"] = e.what();
-            return crow::response(500, error);
-        }
+        });
     });
     
-    // GET /api/trips/{id} - Get details of a specific trip
-    CROW_ROUTE(app, "/api/trips/<int>").methods("GET"_method)([&cityService, &tripCityService](int tripId) {
-        try {
-            // Get cities in the trip
-            V<TripCity> tripCities = tripCityService.getCitiesForTrip(tripId);
-            
-            if (tripCities.empty()) {
+    // GET /api/trips?type=&after=&limit= - List trips one keyset page at a time
+    // Rows are written to the response as they are read from the database;
+    // pass next_after from one page as after to get the next
+    CROW_ROUTE(app, "/api/trips").methods("GET"_method)([&tripService](const crow::request& req, crow::response& res) {
+        respondAsync(res, [&tripService, &req](crow::response& res) {
+            int afterId = queryInt(req, "after", 0);
+            int limit = queryInt(req, "limit", DEFAULT_PAGE_SIZE);
+            const char* typeParam = req.url_params.get("type");
+
+            // An absent or empty type lists every kind; anything else must be a catalog label
+            TripKind tripKind = typeParam ? tripKindFromLabel(typeParam) : TripKind::Unknown;
+            bool validType = !typeParam || *typeParam == '\0' || tripKind != TripKind::Unknown;
+            if (afterId < 0 || limit <= 0 || !validType) {
                 crow::json::wvalue error;
-                error["error"] = "Trip not found or has no cities";
-                error["trip_id"] = tripId;
-                return crow::response(404, error);
+                error["error"] = "Invalid pagination parameters";
+                error["expected"] = "?type=paris_tour&after=0&limit=" + std::to_string(DEFAULT_PAGE_SIZE);
+                res = crow::response(400, error);
+                res.end();
+                return;
             }
-            
-            // Get all cities for name lookup
-            V<City> allCities = cityService.getAllCities();
-            
-            // Create JSON response
-            crow::json::wvalue result;
-            result["trip_id"] = tripId;
-            result["cities"] = crow::json::wvalue::list();
-            
-            // Sort by visit order
-            std::sort(tripCities.begin(), tripCities.end(), 
-                      [](const TripCity& a, const TripCity& b) {
-                          return a.getVisitOrder() < b.getVisitOrder();
-                      });
-            
-            for (size_t i = 0; i < tripCities.size(); i++) {
-                std::string cityName = "Unknown";
-                for (const auto& city : allCities) {
-                    if (city.getId() == tripCities[i].getCityId()) {
-                        cityName = city.getName();
-                        break;
+            limit = std::min(limit, MAX_PAGE_SIZE);
+
+            res.code = 200;
+            res.set_header("Content-Type", "application/json");
+            res.write("{\"trips\":[");
+
+            int count = 0;
+            int lastId = 0;
+            bool ok = tripService.forEachTrip(afterId, limit, tripKind, [&](const Trip& trip) {
+                crow::json::wvalue tripJson;
+                tripJson["id"] = trip.getId();
+                tripJson["type"] = trip.getTripType();
+                tripJson["start_city_id"] = trip.getStartCityId();
+                tripJson["total_distance"] = trip.getTotalDistance();
+
+                res.write((count > 0 ? "," : "") + tripJson.dump());
+                count++;
+                lastId = trip.getId();
+                return true;
+            });
+
+            if (!ok) {
+                crow::json::wvalue error;
+                error["error"] = "Failed to list trips";
+                res = crow::response(500, error);
+                res.end();
+                return;
+            }
+
+            endPage(res, count, limit, lastId);
+        });
+    });
+
+    // GET /api/trip-cities?trip_id=&after=&limit= - List trip-city rows one keyset page at a time
+    CROW_ROUTE(app, "/api/trip-cities").methods("GET"_method)([&tripCityService](const crow::request& req, crow::response& res) {
+        respondAsync(res, [&tripCityService, &req](crow::response& res) {
+            int afterId = queryInt(req, "after", 0);
+            int limit = queryInt(req, "limit", DEFAULT_PAGE_SIZE);
+            int tripId = queryInt(req, "trip_id", 0);
+
+            if (afterId < 0 || limit <= 0 || tripId < 0) {
+                crow::json::wvalue error;
+                error["error"] = "Invalid pagination parameters";
+                error["expected"] = "?trip_id=1&after=0&limit=" + std::to_string(DEFAULT_PAGE_SIZE);
+                res = crow::response(400, error);
+                res.end();
+                return;
+            }
+            limit = std::min(limit, MAX_PAGE_SIZE);
+
+            res.code = 200;
+            res.set_header("Content-Type", "application/json");
+            res.write("{\"trip_cities\":[");
+
+            int count = 0;
+            int lastId = 0;
+            bool ok = tripCityService.forEachTripCity(afterId, limit, tripId, [&](const TripCity& tripCity) {
+                crow::json::wvalue rowJson;
+                rowJson["id"] = tripCity.getId();
+                rowJson["trip_id"] = tripCity.getTripId();
+                rowJson["city_id"] = tripCity.getCityId();
+                rowJson["visit_order"] = tripCity.getVisitOrder();
+
+                res.write((count > 0 ? "," : "") + rowJson.dump());
+                count++;
+                lastId = tripCity.getId();
+                return true;
+            });
+
+            if (!ok) {
+                crow::json::wvalue error;
+                error["error"] = "Failed to list trip cities";
+                res = crow::response(500, error);
+                res.end();
+                return;
+            }
+
+            endPage(res, count, limit, lastId);
+        });
+    });
+
+    // POST /api/trips/culinary - Route minimizing travel cost plus food spend
+    // Body: { "start_city_id": 1, "city_ids": [2, 3, 4], "rate_per_km": 0.15,
+    //         "distance_weight": 1.0, "food_weight": 1.0, "foods": { "3": 12 },
+    //         "max_stops": 2, "closed": false, "two_opt": false, "dry_run": false }
+    CROW_ROUTE(app, "/api/trips/culinary").methods("POST"_method)([&tripService, &referenceData, &tripCityService](const crow::request& req, crow::response& res) {
+        respondAsync(res, [&tripService, &referenceData, &tripCityService, &req]() -> crow::response {
+            try {
+                crow::json::rvalue json = crow::json::load(req.body);
+                if (!json || json.t() != crow::json::type::Object) {
+                    crow::json::wvalue error;
+                    error["error"] = "Invalid JSON in request body";
+                    error["expected"] = "{ \"start_city_id\": 1, \"city_ids\": [2, 3, 4], \"rate_per_km\": 0.15 }";
+                    return crow::response(400, error);
+                }
+
+                int startCityId;
+                V<int> citiesToVisit;
+                if (!readInteger(json, "start_city_id", startCityId) ||
+                    !readIntegerList(json, "city_ids", citiesToVisit)) {
+                    crow::json::wvalue error;
+                    error["error"] = "Missing or invalid fields: start_city_id (city ID) and city_ids (array of city IDs)";
+                    return crow::response(400, error);
+                }
+                if (citiesToVisit.size() == 0) {
+                    crow::json::wvalue error;
+                    error["error"] = "At least one city must be specified in city_ids";
+                    return crow::response(400, error);
+                }
+
+                TripCostOptions options;
+                bool validNumbers = true;
+                auto readNumber = [&json, &validNumbers](const char* name, double& out) {
+                    if (!json.has(name)) {
+                        return;
+                    }
+                    if (json[name].t() != crow::json::type::Number || json[name].d() < 0) {
+                        validNumbers = false;
+                        return;
                     }
+                    out = json[name].d();
+                };
+                readNumber("rate_per_km", options.ratePerKm);
+                readNumber("distance_weight", options.distanceWeight);
+                readNumber("food_weight", options.foodWeight);
+
+                // A whole number of stops, at most the cities offered (0 = no limit)
+                if (json.has("max_stops")) {
+                    double maxStops = json["max_stops"].t() == crow::json::type::Number ? json["max_stops"].d() : -1;
+                    if (maxStops < 0 || maxStops > (double)citiesToVisit.size() || maxStops != std::floor(maxStops)) {
+                        crow::json::wvalue error;
+                        error["error"] = "max_stops must be a whole number from 0 to the number of city_ids";
+                        error["max_stops_limit"] = (int)citiesToVisit.size();
+                        return crow::response(400, error);
+                    }
+                    options.maxStops = (int)maxStops;
                 }
+
+                if (!validNumbers || (json.has("foods") && !readIdMap(json["foods"], options.chosenFoods))) {
+                    crow::json::wvalue error;
+                    error["error"] = "rate_per_km, distance_weight and food_weight must be non-negative "
+                                     "numbers; foods must map city IDs to food IDs";
+                    return crow::response(400, error);
+                }
+
+                options.route = routeOptions(req, json);
+                bool dryRun = isDryRun(req) || bodyFlag(json, "dry_run");
+
+                CostedRoute planned;
+                Trip culinaryTrip;
+                try {
+                    if (dryRun) {
+                        planned = tripService.previewCulinaryTour(startCityId, citiesToVisit, options);
+                    } else {
+                        culinaryTrip = tripService.planCulinaryTour(startCityId, citiesToVisit, options, planned);
+                    }
+                } catch (const std::invalid_argument& e) {
+                    crow::json::wvalue error;
+                    error["error"] = e.what();
+                    return crow::response(400, error);
+                }
+
+                if (!dryRun && culinaryTrip.getId() == 0) {
+                    crow::json::wvalue error;
+                    error["error"] = "Failed to create culinary tour";
+                    return crow::response(500, error);
+                }
+
+                std::shared_ptr<const ReferenceDataSnapshot> reference = referenceData.getSnapshot();
+                crow::json::wvalue result;
+                if (dryRun) {
+                    V<TripCity> routeCities;
+                    for (size_t i = 0; i < planned.route.cityIds.size(); i++) {
+                        routeCities.push_back(TripCity(0, planned.route.cityIds[i], i + 1));
+                    }
+                    writeTripCities(result["trip"], *reference, routeCities);
+                } else {
+                    result["trip"]["id"] = culinaryTrip.getId();
+                    writeTripCities(result["trip"], *reference, tripCityService.getCitiesForTrip(culinaryTrip.getId()));
+                }
+                result["trip"]["type"] = tripKindLabel(TripKind::Culinary);
+                result["trip"]["start_city_id"] = planned.route.startCityId;
+                result["trip"]["total_distance"] = planned.route.totalDistance;
+                result["distance"] = planned.route.totalDistance;
+                writeCostBreakdown(result["costs"], planned, *reference);
+
+                result["rate_per_km"] = options.ratePerKm;
+                result["distance_weight"] = options.distanceWeight;
+                result["food_weight"] = options.foodWeight;
+                result["dry_run"] = dryRun;
+                result["success"] = true;
+                result["message"] = dryRun ? "Culinary tour planned (dry run, not saved)" : "Culinary tour created successfully";
+
+                return crow::response(200, result);
+
+            } catch (const std::exception& e) {
+                crow::json::wvalue error;
+                error["error"] = "Failed to create culinary tour";
+                error["message"] = e.what();
+                return crow::response(500, error);
+            }
+        });
+    });
+
+    // POST /api/trips/{id}/food-plan - Best scoring foods along a trip within a budget
+    // Body: { "budget": 40.0, "city_minimums": { "3": 1 }, "scores": { "12": 4.5 },
+    //         "max_quantity": 2, "max_quantities": { "12": 3 } }
+    CROW_ROUTE(app, "/api/trips/<int>/food-plan").methods("POST"_method)([&referenceData, &tripCityService, &foodService](const crow::request& req, crow::response& res, int tripId) {
+        respondAsync(res, [&referenceData, &tripCityService, &foodService, &req, tripId]() -> crow::response {
+            try {
+                crow::json::rvalue json = crow::json::load(req.body);
+                if (!json || json.t() != crow::json::type::Object) {
+                    crow::json::wvalue error;
+                    error["error"] = "Invalid JSON in request body";
+                    error["expected"] = "{ \"budget\": 40.0, \"city_minimums\": { \"3\": 1 }, \"scores\": { \"12\": 4.5 } }";
+                    return crow::response(400, error);
+                }
+
+                if (!json.has("budget") || json["budget"].t() != crow::json::type::Number || json["budget"].d() < 0 ||
+                    json["budget"].d() > MAX_FOOD_BUDGET) {
+                    crow::json::wvalue error;
+                    error["error"] = "Missing or invalid field: budget (euros, from 0 to max_budget)";
+                    error["max_budget"] = MAX_FOOD_BUDGET;
+                    return crow::response(400, error);
+                }
+
+                FoodPlanRequest request;
+                request.budgetCents = std::llround(json["budget"].d() * 100);
+
+                if (json.has("max_quantity") && !readInteger(json, "max_quantity", request.defaultMaxQuantity)) {
+                    crow::json::wvalue error;
+                    error["error"] = "Invalid field: max_quantity (must be a whole number)";
+                    return crow::response(400, error);
+                }
+
+                bool validMaps = (!json.has("city_minimums") || readIdMap(json["city_minimums"], request.cityMinimums)) &&
+                                 (!json.has("scores") || readIdMap(json["scores"], request.scores)) &&
+                                 (!json.has("max_quantities") || readIdMap(json["max_quantities"], request.maxQuantities));
+
+                bool validQuantities = request.defaultMaxQuantity >= 0 && request.defaultMaxQuantity <= MAX_FOOD_QUANTITY;
+                for (const auto& entry : request.maxQuantities) {
+                    validQuantities = validQuantities && entry.second >= 0 && entry.second <= MAX_FOOD_QUANTITY;
+                }
+                for (const auto& entry : request.scores) {
+                    validQuantities = validQuantities && entry.second >= 0;
+                }
+
+                if (!validMaps || !validQuantities) {
+                    crow::json::wvalue error;
+                    error["error"] = "city_minimums, scores and max_quantities must map IDs to non-negative numbers";
+                    error["max_quantity_limit"] = MAX_FOOD_QUANTITY;
+                    return crow::response(400, error);
+                }
+
+                V<TripCity> tripCities = tripCityService.getCitiesForTrip(tripId);
+                if (tripCities.empty()) {
+                    crow::json::wvalue error;
+                    error["error"] = "Trip not found or has no cities";
+                    error["trip_id"] = tripId;
+                    return crow::response(404, error);
+                }
+
+                V<int> cityIds;
+                for (const auto& tripCity : tripCities) {
+                    cityIds.push_back(tripCity.getCityId());
+                }
+
+                FoodPlan plan = foodService.planFoodsForCities(cityIds, request);
+
+                crow::json::wvalue result;
+                result["trip_id"] = tripId;
+                result["budget"] = plan.budgetCents / 100.0;
+                result["budget_cents"] = plan.budgetCents;
+
+                if (!plan.feasible) {
+                    result["success"] = false;
+                    result["error"] = plan.error;
+                    return crow::response(422, result);
+                }
+
+                std::shared_ptr<const ReferenceDataSnapshot> reference = referenceData.getSnapshot();
+
+                result["foods"] = crow::json::wvalue::list();
+                for (size_t i = 0; i < plan.choices.size(); i++) {
+                    const FoodPlanChoice& choice = plan.choices[i];
+
+                    result["foods"][i]["food_id"] = choice.foodId;
+                    result["foods"][i]["name"] = choice.name;
+                    result["foods"][i]["city_id"] = choice.cityId;
+                    result["foods"][i]["city_name"] = reference->cityName(choice.cityId);
+                    result["foods"][i]["quantity"] = choice.quantity;
+                    result["foods"][i]["unit_price"] = choice.priceCents / 100.0;
+                    result["foods"][i]["score"] = choice.score;
+                    result["foods"][i]["subtotal"] = choice.quantity * choice.priceCents / 100.0;
+                }
+
+                result["spent"] = plan.spentCents / 100.0;
+                result["spent_cents"] = plan.spentCents;
+                result["remaining"] = (plan.budgetCents - plan.spentCents) / 100.0;
+                result["total_score"] = plan.totalScore;
+                result["total_items"] = (int)plan.choices.size();
+                result["success"] = true;
+
+                return crow::response(200, result);
+
+            } catch (const std::exception& e) {
+                crow::json::wvalue error;
+                error["error"] = "Failed to plan foods for trip";
+                error["message"] = e.what();
+                return crow::response(500, error);
+            }
+        });
+    });
+
+    // POST /api/trips/{id}/cities - Insert a city where it adds the least distance
+    // Body: { "city_id": 12 }
+    CROW_ROUTE(app, "/api/trips/<int>/cities").methods("POST"_method)([&tripService, &referenceData, &tripCityService](const crow::request& req, crow::response& res, int tripId) {
+        respondAsync(res, [&tripService, &referenceData, &tripCityService, &req, tripId]() -> crow::response {
+            try {
+                crow::json::rvalue json = crow::json::load(req.body);
+                int cityId;
+                if (!json || !readInteger(json, "city_id", cityId)) {
+                    crow::json::wvalue error;
+                    error["error"] = "Missing or invalid field: city_id";
+                    error["expected"] = "{ \"city_id\": 12 }";
+                    return crow::response(400, error);
+                }
+
+                RouteEdit edit = tripService.insertCityIntoTrip(tripId, cityId);
+                return routeEditResponse(edit, tripId, referenceData, tripCityService);
+
+            } catch (const std::exception& e) {
+                crow::json::wvalue error;
+                error["error"] = "Failed to add city to trip";
+                error["message"] = e.what();
+                return crow::response(500, error);
+            }
+        });
+    });
+
+    // PUT /api/trips/{id}/cities - Visit the trip's cities in a new order
+    // Body: { "city_ids": [7, 3, 12, 5] } (every stop, starting with the start city)
+    CROW_ROUTE(app, "/api/trips/<int>/cities").methods("PUT"_method)([&tripService, &referenceData, &tripCityService](const crow::request& req, crow::response& res, int tripId) {
+        respondAsync(res, [&tripService, &referenceData, &tripCityService, &req, tripId]() -> crow::response {
+            try {
+                crow::json::rvalue json = crow::json::load(req.body);
+                V<int> cityIds;
+                if (!json || !readIntegerList(json, "city_ids", cityIds)) {
+                    crow::json::wvalue error;
+                    error["error"] = "Missing or invalid field: city_ids";
+                    error["expected"] = "{ \"city_ids\": [7, 3, 12, 5] }";
+                    return crow::response(400, error);
+                }
+
+                RouteEdit edit = tripService.reorderTrip(tripId, cityIds);
+                return routeEditResponse(edit, tripId, referenceData, tripCityService);
+
+            } catch (const std::exception& e) {
+                crow::json::wvalue error;
+                error["error"] = "Failed to reorder trip";
+                error["message"] = e.what();
+                return crow::response(500, error);
+            }
+        });
+    });
+
+    // DELETE /api/trips/{id}/cities/{cityId} - Remove a city and close the gap
+    CROW_ROUTE(app, "/api/trips/<int>/cities/<int>").methods("DELETE"_method)([&tripService, &referenceData, &tripCityService](const crow::request&, crow::response& res, int tripId, int cityId) {
+        respondAsync(res, [&tripService, &referenceData, &tripCityService, tripId, cityId]() -> crow::response {
+            try {
+                RouteEdit edit = tripService.removeCityFromTrip(tripId, cityId);
+                return routeEditResponse(edit, tripId, referenceData, tripCityService);
+
+            } catch (const std::exception& e) {
+                crow::json::wvalue error;
+                error["error"] = "Failed to remove city from trip";
+                error["message"] = e.what();
+                return crow::response(500, error);
+            }
+        });
+    });
+
+    // GET /api/trips/{id} - Get details of a specific trip
+    CROW_ROUTE(app, "/api/trips/<int>").methods("GET"_method)([&referenceData, &tripCityService](const crow::request&, crow::response& res, int tripId) {
+        respondAsync(res, [&referenceData, &tripCityService, tripId]() -> crow::response {
+            try {
+                // Get cities in the trip
+                V<TripCity> tripCities = tripCityService.getCitiesForTrip(tripId);
                 
-                result["cities"][i]["city_id"] = tripCities[i].getCityId();
-                result["cities"][i]["city_name"] = cityName;
-                result["cities"][i]["visit_order"] = tripCities[i].getVisitOrder();
+                if (tripCities.empty()) {
+                    crow::json::wvalue error;
+                    error["error"] = "Trip not found or has no cities";
+                    error["trip_id"] = tripId;
+                    return crow::response(404, error);
+                }
+                
+                // Reference snapshot for city name lookup
+                std::shared_ptr<const ReferenceDataSnapshot> reference = referenceData.getSnapshot();
+                
+                // Create JSON response
+                crow::json::wvalue result;
+                result["trip_id"] = tripId;
+                result["cities"] = crow::json::wvalue::list();
+                
+                // Sort by visit order
+                std::sort(tripCities.begin(), tripCities.end(), 
+                          [](const TripCity& a, const TripCity& b) {
+                              return a.getVisitOrder() < b.getVisitOrder();
+                          });
+                
+                for (size_t i = 0; i < tripCities.size(); i++) {
+                    std::string cityName = reference->cityName(tripCities[i].getCityId());
+                    
+                    result["cities"][i]["city_id"] = tripCities[i].getCityId();
+                    result["cities"][i]["city_name"] = cityName;
+                    result["cities"][i]["visit_order"] = tripCities[i].getVisitOrder();
+                }
+                
+                result["total_cities"] = (int)tripCities.size();
+                result["success"] = true;
+                
+                return crow::response(200, result);
+                
+            } catch (const std::exception& e) {
+                crow::json::wvalue error;
+                error["error"] = "Failed to fetch trip details";
+                error["message"] = e.what();
+                return crow::response(500, error);
             }
-            
-            result["total_cities"] = (int)tripCities.size();
-            result["success"] = true;
-            
-            return crow::response(200, result);
-            
-        } catch (const std::exception& e) {
-            crow::json::wvalue error;
-            error["error"] = "Failed to fetch trip details";
-            error["message"] = e.what();
-            return crow::response(500, error);
-        }
+        });
     });
 }
\ No newline at end of file
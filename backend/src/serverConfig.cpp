@@ -0,0 +1,109 @@
+/**
+ * Server Configuration Implementation
+ */
+
+#include "../include/serverConfig.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+    // One setting: where it comes from and the values it accepts
+    struct Setting {
+        const char* flag;
+        const char* environment;
+        unsigned long long minimum;
+        unsigned long long maximum;
+    };
+
+    const Setting PORT = {"--port", "API_PORT", 1, 65535};
+    const Setting THREADS = {"--threads", "API_THREADS", 1, 256};
+    const Setting TIMEOUT = {"--timeout", "API_KEEPALIVE_TIMEOUT", 1, 255};
+    const Setting MAX_BODY_PARSE = {"--max-body-parse", "API_MAX_BODY_PARSE", 1, 1024ULL * 1024 * 1024};
+    const Setting DB_THREADS = {"--db-threads", "API_DB_THREADS", 1, 64};
+
+    const Setting* const SETTINGS[] = {&PORT, &THREADS, &TIMEOUT, &MAX_BODY_PARSE, &DB_THREADS};
+
+    // Parses a whole decimal string within the setting's range
+    bool parseValue(const Setting& setting, const std::string& text, unsigned long long& value, std::string& error) {
+        bool digits = !text.empty() && std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; });
+        if (digits && text.size() <= 19) {
+            value = std::strtoull(text.c_str(), nullptr, 10);
+            if (value >= setting.minimum && value <= setting.maximum) {
+                return true;
+            }
+        }
+
+        error = std::string(setting.flag) + " must be a number from " + std::to_string(setting.minimum) + " to " +
+                std::to_string(setting.maximum) + " (got \"" + text + "\")";
+        return false;
+    }
+
+    void store(const Setting& setting, unsigned long long value, ServerConfig& config) {
+        if (&setting == &PORT) {
+            config.port = (uint16_t)value;
+        } else if (&setting == &THREADS) {
+            config.workerThreads = (unsigned)value;
+        } else if (&setting == &TIMEOUT) {
+            config.keepAliveTimeoutSeconds = (uint8_t)value;
+        } else if (&setting == &MAX_BODY_PARSE) {
+            config.maxBodyParseBytes = (size_t)value;
+        } else {
+            config.databaseThreads = (unsigned)value;
+        }
+    }
+}
+
+bool ServerConfig::load(int argc, char* argv[], ServerConfig& config, std::string& error) {
+    config = ServerConfig();
+    config.workerThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    unsigned long long value;
+    for (const Setting* setting : SETTINGS) {
+        const char* text = std::getenv(setting->environment);
+        if (text == nullptr || *text == '\0') {
+            continue;
+        }
+        if (!parseValue(*setting, text, value, error)) {
+            error = std::string(setting->environment) + ": " + error;
+            return false;
+        }
+        store(*setting, value, config);
+    }
+
+    // Flags win over the environment; both "--port 8080" and "--port=8080" work
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        std::string name = argument.substr(0, argument.find('='));
+
+        const Setting* match = nullptr;
+        for (const Setting* setting : SETTINGS) {
+            if (name == setting->flag) {
+                match = setting;
+            }
+        }
+        if (match == nullptr) {
+            error = "unknown option \"" + argument + "\"";
+            return false;
+        }
+
+        std::string text;
+        if (name.size() < argument.size()) {
+            text = argument.substr(name.size() + 1);
+        } else if (i + 1 < argc) {
+            text = argv[++i];
+        }
+        if (!parseValue(*match, text, value, error)) {
+            return false;
+        }
+        store(*match, value, config);
+    }
+
+    return true;
+}
+
+std::string ServerConfig::describe() const {
+    return "port " + std::to_string(port) + ", " + std::to_string(workerThreads) + " worker threads, " +
+           std::to_string(keepAliveTimeoutSeconds) + "s keep-alive timeout, " + std::to_string(maxBodyParseBytes) +
+           " byte body parse limit, " + std::to_string(databaseThreads) + " database threads";
+}
@@ -0,0 +1,162 @@
+#include "../../include/services/DistanceMatrix.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+DistanceMatrix::DistanceMatrix() : maxCityId(0), indexOf(1, -1), edgeCount(0), neighbourCount(0) {}
+
+void DistanceMatrix::indexCities(std::vector<int> ids) {
+    cityIds = std::move(ids);
+    maxCityId = cityIds.empty() ? 0 : cityIds.back();
+    indexOf.assign((size_t)maxCityId + 1, -1);
+    for (size_t i = 0; i < cityIds.size(); i++) {
+        indexOf[cityIds[i]] = (int)i;
+    }
+    distances.assign(cityIds.size() * cityIds.size(), NO_EDGE);
+}
+
+DistanceMatrix::DistanceMatrix(const V<CityDistance>& rows) : maxCityId(0), edgeCount(0), neighbourCount(0) {
+    // First pass collects the cities, second pass fills the matrix
+    std::vector<int> ids;
+    for (const auto& row : rows) {
+        if (row.getFromCityId() > 0 && row.getToCityId() > 0) {
+            ids.push_back(row.getFromCityId());
+            ids.push_back(row.getToCityId());
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    indexCities(std::move(ids));
+
+    size_t width = cityIds.size();
+    for (const auto& row : rows) {
+        if (row.getFromCityId() <= 0 || row.getToCityId() <= 0) {
+            continue;
+        }
+        distances[(size_t)indexOf[row.getFromCityId()] * width + indexOf[row.getToCityId()]] = row.getDistance();
+        edgeCount++;
+    }
+}
+
+DistanceMatrix::DistanceMatrix(const CityDistanceTable& table)
+    : maxCityId(0), edgeCount(table.size()), neighbourCount(0) {
+    // Mark every ID on either end of a leg, then number them in ID order
+    std::vector<char> present((size_t)table.getMaxCityId() + 1, 0);
+    for (int from = 1; from <= table.getMaxCityId(); from++) {
+        CityDistanceTable::Row row = table.getRow(from);
+        if (row.size > 0) {
+            present[from] = 1;
+        }
+        for (size_t i = 0; i < row.size; i++) {
+            present[row.toCityIds[i]] = 1;
+        }
+    }
+    std::vector<int> ids;
+    for (int cityId = 1; cityId <= table.getMaxCityId(); cityId++) {
+        if (present[cityId]) {
+            ids.push_back(cityId);
+        }
+    }
+    indexCities(std::move(ids));
+
+    size_t width = cityIds.size();
+    for (size_t from = 0; from < width; from++) {
+        CityDistanceTable::Row row = table.getRow(cityIds[from]);
+        int* target = &distances[from * width];
+        for (size_t i = 0; i < row.size; i++) {
+            target[indexOf[row.toCityIds[i]]] = row.distances[i];
+        }
+    }
+}
+
+DistanceMatrix::DistanceMatrix(std::vector<int> cityIds, std::vector<int> distances)
+    : maxCityId(0), edgeCount(0), neighbourCount(0) {
+    indexCities(std::move(cityIds));
+    this->distances = std::move(distances);
+    for (int value : this->distances) {
+        if (value != NO_EDGE) {
+            edgeCount++;
+        }
+    }
+}
+
+void DistanceMatrix::buildNeighbourLists(int k) {
+    int count = getCityCount();
+    neighbourCount = std::max(0, std::min(k, count));
+    neighbours.assign((size_t)count * neighbourCount, -1);
+    if (neighbourCount == 0) {
+        return;
+    }
+
+    std::vector<std::pair<int, int>> row; // (distance, city)
+    for (int from = 0; from < count; from++) {
+        row.clear();
+        const int* distancesFrom = &distances[(size_t)from * count];
+        for (int to = 0; to < count; to++) {
+            if (to != from && distancesFrom[to] != NO_EDGE) {
+                row.push_back(std::make_pair(distancesFrom[to], cityIds[to]));
+            }
+        }
+
+        size_t kept = std::min(row.size(), (size_t)neighbourCount);
+        std::partial_sort(row.begin(), row.begin() + kept, row.end());
+        for (size_t i = 0; i < kept; i++) {
+            neighbours[(size_t)from * neighbourCount + i] = row[i].second;
+        }
+    }
+}
+
+namespace {
+    void appendLittleEndian(std::string& out, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            out.push_back((char)((value >> (8 * i)) & 0xFF));
+        }
+    }
+}
+
+void DistanceMatrix::appendBinary(std::string& out, uint64_t dataVersion) const {
+    uint32_t count = (uint32_t)cityIds.size();
+    out.reserve(out.size() + 16 + (cityIds.size() + distances.size()) * sizeof(int32_t));
+
+    out.append("CDM2", 4);
+    appendLittleEndian(out, count, 4);
+    appendLittleEndian(out, dataVersion, 8);
+
+    const uint16_t probe = 1;
+    bool littleEndianHost = *(const unsigned char*)&probe == 1;
+    if (littleEndianHost && sizeof(int) == sizeof(int32_t)) {
+        // Both arrays are already the wire layout: one copy of each buffer
+        out.append((const char*)cityIds.data(), cityIds.size() * sizeof(int32_t));
+        out.append((const char*)distances.data(), distances.size() * sizeof(int32_t));
+        return;
+    }
+    for (int cityId : cityIds) {
+        appendLittleEndian(out, (uint32_t)(int32_t)cityId, 4);
+    }
+    for (int value : distances) {
+        appendLittleEndian(out, (uint32_t)(int32_t)value, 4);
+    }
+}
+
+bool DistanceMatrix::hasCity(int cityId) const {
+    const int* row = getRow(cityId);
+    if (!row) {
+        return false;
+    }
+
+    // A city is known if it has at least one outgoing distance
+    for (int to = 0; to < getCityCount(); to++) {
+        if (row[to] != NO_EDGE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int DistanceMatrix::getMaxCityId() const {
+    return maxCityId;
+}
+
+size_t DistanceMatrix::getEdgeCount() const {
+    return edgeCount;
+}
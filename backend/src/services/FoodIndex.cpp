@@ -0,0 +1,146 @@
+#include "../../include/services/FoodIndex.hpp"
+#include <algorithm>
+#include <cctype>
+
+FoodIndex::FoodIndex() {}
+
+FoodIndex::FoodIndex(const V<Food>& rows) {
+    for (const auto& food : rows) {
+        foods.push_back(food);
+    }
+    std::sort(foods.begin(), foods.end(), [](const Food& a, const Food& b) {
+        return a.getId() < b.getId();
+    });
+
+    for (uint32_t i = 0; i < foods.size(); i++) {
+        byPrice.push_back(i);
+        byCityPrice.push_back(i);
+        byName.push_back(std::make_pair(toLower(foods[i].getName()), i));
+    }
+
+    // Ties are broken by ID so every ordering is deterministic
+    std::sort(byPrice.begin(), byPrice.end(), [this](uint32_t a, uint32_t b) {
+        if (foods[a].getPrice() != foods[b].getPrice()) {
+            return foods[a].getPrice() < foods[b].getPrice();
+        }
+        return a < b;
+    });
+    std::sort(byCityPrice.begin(), byCityPrice.end(), [this](uint32_t a, uint32_t b) {
+        if (foods[a].getCityId() != foods[b].getCityId()) {
+            return foods[a].getCityId() < foods[b].getCityId();
+        }
+        if (foods[a].getPrice() != foods[b].getPrice()) {
+            return foods[a].getPrice() < foods[b].getPrice();
+        }
+        return a < b;
+    });
+    std::sort(byName.begin(), byName.end());
+}
+
+std::string FoodIndex::toLower(const std::string& text) {
+    std::string lower = text;
+    for (char& c : lower) {
+        c = (char)std::tolower((unsigned char)c);
+    }
+    return lower;
+}
+
+const Food* FoodIndex::findById(int foodId) const {
+    auto found = std::lower_bound(foods.begin(), foods.end(), foodId, [](const Food& food, int id) {
+        return food.getId() < id;
+    });
+    if (found == foods.end() || found->getId() != foodId) {
+        return nullptr;
+    }
+    return &*found;
+}
+
+V<Food> FoodIndex::search(const FoodQuery& query) const {
+    V<Food> result;
+    if (query.limit == 0 || query.minPrice > query.maxPrice) {
+        return result;
+    }
+
+    if (!query.namePrefix.empty()) {
+        // Names sharing the prefix are contiguous in byName
+        std::string prefix = toLower(query.namePrefix);
+        auto entry = std::lower_bound(byName.begin(), byName.end(), std::make_pair(prefix, (uint32_t)0));
+
+        for (; entry != byName.end() && entry->first.compare(0, prefix.size(), prefix) == 0; ++entry) {
+            const Food& food = foods[entry->second];
+            if ((query.cityId == 0 || food.getCityId() == query.cityId) &&
+                food.getPrice() >= query.minPrice && food.getPrice() <= query.maxPrice) {
+                result.push_back(food);
+                if (result.size() >= query.limit) {
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+
+    if (query.cityId != 0) {
+        auto position = std::lower_bound(byCityPrice.begin(), byCityPrice.end(), query.cityId,
+                                         [this, &query](uint32_t index, int cityId) {
+            const Food& food = foods[index];
+            return food.getCityId() < cityId || (food.getCityId() == cityId && food.getPrice() < query.minPrice);
+        });
+
+        for (; position != byCityPrice.end() && result.size() < query.limit; ++position) {
+            const Food& food = foods[*position];
+            if (food.getCityId() != query.cityId || food.getPrice() > query.maxPrice) {
+                break;
+            }
+            result.push_back(food);
+        }
+        return result;
+    }
+
+    auto position = std::lower_bound(byPrice.begin(), byPrice.end(), query.minPrice,
+                                     [this](uint32_t index, double price) {
+        return foods[index].getPrice() < price;
+    });
+
+    for (; position != byPrice.end() && result.size() < query.limit; ++position) {
+        const Food& food = foods[*position];
+        if (food.getPrice() > query.maxPrice) {
+            break;
+        }
+        result.push_back(food);
+    }
+    return result;
+}
+
+size_t FoodIndex::countInPriceRange(double minPrice, double maxPrice, int cityId) const {
+    if (minPrice > maxPrice) {
+        return 0;
+    }
+
+    if (cityId != 0) {
+        auto low = std::lower_bound(byCityPrice.begin(), byCityPrice.end(), 0, [&](uint32_t index, int) {
+            const Food& food = foods[index];
+            return food.getCityId() < cityId || (food.getCityId() == cityId && food.getPrice() < minPrice);
+        });
+        auto high = std::upper_bound(byCityPrice.begin(), byCityPrice.end(), 0, [&](int, uint32_t index) {
+            const Food& food = foods[index];
+            return cityId < food.getCityId() || (food.getCityId() == cityId && maxPrice < food.getPrice());
+        });
+        return high > low ? high - low : 0;
+    }
+
+    auto low = std::lower_bound(byPrice.begin(), byPrice.end(), minPrice, [this](uint32_t index, double price) {
+        return foods[index].getPrice() < price;
+    });
+    auto high = std::upper_bound(byPrice.begin(), byPrice.end(), maxPrice, [this](double price, uint32_t index) {
+        return price < foods[index].getPrice();
+    });
+    return high > low ? high - low : 0;
+}
+
+const std::vector<Food>& FoodIndex::getAll() const {
+    return foods;
+}
+
+size_t FoodIndex::size() const {
+    return foods.size();
+}
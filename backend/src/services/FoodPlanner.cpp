@@ -0,0 +1,205 @@
+#include "../../include/services/FoodPlanner.hpp"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+// A 0/1 item produced by binary splitting a food's quantity
+struct FoodPiece {
+    size_t itemIndex;
+    int units;
+    long long weight;   // units * price, in budget steps
+    double value;       // units * score
+};
+
+// A city's foods processed together; minimum is 0 for cities without one
+struct FoodGroup {
+    int minimum = 0;
+    V<FoodPiece> pieces;
+    size_t firstDecision = 0;  // offset of this group's first piece in the decision table
+};
+
+}
+
+FoodPlan FoodPlanner::solve(const V<FoodPlanItem>& items, long long budgetCents,
+                            const std::map<int, int>& cityMinimums) {
+    FoodPlan plan;
+    plan.budgetCents = budgetCents;
+
+    if (budgetCents < 0) {
+        plan.error = "Budget must not be negative";
+        return plan;
+    }
+
+    // Work in steps of the largest amount that divides every price
+    long long step = 0;
+    for (const auto& item : items) {
+        if (item.priceCents < 0) {
+            plan.error = "Food " + std::to_string(item.foodId) + " has a negative price";
+            return plan;
+        }
+        if (item.maxQuantity > 0 && item.priceCents > 0) {
+            step = std::gcd(step, item.priceCents);
+        }
+    }
+    if (step == 0) {
+        step = 1;
+    }
+
+    // One group per city with a minimum, plus one shared group for the rest
+    std::map<int, size_t> groupByCity;
+    V<FoodGroup> groups;
+    groups.push_back(FoodGroup());
+
+    for (const auto& entry : cityMinimums) {
+        if (entry.second < 0 || entry.second > MAX_CITY_MINIMUM) {
+            plan.error = "Minimum for city " + std::to_string(entry.first) + " must be between 0 and " +
+                         std::to_string(MAX_CITY_MINIMUM);
+            return plan;
+        }
+        if (entry.second > 0) {
+            groupByCity[entry.first] = groups.size();
+            FoodGroup group;
+            group.minimum = entry.second;
+            groups.push_back(group);
+        }
+    }
+
+    // A minimum above what the city sells can never be met; say so before the DP runs
+    std::map<int, long long> availableByCity;
+    for (const auto& item : items) {
+        availableByCity[item.cityId] += std::max(item.maxQuantity, 0);
+    }
+    for (const auto& entry : groupByCity) {
+        long long available = availableByCity[entry.first];
+        if (groups[entry.second].minimum > available) {
+            plan.error = "City " + std::to_string(entry.first) + " sells only " + std::to_string(available) +
+                         " items, fewer than its minimum of " + std::to_string(groups[entry.second].minimum);
+            return plan;
+        }
+    }
+
+    for (size_t i = 0; i < items.size(); i++) {
+        const FoodPlanItem& item = items[i];
+        auto group = groupByCity.find(item.cityId);
+        FoodGroup& target = groups[group != groupByCity.end() ? group->second : 0];
+
+        int remaining = item.maxQuantity;
+        for (int units = 1; remaining > 0; units *= 2) {
+            int take = std::min(units, remaining);
+            target.pieces.push_back(FoodPiece{i, take, take * (item.priceCents / step), take * item.score});
+            remaining -= take;
+        }
+    }
+
+    // Budget beyond the cost of the whole menu buys nothing more, so the DP is
+    // never wider than the menu, however generous the budget
+    long long menuSteps = 0;
+    for (const auto& group : groups) {
+        for (const auto& piece : group.pieces) {
+            menuSteps += piece.weight;
+        }
+    }
+    size_t capacity = (size_t)std::min(budgetCents / step, menuSteps);
+
+    // Decision table: per piece, per (items bought in the group, budget)
+    // 0 = piece not taken, otherwise 1 + the item count before taking it.
+    // Alongside it live best[] and the largest group's dp rows, all doubles.
+    size_t width = capacity + 1;
+    size_t tableSize = 0;
+    size_t maxRows = 1;
+    for (auto& group : groups) {
+        group.firstDecision = tableSize;
+        tableSize += group.pieces.size() * (size_t)(group.minimum + 1) * width;
+        maxRows = std::max(maxRows, (size_t)(group.minimum + 1));
+    }
+    size_t workingBytes = tableSize + (1 + maxRows) * width * sizeof(double);
+    if (width > MAX_TABLE_BYTES / sizeof(double) || workingBytes > MAX_TABLE_BYTES) {
+        plan.error = "Budget and menu are too large to plan exactly; lower the budget or the quantities";
+        return plan;
+    }
+    std::vector<unsigned char> decisions(tableSize, 0);
+
+    const double UNREACHABLE = -std::numeric_limits<double>::infinity();
+
+    // best[b] = highest score spending at most b steps, with every finished group's minimum met
+    std::vector<double> best(width, 0.0);
+
+    for (auto& group : groups) {
+        int rows = group.minimum + 1;
+        std::vector<double> dp((size_t)rows * width, UNREACHABLE);
+        std::copy(best.begin(), best.end(), dp.begin());
+
+        for (size_t p = 0; p < group.pieces.size(); p++) {
+            const FoodPiece& piece = group.pieces[p];
+            unsigned char* decision = &decisions[group.firstDecision + p * rows * width];
+            if (piece.weight > (long long)capacity) {
+                continue;
+            }
+
+            // Descending budget keeps each piece 0/1; descending count handles free foods
+            for (size_t b = capacity + 1; b-- > (size_t)piece.weight;) {
+                for (int k = rows - 1; k >= 0; k--) {
+                    double source = dp[(size_t)k * width + (b - piece.weight)];
+                    if (source == UNREACHABLE) {
+                        continue;
+                    }
+                    int target = std::min(k + piece.units, group.minimum);
+                    double candidate = source + piece.value;
+                    double& current = dp[(size_t)target * width + b];
+                    if (candidate > current) {
+                        current = candidate;
+                        decision[(size_t)target * width + b] = (unsigned char)(k + 1);
+                    }
+                }
+            }
+        }
+
+        std::copy(dp.begin() + (size_t)group.minimum * width, dp.begin() + (size_t)rows * width, best.begin());
+    }
+
+    if (best[capacity] == UNREACHABLE) {
+        plan.error = "No selection meets the city minimums within the budget";
+        return plan;
+    }
+
+    // Walk the decisions back from the full budget to recover quantities
+    std::vector<int> quantities(items.size(), 0);
+    size_t b = capacity;
+    for (size_t g = groups.size(); g-- > 0;) {
+        const FoodGroup& group = groups[g];
+        int rows = group.minimum + 1;
+        int k = group.minimum;
+
+        for (size_t p = group.pieces.size(); p-- > 0;) {
+            const FoodPiece& piece = group.pieces[p];
+            unsigned char taken = decisions[group.firstDecision + (p * rows + k) * width + b];
+            if (taken) {
+                quantities[piece.itemIndex] += piece.units;
+                b -= piece.weight;
+                k = taken - 1;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < items.size(); i++) {
+        if (quantities[i] == 0) {
+            continue;
+        }
+        FoodPlanChoice choice;
+        choice.foodId = items[i].foodId;
+        choice.cityId = items[i].cityId;
+        choice.name = items[i].name;
+        choice.quantity = quantities[i];
+        choice.priceCents = items[i].priceCents;
+        choice.score = items[i].score;
+        plan.choices.push_back(choice);
+
+        plan.spentCents += quantities[i] * items[i].priceCents;
+        plan.totalScore += quantities[i] * items[i].score;
+    }
+
+    plan.feasible = true;
+    return plan;
+}
@@ -1,5 +1,6 @@
 #include "../../include/services/FoodService.hpp"
 #include "../../include/repositories/FoodRepository.hpp"
+#include <cmath>
 #include <iostream>
 
 FoodService::FoodService(FoodRepository& foodRepo) : foodRepo(foodRepo) {
@@ -19,6 +20,50 @@ V<Food> FoodService::getFoodsByCityId(int cityId) {
     return foods;  // Return all the Food objects we found for this city
 }
 
+// Method to choose foods for a trip's cities within a budget
+FoodPlan FoodService::planFoodsForCities(const V<int>& cityIds, const FoodPlanRequest& request) {
+    FoodPlan plan;
+    plan.budgetCents = request.budgetCents;
+
+    std::map<int, bool> onTrip;
+    for (int cityId : cityIds) {
+        onTrip[cityId] = true;
+    }
+
+    // Minimums only make sense for cities the trip actually visits
+    for (const auto& minimum : request.cityMinimums) {
+        if (!onTrip.count(minimum.first)) {
+            plan.error = "City " + std::to_string(minimum.first) + " is not part of this trip";
+            return plan;
+        }
+    }
+
+    // One query for the whole menu, then keep the trip's cities
+    V<FoodPlanItem> items;
+    V<Food> foods = foodRepo.findAll();
+    for (const auto& food : foods) {
+        if (!onTrip.count(food.getCityId())) {
+            continue;
+        }
+
+        FoodPlanItem item;
+        item.foodId = food.getId();
+        item.cityId = food.getCityId();
+        item.name = food.getName();
+        item.priceCents = std::llround(food.getPrice() * 100);
+
+        auto score = request.scores.find(food.getId());
+        item.score = score != request.scores.end() ? score->second : 1.0;
+
+        auto maxQuantity = request.maxQuantities.find(food.getId());
+        item.maxQuantity = maxQuantity != request.maxQuantities.end() ? maxQuantity->second : request.defaultMaxQuantity;
+
+        items.push_back(item);
+    }
+
+    return FoodPlanner::solve(items, request.budgetCents, request.cityMinimums);
+}
+
 // Method to display all foods on screen
 void FoodService::displayAllFoods() {
     // Display header - create a nice looking title
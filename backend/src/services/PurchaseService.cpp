@@ -0,0 +1,201 @@
+/**
+ * @file PurchaseService.cpp
+ * @brief Implementation of PurchaseService - validation and the write-behind purchase ledger
+ */
+
+#include "../../include/services/PurchaseService.hpp"
+#include "../../include/databaseManager.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+PurchaseService::PurchaseService(PurchaseRepository& purchaseRepo, TripRepository& tripRepo,
+                                 ReferenceDataCache& referenceData, const PurchaseLedgerConfig& config)
+    : purchaseRepo(purchaseRepo), tripRepo(tripRepo), referenceData(referenceData), config(config),
+      nextSequence(1), decidedThrough(0), forgottenThrough(0), stopping(false) {
+    flusher = std::thread(&PurchaseService::flusherLoop, this);
+}
+
+PurchaseService::~PurchaseService() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+
+    if (flusher.joinable()) {
+        flusher.join();
+    }
+}
+
+std::string PurchaseService::validate(const Purchase& purchase) {
+    if (purchase.getQuantity() <= 0) {
+        return "quantity must be a positive integer";
+    }
+    if (purchase.getTripId() < 0) {
+        return "trip_id must be a trip ID or omitted";
+    }
+
+    auto foods = referenceData.getFoodIndex();
+    const Food* food = foods->findById(purchase.getFoodId());
+    if (!food) {
+        return "food " + std::to_string(purchase.getFoodId()) + " does not exist";
+    }
+    if (food->getCityId() != purchase.getCityId()) {
+        return "food " + std::to_string(purchase.getFoodId()) + " is not sold in city " +
+               std::to_string(purchase.getCityId());
+    }
+
+    Trip trip;
+    if (purchase.getTripId() > 0 && !tripRepo.load(purchase.getTripId(), trip)) {
+        return "trip " + std::to_string(purchase.getTripId()) + " does not exist";
+    }
+
+    return "";
+}
+
+bool PurchaseService::submit(const V<Purchase>& purchases, PurchaseTicket& ticket) {
+    if (purchases.empty()) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping || queue.size() + purchases.size() > config.maxQueuedPurchases) {
+            return false;
+        }
+
+        ticket.firstSequence = nextSequence;
+        for (const auto& purchase : purchases) {
+            queue.push_back(QueuedPurchase{nextSequence++, purchase});
+        }
+        ticket.lastSequence = nextSequence - 1;
+    }
+
+    workAvailable.notify_one();
+    return true;
+}
+
+PurchaseAckStatus PurchaseService::getStatus(long long sequence) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return statusLocked(sequence, sequence);
+}
+
+PurchaseAckStatus PurchaseService::getStatus(long long firstSequence, long long lastSequence) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return statusLocked(firstSequence, lastSequence);
+}
+
+PurchaseAckStatus PurchaseService::waitFor(const PurchaseTicket& ticket, int timeoutMs) {
+    std::unique_lock<std::mutex> lock(mutex);
+    batchDecided.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this, &ticket]() {
+        return decidedThrough >= ticket.lastSequence;
+    });
+    return statusLocked(ticket.firstSequence, ticket.lastSequence);
+}
+
+size_t PurchaseService::queuedCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
+
+// Caller holds the mutex
+PurchaseAckStatus PurchaseService::statusLocked(long long firstSequence, long long lastSequence) {
+    if (firstSequence <= 0 || lastSequence >= nextSequence) {
+        return PurchaseAckStatus::Unknown;
+    }
+    if (lastSequence > decidedThrough) {
+        return PurchaseAckStatus::Pending;
+    }
+    if (firstSequence <= forgottenThrough) {
+        return PurchaseAckStatus::Unknown;
+    }
+
+    auto failed = std::lower_bound(failedSequences.begin(), failedSequences.end(), firstSequence);
+    if (failed != failedSequences.end() && *failed <= lastSequence) {
+        return PurchaseAckStatus::Failed;
+    }
+    return PurchaseAckStatus::Durable;
+}
+
+std::string PurchaseService::statusToString(PurchaseAckStatus status) {
+    switch (status) {
+        case PurchaseAckStatus::Pending: return "pending";
+        case PurchaseAckStatus::Durable: return "durable";
+        case PurchaseAckStatus::Failed:  return "failed";
+        default:                         return "unknown";
+    }
+}
+
+void PurchaseService::flusherLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        workAvailable.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            break;  // stopping with nothing left to write
+        }
+
+        // Give the batch a short window to fill up, unless it already has
+        if (!stopping && queue.size() < config.maxBatchSize) {
+            workAvailable.wait_for(lock, std::chrono::milliseconds(config.flushIntervalMs), [this]() {
+                return stopping || queue.size() >= config.maxBatchSize;
+            });
+        }
+
+        V<QueuedPurchase> batch;
+        while (!queue.empty() && batch.size() < config.maxBatchSize) {
+            batch.push_back(queue.front());
+            queue.pop_front();
+        }
+
+        lock.unlock();
+        writeBatch(batch);
+        lock.lock();
+
+        decidedThrough = batch[batch.size() - 1].sequence;
+        batchDecided.notify_all();
+    }
+}
+
+// Writes one batch and records which sequence numbers failed
+void PurchaseService::writeBatch(const V<QueuedPurchase>& batch) {
+    V<Purchase> purchases;
+    for (const auto& entry : batch) {
+        purchases.push_back(entry.purchase);
+    }
+
+    if (writeInTransaction(purchases)) {
+        return;
+    }
+
+    // Isolate the bad rows so the rest of the batch is still written
+    std::cerr << "⚠️ Purchase batch of " << batch.size() << " failed, retrying individually" << std::endl;
+    V<long long> failed;
+    for (const auto& entry : batch) {
+        V<Purchase> single;
+        single.push_back(entry.purchase);
+        if (!writeInTransaction(single)) {
+            failed.push_back(entry.sequence);
+        }
+    }
+
+    if (failed.empty()) {
+        return;
+    }
+
+    std::cerr << "❌ Dropped " << failed.size() << " purchases the database rejected" << std::endl;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (long long sequence : failed) {
+        failedSequences.push_back(sequence);
+    }
+    while (failedSequences.size() > config.maxTrackedFailures) {
+        forgottenThrough = failedSequences.front();
+        failedSequences.pop_front();
+    }
+}
+
+bool PurchaseService::writeInTransaction(const V<Purchase>& purchases) {
+    Transaction transaction(DatabaseManager::getInstance());
+    return transaction.isActive() && purchaseRepo.saveAll(purchases) && transaction.commit();
+}
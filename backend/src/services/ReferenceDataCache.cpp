@@ -0,0 +1,137 @@
+#include "../../include/services/ReferenceDataCache.hpp"
+#include <iostream>
+
+// Versions are unique across every cache in the process
+static std::atomic<uint64_t> nextSnapshotVersion(1);
+
+ReferenceDataSnapshot::ReferenceDataSnapshot(uint64_t version, V<City> cities, CityDistanceTable directDistances,
+                                             const V<Food>& foods)
+    : version(version), cities(std::move(cities)), directDistances(std::move(directDistances)),
+      shortestPaths(this->directDistances), foodIndex(foods) {
+    for (size_t i = 0; i < this->cities.size(); i++) {
+        cityPositions[this->cities[i].getId()] = i;
+    }
+}
+
+const City* ReferenceDataSnapshot::findCity(int cityId) const {
+    auto position = cityPositions.find(cityId);
+    return position != cityPositions.end() ? &cities[position->second] : nullptr;
+}
+
+std::string ReferenceDataSnapshot::cityName(int cityId) const {
+    const City* city = findCity(cityId);
+    return city ? city->getName() : "Unknown";
+}
+
+ReferenceDataCache::ReferenceDataCache(CityRepository& cityRepo, CityDistanceRepository& cityDistanceRepo,
+                                       FoodRepository& foodRepo)
+    : cityRepo(cityRepo), cityDistanceRepo(cityDistanceRepo), foodRepo(foodRepo), currentVersion(0),
+      reloadRequested(false), stopping(false) {}
+
+ReferenceDataCache::~ReferenceDataCache() {
+    {
+        std::lock_guard<std::mutex> lock(workerMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+std::shared_ptr<const ReferenceDataSnapshot> ReferenceDataCache::getSnapshot() {
+    if (currentVersion.load(std::memory_order_acquire) == 0) {
+        // First use: one thread loads, the others wait for it once
+        std::lock_guard<std::mutex> lock(reloadMutex);
+        if (currentVersion.load(std::memory_order_acquire) == 0) {
+            publish(loadSnapshot());
+        }
+    }
+
+    // No per-thread copy: idle threads must not keep a superseded snapshot alive
+    return std::atomic_load_explicit(&current, std::memory_order_acquire);
+}
+
+std::shared_ptr<const DistanceMatrix> ReferenceDataCache::getDistanceMatrix() {
+    // Aliasing pointers: each shares ownership of the snapshot that holds the data
+    std::shared_ptr<const ReferenceDataSnapshot> snapshot = getSnapshot();
+    return std::shared_ptr<const DistanceMatrix>(snapshot, &snapshot->shortestPaths.getMetricClosure());
+}
+
+std::shared_ptr<const ShortestPaths> ReferenceDataCache::getShortestPaths() {
+    std::shared_ptr<const ReferenceDataSnapshot> snapshot = getSnapshot();
+    return std::shared_ptr<const ShortestPaths>(snapshot, &snapshot->shortestPaths);
+}
+
+std::shared_ptr<const FoodIndex> ReferenceDataCache::getFoodIndex() {
+    std::shared_ptr<const ReferenceDataSnapshot> snapshot = getSnapshot();
+    return std::shared_ptr<const FoodIndex>(snapshot, &snapshot->foodIndex);
+}
+
+std::shared_ptr<const V<City>> ReferenceDataCache::getCities() {
+    std::shared_ptr<const ReferenceDataSnapshot> snapshot = getSnapshot();
+    return std::shared_ptr<const V<City>>(snapshot, &snapshot->cities);
+}
+
+uint64_t ReferenceDataCache::getVersion() const {
+    return currentVersion.load(std::memory_order_acquire);
+}
+
+std::shared_ptr<const ReferenceDataSnapshot> ReferenceDataCache::loadSnapshot() {
+    auto snapshot = std::make_shared<const ReferenceDataSnapshot>(
+        nextSnapshotVersion.fetch_add(1), cityRepo.findAll(), cityDistanceRepo.findAllColumnar(), foodRepo.findAll());
+
+    std::cout << "📦 Cached " << snapshot->cities.size() << " cities, "
+              << snapshot->shortestPaths.getDirectEdgeCount() << " city distances ("
+              << snapshot->shortestPaths.getIndirectPairCount() << " pairs routed through other cities) and "
+              << snapshot->foodIndex.size() << " foods (version " << snapshot->version << ")" << std::endl;
+    return snapshot;
+}
+
+void ReferenceDataCache::publish(const std::shared_ptr<const ReferenceDataSnapshot>& snapshot) {
+    // Pointer before version, so a reader that sees the new version always
+    // finds the new (or a newer) snapshot behind it
+    std::atomic_store_explicit(&current, snapshot, std::memory_order_release);
+    currentVersion.store(snapshot->version, std::memory_order_release);
+}
+
+uint64_t ReferenceDataCache::reload() {
+    std::lock_guard<std::mutex> lock(reloadMutex);
+
+    // Built while readers keep using the published snapshot
+    std::shared_ptr<const ReferenceDataSnapshot> snapshot = loadSnapshot();
+    publish(snapshot);
+    return snapshot->version;
+}
+
+void ReferenceDataCache::requestReload() {
+    {
+        std::lock_guard<std::mutex> lock(workerMutex);
+        reloadRequested = true;
+        if (!worker.joinable() && !stopping) {
+            worker = std::thread(&ReferenceDataCache::workerLoop, this);
+        }
+    }
+    wakeUp.notify_one();
+}
+
+void ReferenceDataCache::workerLoop() {
+    std::unique_lock<std::mutex> lock(workerMutex);
+
+    while (true) {
+        wakeUp.wait(lock, [this]() { return stopping || reloadRequested; });
+        if (stopping) {
+            break;
+        }
+
+        reloadRequested = false;
+        lock.unlock();
+        try {
+            reload();
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Reference data reload failed: " << e.what() << std::endl;
+        }
+        lock.lock();
+    }
+}
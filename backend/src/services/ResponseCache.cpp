@@ -0,0 +1,170 @@
+#include "../../include/services/ResponseCache.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <zlib.h>
+
+namespace {
+    std::string trim(const std::string& text) {
+        size_t begin = text.find_first_not_of(" \t");
+        if (begin == std::string::npos) {
+            return "";
+        }
+        size_t end = text.find_last_not_of(" \t");
+        return text.substr(begin, end - begin + 1);
+    }
+
+    // Weight of one Accept-Encoding element: "gzip;q=0.5" -> 0.5, no q -> 1
+    double qualityOf(const std::string& parameters) {
+        size_t q = parameters.find("q=");
+        if (q == std::string::npos) {
+            return 1.0;
+        }
+        return std::atof(parameters.c_str() + q + 2);
+    }
+}
+
+const char* contentEncodingName(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::Gzip:     return "gzip";
+        case ContentEncoding::Deflate:  return "deflate";
+        case ContentEncoding::Identity: return "identity";
+    }
+    return "identity";
+}
+
+ContentEncoding negotiateEncoding(const std::string& acceptEncoding) {
+    // -1 = not mentioned, so "*" decides
+    double gzip = -1.0;
+    double deflate = -1.0;
+    double anyOther = 0.0;
+
+    size_t start = 0;
+    while (start <= acceptEncoding.size()) {
+        size_t comma = acceptEncoding.find(',', start);
+        std::string element = acceptEncoding.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        start = comma == std::string::npos ? acceptEncoding.size() + 1 : comma + 1;
+
+        size_t semicolon = element.find(';');
+        std::string coding = trim(element.substr(0, semicolon));
+        std::transform(coding.begin(), coding.end(), coding.begin(), [](unsigned char c) { return std::tolower(c); });
+        double quality = semicolon == std::string::npos ? 1.0 : qualityOf(element.substr(semicolon + 1));
+
+        if (coding == "gzip" || coding == "x-gzip") {
+            gzip = quality;
+        } else if (coding == "deflate") {
+            deflate = quality;
+        } else if (coding == "*") {
+            anyOther = quality;
+        }
+    }
+
+    if (gzip < 0) {
+        gzip = anyOther;
+    }
+    if (deflate < 0) {
+        deflate = anyOther;
+    }
+
+    if (gzip > 0 && gzip >= deflate) {
+        return ContentEncoding::Gzip;
+    }
+    if (deflate > 0) {
+        return ContentEncoding::Deflate;
+    }
+    return ContentEncoding::Identity;
+}
+
+bool compressBody(const std::string& body, ContentEncoding encoding, std::string& out) {
+    if (encoding == ContentEncoding::Identity) {
+        return false;
+    }
+
+    // 15-bit window; +16 asks zlib for a gzip header and trailer instead of a zlib one
+    int windowBits = encoding == ContentEncoding::Gzip ? 15 + 16 : 15;
+
+    z_stream stream = {};
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+
+    // Done once per data version, so spend the time on the best ratio
+    out.resize(deflateBound(&stream, body.size()));
+    stream.next_in = (Bytef*)body.data();
+    stream.avail_in = (uInt)body.size();
+    stream.next_out = (Bytef*)&out[0];
+    stream.avail_out = (uInt)out.size();
+
+    int result = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result == Z_STREAM_END;
+}
+
+const std::string& CachedResponse::bodyFor(ContentEncoding& encoding) const {
+    if (encoding == ContentEncoding::Gzip && !gzip.empty()) {
+        return gzip;
+    }
+    if (encoding == ContentEncoding::Deflate && !deflate.empty()) {
+        return deflate;
+    }
+    encoding = ContentEncoding::Identity;
+    return identity;
+}
+
+ResponseCache::ResponseCache() : hits(0), builds(0) {}
+
+std::shared_ptr<const CachedResponse> ResponseCache::get(const std::string& key, uint64_t version,
+                                                         const std::string& contentType,
+                                                         const std::function<std::string()>& build) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it != entries.end() && it->second->version >= version) {
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+
+    // Built outside the lock so a large body never blocks hits on other keys
+    auto entry = std::make_shared<CachedResponse>();
+    entry->version = version;
+    entry->contentType = contentType;
+    entry->identity = build();
+
+    std::string compressed;
+    if (compressBody(entry->identity, ContentEncoding::Gzip, compressed) && compressed.size() < entry->identity.size()) {
+        entry->gzip = std::move(compressed);
+    }
+    compressed.clear();
+    if (compressBody(entry->identity, ContentEncoding::Deflate, compressed) &&
+        compressed.size() < entry->identity.size()) {
+        entry->deflate = std::move(compressed);
+    }
+    builds.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const CachedResponse>& slot = entries[key];
+    // Another thread may have stored a newer version meanwhile
+    if (!slot || slot->version < version) {
+        slot = entry;
+    }
+    return entry;
+}
+
+uint64_t ResponseCache::getHits() const {
+    return hits.load(std::memory_order_relaxed);
+}
+
+uint64_t ResponseCache::getBuilds() const {
+    return builds.load(std::memory_order_relaxed);
+}
+
+size_t ResponseCache::storedBytes() {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t total = 0;
+    for (const auto& entry : entries) {
+        total += entry.second->identity.size() + entry.second->gzip.size() + entry.second->deflate.size();
+    }
+    return total;
+}
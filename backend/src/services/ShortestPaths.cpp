@@ -0,0 +1,227 @@
+#include "../../include/services/ShortestPaths.hpp"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace {
+
+// Larger than any real path; two of them still add up without overflowing
+const int UNREACHABLE = std::numeric_limits<int>::max() / 2;
+
+// Relaxes tile (iBlock, jBlock) through the cities of tile kBlock
+void relaxTile(std::vector<int>& dist, std::vector<int>& nextHop, int width, int kBlock, int iBlock, int jBlock) {
+    int kEnd = std::min(kBlock + ShortestPaths::BLOCK_SIZE, width);
+    int iEnd = std::min(iBlock + ShortestPaths::BLOCK_SIZE, width);
+    int jEnd = std::min(jBlock + ShortestPaths::BLOCK_SIZE, width);
+
+    for (int k = kBlock; k < kEnd; k++) {
+        const int* rowK = &dist[(size_t)k * width];
+        for (int i = iBlock; i < iEnd; i++) {
+            int* rowI = &dist[(size_t)i * width];
+            int throughK = rowI[k];
+            if (throughK >= UNREACHABLE) {
+                continue;
+            }
+            int hopToK = nextHop[(size_t)i * width + k];
+            for (int j = jBlock; j < jEnd; j++) {
+                int candidate = throughK + rowK[j];
+                if (candidate < rowI[j]) {
+                    rowI[j] = candidate;
+                    nextHop[(size_t)i * width + j] = hopToK;
+                }
+            }
+        }
+    }
+}
+
+}
+
+ShortestPaths::ShortestPaths() : algorithm(Algorithm::FloydWarshall), directEdgeCount(0), indirectPairCount(0) {}
+
+ShortestPaths::ShortestPaths(const DistanceMatrix& direct)
+    : algorithm(Algorithm::FloydWarshall), directEdgeCount(0), indirectPairCount(0) {
+    // Walking the matrix row by row, in ID order, yields the legs already grouped by city
+    CityDistanceTable legs;
+    for (int from = 0; from < direct.getCityCount(); from++) {
+        const int* row = direct.getRow(direct.getCityId(from));
+        for (int to = 0; to < direct.getCityCount(); to++) {
+            if (row[to] != DistanceMatrix::NO_EDGE) {
+                legs.append(direct.getCityId(from), direct.getCityId(to), row[to]);
+            }
+        }
+    }
+    build(direct, legs);
+}
+
+ShortestPaths::ShortestPaths(const CityDistanceTable& legs)
+    : algorithm(Algorithm::FloydWarshall), directEdgeCount(0), indirectPairCount(0) {
+    build(DistanceMatrix(legs), legs);
+}
+
+// Works on the direct matrix's dense indexes throughout; nextHop holds indexes too
+void ShortestPaths::build(const DistanceMatrix& direct, const CityDistanceTable& legs) {
+    directEdgeCount = direct.getEdgeCount();
+    int width = direct.getCityCount();
+    size_t cells = (size_t)width * width;
+
+    // Dijkstra pays off once Floyd-Warshall's N^3 dwarfs N * E log N
+    size_t cities = width;
+    if (width > FLOYD_WARSHALL_MAX_CITIES && directEdgeCount * 8 < cities * cities) {
+        algorithm = Algorithm::Dijkstra;
+    }
+
+    std::vector<int> dist(cells, UNREACHABLE);
+    nextHop.assign(cells, -1);
+
+    if (algorithm == Algorithm::Dijkstra) {
+        dijkstra(direct, legs, dist, width);
+    } else {
+        for (int from = 0; from < width; from++) {
+            const int* row = direct.getRow(direct.getCityId(from));
+            for (int to = 0; to < width; to++) {
+                int distance = from == to ? 0 : row[to];
+                if (distance != DistanceMatrix::NO_EDGE) {
+                    dist[(size_t)from * width + to] = distance;
+                    nextHop[(size_t)from * width + to] = to;
+                }
+            }
+        }
+        floydWarshall(dist, width);
+    }
+
+    // Publish as a DistanceMatrix: unreachable pairs become NO_EDGE and the
+    // diagonal keeps whatever city_distances said, so hasCity() is unchanged
+    std::vector<int> cityIds(width);
+    for (int from = 0; from < width; from++) {
+        cityIds[from] = direct.getCityId(from);
+        const int* row = direct.getRow(cityIds[from]);
+        for (int to = 0; to < width; to++) {
+            size_t cell = (size_t)from * width + to;
+            if (from == to) {
+                dist[cell] = row[to];
+                nextHop[cell] = dist[cell] == DistanceMatrix::NO_EDGE ? -1 : to;
+            } else if (dist[cell] >= UNREACHABLE) {
+                dist[cell] = DistanceMatrix::NO_EDGE;
+                nextHop[cell] = -1;
+            } else if (nextHop[cell] != to) {
+                indirectPairCount++;
+            }
+        }
+    }
+
+    closure = DistanceMatrix(std::move(cityIds), std::move(dist));
+    closure.buildNeighbourLists();
+}
+
+// Blocked Floyd-Warshall: for each diagonal tile, first close the tile itself,
+// then its row and column of tiles, then everything else. Each step touches
+// at most three tiles, which stay in cache while their BLOCK_SIZE rounds run.
+void ShortestPaths::floydWarshall(std::vector<int>& dist, int width) {
+    std::vector<int>& hops = nextHop;
+    for (int kBlock = 0; kBlock < width; kBlock += BLOCK_SIZE) {
+        relaxTile(dist, hops, width, kBlock, kBlock, kBlock);
+
+        for (int block = 0; block < width; block += BLOCK_SIZE) {
+            if (block != kBlock) {
+                relaxTile(dist, hops, width, kBlock, kBlock, block);
+                relaxTile(dist, hops, width, kBlock, block, kBlock);
+            }
+        }
+
+        for (int iBlock = 0; iBlock < width; iBlock += BLOCK_SIZE) {
+            if (iBlock == kBlock) {
+                continue;
+            }
+            for (int jBlock = 0; jBlock < width; jBlock += BLOCK_SIZE) {
+                if (jBlock != kBlock) {
+                    relaxTile(dist, hops, width, kBlock, iBlock, jBlock);
+                }
+            }
+        }
+    }
+}
+
+// One Dijkstra per source; each city's slice of the table is its adjacency list
+void ShortestPaths::dijkstra(const DistanceMatrix& direct, const CityDistanceTable& legs,
+                             std::vector<int>& dist, int width) {
+    typedef std::pair<int, int> QueueEntry; // (km from source, city index)
+    for (int source = 0; source < width; source++) {
+        int* row = &dist[(size_t)source * width];
+        int* hops = &nextHop[(size_t)source * width];
+
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+        row[source] = 0;
+        hops[source] = source;
+        queue.push(std::make_pair(0, source));
+
+        while (!queue.empty()) {
+            QueueEntry top = queue.top();
+            queue.pop();
+            int city = top.second;
+            if (top.first > row[city]) {
+                continue; // stale entry
+            }
+
+            CityDistanceTable::Row out = legs.getRow(direct.getCityId(city));
+            for (size_t i = 0; i < out.size; i++) {
+                int to = direct.getIndex(out.toCityIds[i]);
+                int candidate = top.first + out.distances[i];
+                if (to < 0 || to == city || candidate >= row[to]) {
+                    continue;
+                }
+                row[to] = candidate;
+                // Leaving the source, the next hop is the neighbour itself
+                hops[to] = city == source ? to : hops[city];
+                queue.push(std::make_pair(candidate, to));
+            }
+        }
+    }
+}
+
+const DistanceMatrix& ShortestPaths::getMetricClosure() const {
+    return closure;
+}
+
+int ShortestPaths::getNextHop(int fromCityId, int toCityId) const {
+    int from = closure.getIndex(fromCityId);
+    int to = closure.getIndex(toCityId);
+    if (from < 0 || to < 0) {
+        return -1;
+    }
+    int hop = nextHop[(size_t)from * closure.getCityCount() + to];
+    return hop < 0 ? -1 : closure.getCityId(hop);
+}
+
+V<int> ShortestPaths::getPath(int fromCityId, int toCityId) const {
+    V<int> path;
+    if (fromCityId == toCityId) {
+        if (closure.getIndex(fromCityId) >= 0) {
+            path.push_back(fromCityId);
+        }
+        return path;
+    }
+    if (getNextHop(fromCityId, toCityId) == -1) {
+        return path;
+    }
+
+    path.push_back(fromCityId);
+    int city = fromCityId;
+    while (city != toCityId && (int)path.size() <= closure.getCityCount()) {
+        city = getNextHop(city, toCityId);
+        path.push_back(city);
+    }
+    return path;
+}
+
+ShortestPaths::Algorithm ShortestPaths::getAlgorithm() const {
+    return algorithm;
+}
+
+size_t ShortestPaths::getDirectEdgeCount() const {
+    return directEdgeCount;
+}
+
+size_t ShortestPaths::getIndirectPairCount() const {
+    return indirectPairCount;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file SpendingService.cpp
+ * @brief Implementation of SpendingService - aggregate lookups and consistency checks
+ */
+
+#include "../../include/services/SpendingService.hpp"
+#include "../../include/databaseManager.hpp"
+#include <iostream>
+
+static const SpendingScope ALL_SCOPES[] = {SpendingScope::Trip, SpendingScope::City, SpendingScope::Food};
+
+SpendingService::SpendingService(SpendingRepository& spendingRepo) : spendingRepo(spendingRepo) {}
+
+SpendingTotals SpendingService::getTotals(SpendingScope scope, int id) {
+    SpendingTotals totals;
+    if (!spendingRepo.findTotals(scope, id, totals)) {
+        totals = SpendingTotals();
+        totals.id = id;
+    }
+    return totals;
+}
+
+V<SpendingMismatch> SpendingService::checkConsistency() {
+    V<SpendingMismatch> mismatches;
+
+    for (SpendingScope scope : ALL_SCOPES) {
+        for (const auto& mismatch : spendingRepo.findMismatches(scope)) {
+            mismatches.push_back(mismatch);
+        }
+    }
+
+    std::cout << "🔎 Spending consistency check found " << mismatches.size() << " mismatched rows" << std::endl;
+    return mismatches;
+}
+
+bool SpendingService::rebuild() {
+    Transaction transaction(DatabaseManager::getInstance());
+    if (!transaction.isActive()) {
+        return false;
+    }
+
+    for (SpendingScope scope : ALL_SCOPES) {
+        if (!spendingRepo.rebuild(scope)) {
+            std::cerr << "❌ Failed to rebuild " << SpendingRepository::scopeToString(scope) << " spending" << std::endl;
+            return false;
+        }
+    }
+
+    if (!transaction.commit()) {
+        return false;
+    }
+
+    std::cout << "✅ Spending aggregates rebuilt" << std::endl;
+    return true;
+}
@@ -0,0 +1,294 @@
+/**
+ * @file TaskScheduler.cpp
+ * @brief Implementation of TaskScheduler and TaskGroup - the shared work-stealing pool
+ */
+
+#include "../../include/services/TaskScheduler.hpp"
+#include <chrono>
+#include <iostream>
+
+namespace {
+    // Which scheduler and worker the calling thread belongs to (none for outside threads)
+    thread_local TaskScheduler* currentScheduler = nullptr;
+    thread_local size_t currentWorker = 0;
+
+    // More chunks than workers, so a thread that finishes early can steal the rest
+    const size_t CHUNKS_PER_WORKER = 4;
+}
+
+TaskScheduler& TaskScheduler::getInstance() {
+    static TaskScheduler instance;
+    return instance;
+}
+
+TaskScheduler::TaskScheduler(size_t workerCount)
+    : queuedTasks(0), submitted(0), helped(0), nextWorker(0), stopping(false) {
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (size_t i = 0; i < workerCount; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    // Start threads only once every deque exists, since workers steal from each other
+    for (size_t i = 0; i < workerCount; i++) {
+        workers[i]->thread = std::thread(&TaskScheduler::workerLoop, this, i);
+    }
+
+    std::cout << "🧵 Task scheduler started with " << workerCount << " workers" << std::endl;
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+void TaskScheduler::submit(Task task) {
+    submit(std::move(task), nullptr);
+}
+
+void TaskScheduler::submit(Task task, const TaskGroup* group) {
+    size_t target;
+    if (currentScheduler == this) {
+        target = currentWorker;
+    } else {
+        target = nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    }
+
+    {
+        Worker& worker = *workers[target];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(QueuedTask{std::move(task), group});
+        queuedTasks.fetch_add(1, std::memory_order_release);
+    }
+    submitted.fetch_add(1, std::memory_order_relaxed);
+
+    // Taking the lock orders this wake-up after a sleeping worker's last check
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeUp.notify_one();
+}
+
+bool TaskScheduler::runPendingTask(const TaskGroup* group) {
+    Task task;
+    if (currentScheduler == this) {
+        if (!takeTask(currentWorker, task)) {
+            return false;
+        }
+        runTask(task);
+        workers[currentWorker]->executed.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Outside threads have no deque of their own; take the oldest task of
+    // their own group, never someone else's (a queued job could run for seconds)
+    if (group == nullptr) {
+        return false;
+    }
+    size_t start = nextWorker.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < workers.size() && !task; i++) {
+        Worker& victim = *workers[(start + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        for (auto it = victim.tasks.begin(); it != victim.tasks.end(); ++it) {
+            if (it->group == group) {
+                task = std::move(it->run);
+                victim.tasks.erase(it);
+                queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+                break;
+            }
+        }
+    }
+    if (!task) {
+        return false;
+    }
+
+    runTask(task);
+    helped.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void TaskScheduler::parallelFor(size_t count, const std::function<void(size_t, size_t)>& body,
+                                const CancellationToken& token) {
+    size_t chunks = std::min(count, workers.size() * CHUNKS_PER_WORKER);
+    if (chunks <= 1) {
+        if (count > 0 && !token.isCancelled()) {
+            body(0, count);
+        }
+        return;
+    }
+
+    TaskGroup group(*this, token);
+    size_t chunkSize = (count + chunks - 1) / chunks;
+    for (size_t begin = 0; begin < count; begin += chunkSize) {
+        size_t end = std::min(begin + chunkSize, count);
+        group.run([&body, begin, end]() { body(begin, end); });
+    }
+    group.wait();
+}
+
+size_t TaskScheduler::getWorkerCount() const {
+    return workers.size();
+}
+
+TaskSchedulerStats TaskScheduler::getStats() {
+    TaskSchedulerStats stats;
+    stats.workerCount = workers.size();
+    stats.submitted = submitted.load(std::memory_order_relaxed);
+    stats.helped = helped.load(std::memory_order_relaxed);
+    stats.executed = stats.helped;
+
+    for (auto& worker : workers) {
+        size_t depth;
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            depth = worker->tasks.size();
+        }
+        stats.queueDepths.push_back(depth);
+        stats.queuedTasks += depth;
+        stats.executed += worker->executed.load(std::memory_order_relaxed);
+        stats.steals += worker->steals.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void TaskScheduler::workerLoop(size_t index) {
+    currentScheduler = this;
+    currentWorker = index;
+
+    Worker& self = *workers[index];
+    while (true) {
+        Task task;
+        if (takeTask(index, task)) {
+            runTask(task);
+            self.executed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this]() { return stopping || queuedTasks.load(std::memory_order_acquire) > 0; });
+        if (stopping && queuedTasks.load(std::memory_order_acquire) == 0) {
+            return; // stopping and nothing left to do
+        }
+    }
+}
+
+bool TaskScheduler::takeTask(size_t index, Task& task) {
+    // Own deque first, newest task first
+    {
+        Worker& self = *workers[index];
+        std::lock_guard<std::mutex> lock(self.mutex);
+        if (!self.tasks.empty()) {
+            task = std::move(self.tasks.back().run);
+            self.tasks.pop_back();
+            queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Then steal the oldest task from the next worker that has one
+    for (size_t i = 1; i < workers.size(); i++) {
+        Worker& victim = *workers[(index + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front().run);
+            victim.tasks.pop_front();
+            queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            workers[index]->steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::runTask(Task& task) {
+    try {
+        task();
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Scheduled task failed: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "❌ Scheduled task failed" << std::endl;
+    }
+}
+
+TaskGroup::TaskGroup(TaskScheduler& scheduler, const CancellationToken& token)
+    : scheduler(scheduler), token(token), pending(0) {}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+        // Nobody is left to report a failure to; the tasks have all finished
+    }
+}
+
+void TaskGroup::run(TaskScheduler::Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending++;
+    }
+
+    scheduler.submit([this, task = std::move(task)]() {
+        std::exception_ptr failure;
+        if (!token.isCancelled()) {
+            try {
+                task();
+            } catch (...) {
+                failure = std::current_exception();
+            }
+        }
+
+        // Notify under the lock: once pending hits 0 the group may be destroyed
+        std::lock_guard<std::mutex> lock(mutex);
+        if (failure && !error) {
+            error = failure;
+        }
+        pending--;
+        if (pending == 0) {
+            finished.notify_all();
+        }
+    }, this);
+}
+
+void TaskGroup::wait() {
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (pending == 0) {
+                break;
+            }
+        }
+
+        // Help instead of blocking; sleep only when there is nothing to run
+        if (!scheduler.runPendingTask(this)) {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait_for(lock, std::chrono::milliseconds(1), [this]() { return pending == 0; });
+        }
+    }
+
+    std::exception_ptr failure;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::swap(failure, error);
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+void TaskGroup::cancel() {
+    token.cancel();
+}
+
+const CancellationToken& TaskGroup::getToken() const {
+    return token;
+}
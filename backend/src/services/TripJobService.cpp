@@ -0,0 +1,222 @@
+/**
+ * @file TripJobService.cpp
+ * @brief Implementation of TripJobService - asynchronous custom trip planning
+ *
+ * Planning and the per-city inserts it performs can take a while for large
+ * requests, so instead of holding a Crow worker for the whole sequence the
+ * route layer hands the request to this service and returns a job ID. Clients
+ * poll the job until it reports completed or failed.
+ */
+
+#include "../../include/services/TripJobService.hpp"
+#include <iostream>
+#include <set>
+#include <stdexcept>
+
+TripJobService::TripJobService(TripService& tripService, size_t maxRunningJobs,
+                               size_t maxQueuedJobs, size_t maxRetainedJobs, TaskScheduler& scheduler)
+    : tripService(tripService), scheduler(scheduler), maxRunningJobs(maxRunningJobs), maxQueuedJobs(maxQueuedJobs),
+      maxRetainedJobs(maxRetainedJobs), nextJobId(1), runningJobs(0), stopping(false) {
+    if (this->maxRunningJobs == 0) {
+        this->maxRunningJobs = 1;
+    }
+
+    std::cout << "🧵 Trip job service runs up to " << this->maxRunningJobs << " jobs on the task scheduler (queue limit "
+              << maxQueuedJobs << ")" << std::endl;
+}
+
+TripJobService::~TripJobService() {
+    // Queued jobs still run; scheduled tasks refer to this service, so wait for all of them
+    std::unique_lock<std::mutex> lock(mutex);
+    stopping = true;
+    allJobsDone.wait(lock, [this]() { return runningJobs == 0 && pendingJobs.empty(); });
+}
+
+int TripJobService::submit(int startCityId, const V<int>& cityIds, const RouteOptions& options) {
+    int jobId;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Backpressure: refuse work instead of letting the queue grow without bound
+        if (stopping || pendingJobs.size() >= maxQueuedJobs) {
+            std::cout << "⚠️ Trip job queue full (" << pendingJobs.size() << " waiting)" << std::endl;
+            return -1;
+        }
+
+        jobId = nextJobId++;
+
+        TripJob job;
+        job.id = jobId;
+        job.startCityId = startCityId;
+        job.cityIds = cityIds;
+        job.options = options;
+        // Distinct listed cities plus the start; the planner corrects it once it runs
+        std::set<int> distinctCities(cityIds.begin(), cityIds.end());
+        distinctCities.insert(startCityId);
+        job.targetCities = distinctCities.size();
+        jobs[jobId] = job;
+
+        pendingJobs.push_back(jobId);
+        scheduleJobs();
+    }
+
+    std::cout << "📥 Queued trip job " << jobId << std::endl;
+    return jobId;
+}
+
+bool TripJobService::getJob(int jobId, TripJob& job) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = jobs.find(jobId);
+    if (it == jobs.end()) {
+        return false;
+    }
+
+    job = it->second;
+    return true;
+}
+
+bool TripJobService::cancel(int jobId) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = jobs.find(jobId);
+    if (it == jobs.end()) {
+        return false;
+    }
+
+    TripJob& job = it->second;
+    if (job.status == TripJobStatus::Queued) {
+        // Never started: finish it here so it leaves the queue right away
+        for (auto pending = pendingJobs.begin(); pending != pendingJobs.end(); ++pending) {
+            if (*pending == jobId) {
+                pendingJobs.erase(pending);
+                break;
+            }
+        }
+        job.cancellation.cancel();
+        job.status = TripJobStatus::Cancelled;
+        retireJob(jobId);
+        if (pendingJobs.empty() && runningJobs == 0) {
+            allJobsDone.notify_all();
+        }
+        return true;
+    }
+    if (job.status == TripJobStatus::Running) {
+        job.cancellation.cancel(); // runJob notices at the next progress update
+        return true;
+    }
+    return false;
+}
+
+size_t TripJobService::queuedJobCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pendingJobs.size();
+}
+
+size_t TripJobService::runningJobCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return runningJobs;
+}
+
+std::string TripJobService::statusToString(TripJobStatus status) {
+    switch (status) {
+        case TripJobStatus::Queued:    return "queued";
+        case TripJobStatus::Running:   return "running";
+        case TripJobStatus::Completed: return "completed";
+        case TripJobStatus::Failed:    return "failed";
+        case TripJobStatus::Cancelled: return "cancelled";
+    }
+    return "unknown";
+}
+
+void TripJobService::scheduleJobs() {
+    while (runningJobs < maxRunningJobs && !pendingJobs.empty()) {
+        int jobId = pendingJobs.front();
+        pendingJobs.pop_front();
+        jobs[jobId].status = TripJobStatus::Running;
+        runningJobs++;
+
+        scheduler.submit([this, jobId]() {
+            runJob(jobId);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            runningJobs--;
+            scheduleJobs();
+            if (runningJobs == 0 && pendingJobs.empty()) {
+                allJobsDone.notify_all(); // under the lock: the destructor may be waiting
+            }
+        });
+    }
+}
+
+void TripJobService::runJob(int jobId) {
+    int startCityId;
+    V<int> cityIds;
+    RouteOptions options;
+    CancellationToken cancellation;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        startCityId = jobs[jobId].startCityId;
+        cityIds = jobs[jobId].cityIds;
+        options = jobs[jobId].options;
+        cancellation = jobs[jobId].cancellation;
+    }
+
+    std::cout << "⚙️ Running trip job " << jobId << std::endl;
+
+    // Publish progress while the planner grows the route; a cancelled job
+    // unwinds out of the planner from here, before anything is saved
+    TripProgressCallback onProgress = [this, jobId, cancellation](int citiesPlanned, int targetCities,
+                                                                  double distanceSoFar) {
+        if (cancellation.isCancelled()) {
+            throw std::runtime_error("Job cancelled");
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        TripJob& job = jobs[jobId];
+        job.citiesPlanned = citiesPlanned;
+        job.targetCities = targetCities;
+        job.bestDistance = distanceSoFar;
+    };
+
+    try {
+        if (cancellation.isCancelled()) {
+            throw std::runtime_error("Job cancelled");
+        }
+        Trip trip = tripService.planCustomTour(startCityId, cityIds, onProgress, options);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        TripJob& job = jobs[jobId];
+        if (trip.getId() > 0) {
+            job.status = TripJobStatus::Completed;
+            job.trip = trip;
+            job.bestDistance = trip.getTotalDistance();
+        } else {
+            job.status = TripJobStatus::Failed;
+            job.error = "Failed to create custom tour";
+        }
+        retireJob(jobId);
+    } catch (const std::exception& e) {
+        std::lock_guard<std::mutex> lock(mutex);
+        TripJob& job = jobs[jobId];
+        if (cancellation.isCancelled()) {
+            job.status = TripJobStatus::Cancelled;
+        } else {
+            job.status = TripJobStatus::Failed;
+            job.error = e.what();
+        }
+        retireJob(jobId);
+    }
+
+    std::cout << "✅ Trip job " << jobId << " finished" << std::endl;
+}
+
+void TripJobService::retireJob(int jobId) {
+    finishedJobs.push_back(jobId);
+
+    // Keep memory bounded: forget the oldest finished jobs first
+    while (finishedJobs.size() > maxRetainedJobs) {
+        jobs.erase(finishedJobs.front());
+        finishedJobs.pop_front();
+    }
+}
@@ -0,0 +1,174 @@
+/**
+ * @file TripMaintenanceService.cpp
+ * @brief Implementation of TripMaintenanceService - retention, dedup and compaction
+ */
+
+#include "../../include/services/TripMaintenanceService.hpp"
+#include "../../include/databaseManager.hpp"
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <map>
+
+TripMaintenanceService::TripMaintenanceService(TripRepository& tripRepo, const TripMaintenanceConfig& config)
+    : tripRepo(tripRepo), config(config), stopping(false), runCount(0) {}
+
+TripMaintenanceService::~TripMaintenanceService() {
+    stop();
+}
+
+void TripMaintenanceService::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (worker.joinable()) {
+        return;
+    }
+
+    stopping = false;
+    worker = std::thread(&TripMaintenanceService::workerLoop, this);
+    std::cout << "🧹 Trip maintenance scheduled every " << config.intervalSeconds << "s" << std::endl;
+}
+
+void TripMaintenanceService::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void TripMaintenanceService::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!stopping) {
+        wakeUp.wait_for(lock, std::chrono::seconds(config.intervalSeconds), [this]() { return stopping; });
+        if (stopping) {
+            break;
+        }
+
+        lock.unlock();
+        try {
+            runOnce();
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Trip maintenance failed: " << e.what() << std::endl;
+        }
+        lock.lock();
+    }
+}
+
+TripMaintenanceReport TripMaintenanceService::runOnce() {
+    TripMaintenanceReport report;
+
+    std::cout << "🧹 Trip maintenance pass started" << std::endl;
+
+    report.duplicatesRemoved = deduplicateRoutes();
+    report.expiredRemoved = deleteExpiredTrips();
+
+    runCount++;
+    report.analyzed = config.analyzeEveryRuns > 0 && runCount % config.analyzeEveryRuns == 0;
+    compact(report.analyzed);
+
+    std::cout << "🧹 Trip maintenance pass done: " << report.duplicatesRemoved << " duplicates, "
+              << report.expiredRemoved << " expired trips removed" << std::endl;
+    return report;
+}
+
+// Runs one unit of work in its own short transaction
+bool TripMaintenanceService::runBatch(const std::function<bool()>& work) {
+    Transaction transaction(DatabaseManager::getInstance());
+    return transaction.isActive() && work() && transaction.commit();
+}
+
+// Kinds whose catalog row opts in to dedup and expiry; user-built trips are never touched
+V<TripKind> TripMaintenanceService::maintainedKinds() {
+    V<TripKind> kinds;
+    for (const auto& info : TRIP_KIND_CATALOG) {
+        if (info.maintained) {
+            kinds.push_back(info.kind);
+        }
+    }
+    return kinds;
+}
+
+int TripMaintenanceService::deduplicateRoutes() {
+    long long cutoff = (long long)std::time(nullptr) - config.dedupMinAgeSeconds;
+    V<TripKind> kinds = maintainedKinds();
+    int removed = 0;
+
+    while (true) {
+        V<TripDuplicate> page = tripRepo.findDuplicateRoutes(kinds, cutoff, config.batchSize);
+        if (page.empty()) {
+            break;
+        }
+
+        std::map<int, V<int>> duplicatesByCanonical;
+        for (const auto& entry : page) {
+            duplicatesByCanonical[entry.canonicalId].push_back(entry.duplicateId);
+        }
+
+        bool merged = runBatch([&]() {
+            for (const auto& group : duplicatesByCanonical) {
+                if (!tripRepo.mergeDuplicates(group.first, group.second)) {
+                    return false;
+                }
+            }
+            return true;
+        });
+
+        if (!merged) {
+            std::cerr << "❌ Failed to merge duplicate trips" << std::endl;
+            break;
+        }
+
+        removed += page.size();
+        if ((int)page.size() < config.batchSize) {
+            break;
+        }
+    }
+
+    return removed;
+}
+
+int TripMaintenanceService::deleteExpiredTrips() {
+    long long cutoff = (long long)std::time(nullptr) - config.tripTtlSeconds;
+    V<TripKind> kinds = maintainedKinds();
+    int removed = 0;
+
+    while (true) {
+        V<int> expired = tripRepo.findExpiredUnreferencedIds(kinds, cutoff, config.batchSize);
+        if (expired.empty()) {
+            break;
+        }
+
+        if (!runBatch([&]() { return tripRepo.deleteByIds(expired); })) {
+            std::cerr << "❌ Failed to delete expired trips" << std::endl;
+            break;
+        }
+
+        removed += expired.size();
+        if ((int)expired.size() < config.batchSize) {
+            break;
+        }
+    }
+
+    return removed;
+}
+
+void TripMaintenanceService::compact(bool analyze) {
+    DatabaseManager& database = DatabaseManager::getInstance();
+
+    // No-op unless the database was created with auto_vacuum = INCREMENTAL
+    auto mode = database.executeSelect("PRAGMA auto_vacuum;");
+    if (!mode.empty() && !mode[0].empty() && mode[0][0] == "2") {
+        database.executeSelect("PRAGMA incremental_vacuum(" + std::to_string(config.vacuumPages) + ");");
+    } else {
+        std::cout << "⚠️ auto_vacuum is not INCREMENTAL; free pages stay in the file until a full VACUUM" << std::endl;
+    }
+
+    if (analyze) {
+        database.executeQuery("ANALYZE;");
+    }
+}
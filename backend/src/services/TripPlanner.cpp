@@ -0,0 +1,521 @@
+#include "../../include/services/TripPlanner.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace {
+
+// Open-city set of a fixed-size tour: one bit per tour position
+template <size_t MaxCities>
+using TourMask = typename std::conditional<MaxCities <= 16, uint16_t,
+                 typename std::conditional<MaxCities <= 32, uint32_t, uint64_t>::type>::type;
+
+// Greedy kernel for tours of at most MaxCities cities, the start included.
+// The tour's distances are copied into a fixed MaxCities x MaxCities tile
+// indexed by tour position rather than city ID, and the open cities are the
+// set bits of one word, so each step reads only the open slots of one short
+// row with no bounds checks or visited lookups. Picks the same cities as
+// planGreedyWith: tourCityIds lists the candidates in their citiesToVisit
+// order, so scanning low bits first with strict < keeps ties on the earlier one.
+template <size_t MaxCities, class LegCost, class ReturnCost>
+PlannedRoute planFixedTour(const DistanceMatrix& distances, const std::vector<int>& tourCityIds,
+                           int targetCities, bool closed, const LegCost& legCost,
+                           const ReturnCost& returnCost, const TripProgressCallback& onProgress) {
+    static_assert(MaxCities <= 64, "tour positions must fit in a 64-bit mask");
+    using Mask = TourMask<MaxCities>;
+    using Cost = decltype(legCost(0, 0, 0) + returnCost(0));
+    constexpr int NO_EDGE = DistanceMatrix::NO_EDGE;
+
+    const size_t count = tourCityIds.size(); // tourCityIds[0] is the start city
+    std::array<int, MaxCities> cityIds;
+    std::array<int, MaxCities> homeDistances; // column 0 of the tile: each position's leg back to the start
+    std::array<int, MaxCities * MaxCities> tile;
+    cityIds.fill(0);
+    homeDistances.fill(NO_EDGE);
+    tile.fill(NO_EDGE);
+    for (size_t from = 0; from < count; from++) {
+        cityIds[from] = tourCityIds[from];
+    }
+    // Candidates are all known cities; an unknown start has no row and no column
+    std::array<int, MaxCities> indexes;
+    for (size_t at = 0; at < count; at++) {
+        indexes[at] = distances.getIndex(cityIds[at]);
+    }
+    bool startKnown = indexes[0] >= 0;
+    for (size_t from = 0; from < count; from++) {
+        const int* row = distances.getRow(cityIds[from]);
+        if (!row) {
+            continue;
+        }
+        for (size_t to = startKnown ? 0 : 1; to < count; to++) {
+            tile[from * MaxCities + to] = indexes[to] >= 0 ? row[indexes[to]] : NO_EDGE;
+        }
+        homeDistances[from] = tile[from * MaxCities];
+    }
+
+    // Every listed candidate starts open; position 0 is the start and never is
+    Mask open = count >= sizeof(Mask) * 8 ? (Mask)~Mask(0) : (Mask)((Mask(1) << count) - 1);
+    open &= (Mask)~Mask(1);
+
+    PlannedRoute route;
+    route.startCityId = cityIds[0];
+    route.cityIds.reserve(count + 1); // every city plus the return, in one allocation
+    route.cityIds.push_back(cityIds[0]);
+
+    if (onProgress) {
+        onProgress(route.cityIds.size(), targetCities, route.totalDistance);
+    }
+
+    size_t current = 0;
+    int nearestDistance = 0;
+
+    // Best open position from `current`; with closing set, only positions
+    // that can reach the start are considered
+    auto pickNext = [&](bool closing) {
+        const int* row = &tile[current * MaxCities];
+        int nearest = -1;
+        Cost minCost = std::numeric_limits<Cost>::max();
+
+        // Visit only the open positions, lowest first, one set bit at a time
+        for (Mask candidates = open; candidates != 0; candidates &= candidates - 1) {
+            int to = __builtin_ctzll(candidates);
+            int distance = row[to];
+            if (distance == NO_EDGE) {
+                continue;
+            }
+
+            Cost cost = legCost(cityIds[current], cityIds[to], distance);
+            if (closing) {
+                if (homeDistances[to] == NO_EDGE) {
+                    continue;
+                }
+                cost += returnCost(homeDistances[to]);
+            }
+
+            if (cost < minCost) {
+                minCost = cost;
+                nearest = to;
+                nearestDistance = distance;
+            }
+        }
+
+        return nearest;
+    };
+
+    while ((int)route.cityIds.size() < targetCities) {
+        bool lastStop = closed && (int)route.cityIds.size() + 1 == targetCities;
+
+        int nearest = pickNext(lastStop);
+        if (nearest == -1 && lastStop) {
+            nearest = pickNext(false); // no way home from any candidate; finish the open path
+        }
+
+        if (nearest == -1) {
+            break; // no reachable city left in the list
+        }
+
+        open &= (Mask)~(Mask(1) << nearest);
+        route.cityIds.push_back(cityIds[nearest]);
+        route.totalDistance += nearestDistance;
+        current = nearest;
+
+        if (onProgress) {
+            onProgress(route.cityIds.size(), targetCities, route.totalDistance);
+        }
+    }
+
+    // Close the loop with the leg back to the start
+    if (closed && route.cityIds.size() > 1) {
+        int distanceHome = homeDistances[current];
+        if (distanceHome != NO_EDGE) {
+            route.cityIds.push_back(cityIds[0]);
+            route.totalDistance += distanceHome;
+            route.returnDistance = distanceHome;
+            route.closed = true;
+        }
+    }
+
+    return route;
+}
+
+// The start city followed by the distinct, known candidates in list order
+void collectTourCities(const DistanceMatrix& distances, int startCityId, const V<int>& citiesToVisit,
+                       std::vector<int>& tourCityIds) {
+    tourCityIds.clear();
+    tourCityIds.push_back(startCityId);
+
+    std::vector<char> listed(distances.getMaxCityId() + 1, 0);
+    if (distances.getIndex(startCityId) >= 0) {
+        listed[startCityId] = 1;
+    }
+    for (int candidate : citiesToVisit) {
+        if (distances.getIndex(candidate) < 0 || listed[candidate]) {
+            continue;
+        }
+        listed[candidate] = 1;
+        tourCityIds.push_back(candidate);
+    }
+}
+
+// Shared nearest-neighbour loop: repeatedly moves to the unvisited candidate
+// with the lowest legCost(from, to, km). Ties go to the earlier candidate.
+// For closed routes the last city also pays returnCost(km home), so the loop
+// optimizes the whole cycle rather than the open path.
+// With useNeighbours the cost is plain distance, so the neighbour lists can
+// answer most steps without scanning every candidate.
+template <class LegCost, class ReturnCost>
+PlannedRoute planGreedyWith(const DistanceMatrix& distances, int startCityId, const V<int>& citiesToVisit,
+                            int maxStops, bool closed, bool useNeighbours, const LegCost& legCost,
+                            const ReturnCost& returnCost, const TripProgressCallback& onProgress) {
+    // Repeated, unknown and start-city entries in the list are never visited,
+    // so only the distinct known candidates count towards the target
+    std::vector<int> tourCityIds;
+    collectTourCities(distances, startCityId, citiesToVisit, tourCityIds);
+    int targetCities = tourCityIds.size(); // the start city plus every candidate
+    if (maxStops > 0 && maxStops + 1 < targetCities) {
+        targetCities = maxStops + 1;
+    }
+
+    // Tours that fit in 64 positions (every preset tour) run on the
+    // fixed-size kernel with the smallest tile that holds them
+    if (tourCityIds.size() <= 64) {
+        if (tourCityIds.size() <= 16) {
+            return planFixedTour<16>(distances, tourCityIds, targetCities, closed, legCost, returnCost, onProgress);
+        }
+        if (tourCityIds.size() <= 32) {
+            return planFixedTour<32>(distances, tourCityIds, targetCities, closed, legCost, returnCost, onProgress);
+        }
+        return planFixedTour<64>(distances, tourCityIds, targetCities, closed, legCost, returnCost, onProgress);
+    }
+
+    PlannedRoute route;
+    route.startCityId = startCityId;
+    route.cityIds.push_back(startCityId);
+
+    // visited[id] marks cities already on the route; the start city is only revisited by the return leg
+    std::vector<char> visited(distances.getMaxCityId() + 1, 0);
+    if (startCityId > 0 && startCityId <= distances.getMaxCityId()) {
+        visited[startCityId] = 1;
+    }
+
+    if (onProgress) {
+        onProgress(route.cityIds.size(), targetCities, route.totalDistance);
+    }
+
+    // position[id] is the city's first index in citiesToVisit, which breaks
+    // distance ties the same way the full scan does; -1 if not listed
+    useNeighbours = useNeighbours && distances.getNeighbourCount() > 0;
+    std::vector<int> position;
+    if (useNeighbours) {
+        position.assign(distances.getMaxCityId() + 1, -1);
+        for (int i = (int)citiesToVisit.size() - 1; i >= 0; i--) {
+            int cityId = citiesToVisit[i];
+            if (cityId > 0 && cityId <= distances.getMaxCityId()) {
+                position[cityId] = i;
+            }
+        }
+    }
+
+    int currentCityId = startCityId;
+    int nearestDistance = 0;
+
+    // Nearest open city from the k-nearest list; -1 when the list cannot
+    // decide (nothing open in it, or a distance tie running past its end)
+    auto pickFromNeighbours = [&]() {
+        const int* nearest = distances.getNeighbours(currentCityId);
+        if (!nearest) {
+            return -1;
+        }
+
+        int bestCityId = -1;
+        int bestDistance = 0;
+        for (int i = 0; i < distances.getNeighbourCount() && nearest[i] != -1; i++) {
+            int candidate = nearest[i];
+            int distance = distances.getDistance(currentCityId, candidate);
+            if (bestCityId != -1 && distance > bestDistance) {
+                nearestDistance = bestDistance;
+                return bestCityId;
+            }
+            if (position[candidate] == -1 || visited[candidate]) {
+                continue;
+            }
+            if (bestCityId == -1 || position[candidate] < position[bestCityId]) {
+                bestCityId = candidate;
+                bestDistance = distance;
+            }
+        }
+
+        // A short list holds every reachable city, so its answer is final
+        bool complete = distances.getNeighbourCount() == 0 ||
+                        nearest[distances.getNeighbourCount() - 1] == -1;
+        if (bestCityId != -1 && complete) {
+            nearestDistance = bestDistance;
+            return bestCityId;
+        }
+        return -1;
+    };
+
+    // Best unvisited candidate from currentCityId; with closing set, only
+    // candidates that can reach the start are considered
+    auto pickNext = [&](bool closing) {
+        int nearestCityId = -1;
+        auto minCost = std::numeric_limits<decltype(legCost(0, 0, 0) + returnCost(0))>::max();
+
+        for (int candidate : citiesToVisit) {
+            if (candidate <= 0 || candidate > distances.getMaxCityId() || visited[candidate]) {
+                continue;
+            }
+
+            int distance = distances.getDistance(currentCityId, candidate);
+            if (distance == DistanceMatrix::NO_EDGE) {
+                continue;
+            }
+
+            auto cost = legCost(currentCityId, candidate, distance);
+            if (closing) {
+                int distanceHome = distances.getDistance(candidate, startCityId);
+                if (distanceHome == DistanceMatrix::NO_EDGE) {
+                    continue;
+                }
+                cost += returnCost(distanceHome);
+            }
+
+            if (cost < minCost) {
+                minCost = cost;
+                nearestCityId = candidate;
+                nearestDistance = distance;
+            }
+        }
+        return nearestCityId;
+    };
+
+    while ((int)route.cityIds.size() < targetCities) {
+        bool lastStop = closed && (int)route.cityIds.size() + 1 == targetCities;
+
+        int nearestCityId = useNeighbours && !lastStop ? pickFromNeighbours() : -1;
+        if (nearestCityId == -1) {
+            nearestCityId = pickNext(lastStop);
+        }
+        if (nearestCityId == -1 && lastStop) {
+            nearestCityId = pickNext(false); // no way home from any candidate; finish the open path
+        }
+
+        if (nearestCityId == -1) {
+            break; // no reachable city left in the list
+        }
+
+        visited[nearestCityId] = 1;
+        route.cityIds.push_back(nearestCityId);
+        route.totalDistance += nearestDistance;
+        currentCityId = nearestCityId;
+
+        if (onProgress) {
+            onProgress(route.cityIds.size(), targetCities, route.totalDistance);
+        }
+    }
+
+    // Close the loop with the leg back to the start
+    if (closed && route.cityIds.size() > 1) {
+        int distanceHome = distances.getDistance(currentCityId, startCityId);
+        if (distanceHome != DistanceMatrix::NO_EDGE) {
+            route.cityIds.push_back(startCityId);
+            route.totalDistance += distanceHome;
+            route.returnDistance = distanceHome;
+            route.closed = true;
+        }
+    }
+
+    return route;
+}
+
+}
+
+PlannedRoute TripPlanner::planGreedy(const DistanceMatrix& distances, int startCityId,
+                                     const V<int>& citiesToVisit,
+                                     const TripProgressCallback& onProgress, bool closed) {
+    return planGreedyWith(distances, startCityId, citiesToVisit, 0, closed, true,
+                          [](int, int, int distance) { return distance; },
+                          [](int distanceHome) { return distanceHome; }, onProgress);
+}
+
+PlannedRoute TripPlanner::planGreedyByCost(const DistanceMatrix& distances, const TripCostModel& costs,
+                                           int startCityId, const V<int>& citiesToVisit, int maxStops,
+                                           const TripProgressCallback& onProgress, bool closed) {
+    return planGreedyWith(distances, startCityId, citiesToVisit, maxStops, closed, false,
+                          [&costs](int, int to, int distance) { return costs.legCost(distance, to); },
+                          [&costs](int distanceHome) { return costs.distanceWeight * costs.travelCost(distanceHome); },
+                          onProgress);
+}
+
+int TripPlanner::improveTwoOpt(const DistanceMatrix& distances, PlannedRoute& route, int maxPasses) {
+    std::vector<int> cities(route.cityIds.begin(), route.cityIds.end());
+    int count = cities.size();
+    int lastMovable = route.closed ? count - 2 : count - 1; // a closed route's final return stays put
+    if (lastMovable < 2) {
+        return 0;
+    }
+
+    auto leg = [&distances](int from, int to) {
+        return distances.getDistance(from, to);
+    };
+
+    // forward[t] / backward[t]: length of legs 0..t-1 walked forwards / backwards,
+    // so a stretch's reversed length is an O(1) difference even for asymmetric data.
+    // missingBack[t] counts the legs 0..t-1 that have no edge walked backwards.
+    std::vector<long long> forward(count), backward(count);
+    std::vector<int> missingBack(count);
+    std::vector<int> positionOf(distances.getMaxCityId() + 1, -1);
+    auto reindex = [&]() {
+        forward[0] = backward[0] = 0;
+        missingBack[0] = 0;
+        for (int t = 1; t < count; t++) {
+            int there = leg(cities[t - 1], cities[t]);
+            int back = leg(cities[t], cities[t - 1]);
+            forward[t] = forward[t - 1] + (there == DistanceMatrix::NO_EDGE ? 0 : there);
+            backward[t] = backward[t - 1] + (back == DistanceMatrix::NO_EDGE ? 0 : back);
+            missingBack[t] = missingBack[t - 1] + (back == DistanceMatrix::NO_EDGE ? 1 : 0);
+        }
+        for (int t = 0; t <= lastMovable; t++) {
+            positionOf[cities[t]] = t;
+        }
+    };
+
+    // Gain of reversing cities[i+1..j]; <= 0 when the move does not help or is impossible
+    auto gain = [&](int i, int j) -> long long {
+        int removedFirst = leg(cities[i], cities[i + 1]);
+        int addedFirst = leg(cities[i], cities[j]);
+        if (removedFirst == DistanceMatrix::NO_EDGE || addedFirst == DistanceMatrix::NO_EDGE) {
+            return 0;
+        }
+        long long before = removedFirst + (forward[j] - forward[i + 1]);
+        long long after = addedFirst + (backward[j] - backward[i + 1]);
+
+        if (j + 1 < count) {
+            int removedLast = leg(cities[j], cities[j + 1]);
+            int addedLast = leg(cities[i + 1], cities[j + 1]);
+            if (removedLast == DistanceMatrix::NO_EDGE || addedLast == DistanceMatrix::NO_EDGE) {
+                return 0;
+            }
+            before += removedLast;
+            after += addedLast;
+        }
+
+        // Every leg inside the reversed stretch must exist in the other direction too
+        if (missingBack[j] != missingBack[i + 1]) {
+            return 0;
+        }
+        return before - after;
+    };
+
+    const int neighbourCount = distances.getNeighbourCount();
+    int moves = 0;
+    reindex();
+
+    // First-improvement sweeps until a whole sweep finds nothing
+    bool improved = true;
+    for (int pass = 0; improved && pass < maxPasses; pass++) {
+        improved = false;
+
+        for (int i = 0; i < lastMovable - 1; i++) {
+            int bestJ = -1;
+
+            // A move swaps the legs cities[i] -> cities[i+1] and cities[j] -> cities[j+1]
+            // for cities[i] -> cities[j] and cities[i+1] -> cities[j+1]. It can only pay
+            // off if one new leg is shorter than the old leg at the same end, so
+            // cities[i] scans its neighbours until they pass its current leg, and
+            // cities[i+1] keeps only neighbours nearer than the leg into them.
+            const int* nearest = distances.getNeighbours(cities[i]);
+            if (nearest) {
+                int currentNext = leg(cities[i], cities[i + 1]);
+                for (int n = 0; n < neighbourCount && nearest[n] != -1 && bestJ == -1; n++) {
+                    if (currentNext != DistanceMatrix::NO_EDGE && leg(cities[i], nearest[n]) >= currentNext) {
+                        break;
+                    }
+                    int j = positionOf[nearest[n]];
+                    if (j > i + 1 && j <= lastMovable && cities[j] == nearest[n] && gain(i, j) > 0) {
+                        bestJ = j;
+                    }
+                }
+
+                const int* nearestToNext = distances.getNeighbours(cities[i + 1]);
+                for (int n = 0; nearestToNext && n < neighbourCount && nearestToNext[n] != -1 && bestJ == -1; n++) {
+                    int j = positionOf[nearestToNext[n]] - 1;
+                    if (j <= i + 1 || j > lastMovable || j + 1 >= count || cities[j + 1] != nearestToNext[n]) {
+                        continue;
+                    }
+                    int replaced = leg(cities[j], cities[j + 1]);
+                    if (replaced != DistanceMatrix::NO_EDGE && leg(cities[i + 1], cities[j + 1]) >= replaced) {
+                        continue;
+                    }
+                    if (gain(i, j) > 0) {
+                        bestJ = j;
+                    }
+                }
+            } else {
+                for (int j = i + 2; j <= lastMovable; j++) {
+                    if (gain(i, j) > 0) {
+                        bestJ = j;
+                        break;
+                    }
+                }
+            }
+
+            if (bestJ != -1) {
+                std::reverse(cities.begin() + i + 1, cities.begin() + bestJ + 1);
+                reindex();
+                moves++;
+                improved = true;
+            }
+        }
+    }
+
+    if (moves > 0) {
+        route.cityIds.clear();
+        for (int cityId : cities) {
+            route.cityIds.push_back(cityId);
+        }
+        route.totalDistance = (double)forward[count - 1];
+        if (route.closed) {
+            route.returnDistance = leg(cities[count - 2], cities[count - 1]);
+        }
+    }
+    return moves;
+}
+
+RouteCostBreakdown TripPlanner::breakdown(const DistanceMatrix& distances, const TripCostModel& costs,
+                                          const PlannedRoute& route) {
+    RouteCostBreakdown result;
+    if (route.cityIds.empty()) {
+        return result;
+    }
+
+    result.startFoodCost = costs.foodCost(route.cityIds[0]);
+    result.foodCost = result.startFoodCost;
+    result.weightedCost = costs.foodWeight * result.startFoodCost;
+
+    for (size_t i = 1; i < route.cityIds.size(); i++) {
+        RouteLeg leg;
+        leg.fromCityId = route.cityIds[i - 1];
+        leg.toCityId = route.cityIds[i];
+        leg.distance = distances.getDistance(leg.fromCityId, leg.toCityId);
+        if (leg.distance == DistanceMatrix::NO_EDGE) {
+            leg.distance = 0;
+        }
+        leg.travelCost = costs.travelCost(leg.distance);
+
+        // Nothing is bought on the way back home
+        bool returnLeg = route.closed && i == route.cityIds.size() - 1;
+        leg.foodCost = returnLeg ? 0.0 : costs.foodCost(leg.toCityId);
+        leg.weightedCost = costs.distanceWeight * leg.travelCost + costs.foodWeight * leg.foodCost;
+
+        result.travelCost += leg.travelCost;
+        result.foodCost += leg.foodCost;
+        result.weightedCost += leg.weightedCost;
+        result.legs.push_back(leg);
+    }
+
+    result.totalCost = result.travelCost + result.foodCost;
+    return result;
+}
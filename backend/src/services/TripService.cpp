@@ -1,214 +1,417 @@
 #include "../../include/services/TripService.hpp"
 #include "../../include/services/tripCityService.hpp"
 #include "../../include/entities/CityDistance.hpp"
+#include "../../include/databaseManager.hpp"
+#include "../../include/services/TaskScheduler.hpp"
 #include <iostream>
 #include <iomanip>
 #include <limits>
+#include <stdexcept>
 
 
-TripService::TripService(TripRepository& tripRepository, CityDistanceRepository& cityDistanceRepo, TripCityService& tripCityService)
-    : tripRepo(tripRepository), cityDistanceRepo(cityDistanceRepo), tripCityService(tripCityService) {}
+TripService::TripService(TripRepository& tripRepository, CityDistanceRepository& cityDistanceRepo, TripCityService& tripCityService,
+                         ReferenceDataCache& referenceData)
+    : tripRepo(tripRepository), cityDistanceRepo(cityDistanceRepo), tripCityService(tripCityService),
+      referenceData(referenceData) {}
 
-int TripService::findNearestUnvisitedCity(Trip& trip, int fromCityId) {
-    auto distances = cityDistanceRepo.findByFromCity(fromCityId);
-    int nearestCityId = -1;
-    int minDistance = std::numeric_limits<int>::max();
+// Inserts the trip and its cities in one transaction, so a failed insert leaves nothing behind
+Trip TripService::saveTrip(TripKind tripKind, const PlannedRoute& route) {
+    Trip trip(0, route.startCityId, tripKind, route.totalDistance);
 
-    std::cout << "🔍 Finding nearest unvisited city from " << fromCityId << std::endl;
+    Transaction transaction(DatabaseManager::getInstance());
+    if (!transaction.isActive()) {
+        std::cout << "❌ Failed to save " << tripKindLabel(tripKind) << " trip" << std::endl;
+        return trip;
+    }
 
-    for (const auto& row : distances) {
-        int candidate = row.getToCityId();
-        int distance = row.getDistance();
+    if (!saveRoute(trip, route) || !transaction.commit()) {
+        std::cout << "❌ Failed to save " << tripKindLabel(tripKind) << " trip" << std::endl;
+        trip.setId(0);
+        return trip;
+    }
 
-        // Skip the start city so we never return to the starting point
-        if (candidate == trip.getStartCityId()) {
-            std::cout << "   Skipping start city " << candidate << std::endl;
-            continue;
+    std::cout << "   Trip ID: " << trip.getId() << std::endl;
+    std::cout << "   Total distance: " << trip.getTotalDistance() << " km";
+    if (route.closed) {
+        std::cout << " (including " << route.returnDistance << " km back to the start)";
+    }
+    std::cout << std::endl;
+    std::cout << "   Stops: " << route.cityIds.size() << std::endl;
+
+    return trip;
+}
+
+// Main trip planning methods: plan against the cached distance matrix, then save
+Trip TripService::planParisTour(const RouteOptions& options) {
+    std::cout << "\n Planning Paris Tour - Visiting Initial 11 European Cities";
+    std::cout << (options.closed ? " (round trip)" : "") << "\n" << std::endl;
+
+    // Paris is city ID 9; Stockholm (12) and Vienna (13) are excluded
+    Trip parisTrip = saveTrip(TripKind::Paris, previewParisTour(options));
+    std::cout << " Paris tour completed!" << std::endl;
+    return parisTrip;
+}
+
+Trip TripService::planLondonTour(int numCities, const RouteOptions& options) {
+    std::cout << "\n🇬🇧 Planning London Tour for " << numCities << " cities";
+    std::cout << (options.closed ? " (round trip)" : "") << "\n" << std::endl;
+
+    Trip londonTrip = saveTrip(TripKind::London, previewLondonTour(numCities, options)); // London has ID 7
+    std::cout << " London tour completed!" << std::endl;
+    return londonTrip;
+}
+
+Trip TripService::planBerlinTour(const RouteOptions& options) {
+    std::cout << "\n🇩🇪 Planning Berlin Tour" << (options.closed ? " (round trip)" : "") << "\n" << std::endl;
+
+    // Berlin (ID 2) tour visits ALL 13 European cities
+    Trip berlinTrip = saveTrip(TripKind::Berlin, previewBerlinTour(options));
+    std::cout << " Berlin tour completed!" << std::endl;
+    return berlinTrip;
+}
+
+Trip TripService::planCustomTour(int startCityId, const V<int>& citiesToVisit,
+                                 const TripProgressCallback& onProgress, const RouteOptions& options) {
+    std::cout << "\n Planning Custom Tour" << (options.closed ? " (round trip)" : "") << "\n" << std::endl;
+    std::cout << "   Starting city ID: " << startCityId << std::endl;
+    std::cout << "   Cities to visit: " << citiesToVisit.size() << std::endl;
+
+    // Plan in memory first, then write the finished route in one transaction
+    Trip customTrip = saveTrip(TripKind::Custom, previewCustomTour(startCityId, citiesToVisit, onProgress, options));
+    std::cout << " Custom tour completed!" << std::endl;
+    return customTrip;
+}
+
+// Dry-run planning: same routes as the plan* methods, computed from the
+// cached distance matrix without writing to trips or trip_cities
+PlannedRoute TripService::previewCustomTour(int startCityId, const V<int>& citiesToVisit,
+                                            const TripProgressCallback& onProgress, const RouteOptions& options) {
+    std::shared_ptr<const DistanceMatrix> distances = referenceData.getDistanceMatrix();
+    PlannedRoute route = TripPlanner::planGreedy(*distances, startCityId, citiesToVisit, onProgress, options.closed);
+    if (options.twoOpt) {
+        TripPlanner::improveTwoOpt(*distances, route);
+    }
+    return route;
+}
+
+PlannedRoute TripService::previewParisTour(const RouteOptions& options) {
+    return previewCustomTour(9, parisTourCities(), nullptr, options); // Paris is city ID 9
+}
+
+PlannedRoute TripService::previewLondonTour(int numCities, const RouteOptions& options) {
+    return previewCustomTour(7, londonTourCities(numCities), nullptr, options); // London is city ID 7
+}
+
+PlannedRoute TripService::previewBerlinTour(const RouteOptions& options) {
+    return previewCustomTour(2, berlinTourCities(), nullptr, options); // Berlin is city ID 2
+}
+
+TripCostModel TripService::buildCostModel(const ReferenceDataSnapshot& referenceSnapshot, const TripCostOptions& options,
+                                          std::map<int, Food>& foodByCity) {
+    const DistanceMatrix* distances = &referenceSnapshot.shortestPaths.getMetricClosure();
+    const FoodIndex* foods = &referenceSnapshot.foodIndex;
+
+    TripCostModel model;
+    model.ratePerKm = options.ratePerKm;
+    model.distanceWeight = options.distanceWeight;
+    model.foodWeight = options.foodWeight;
+    model.foodCostByCity.assign(distances->getMaxCityId() + 1, 0.0);
+
+    // Default purchase: the cheapest food in each city
+    for (int cityId = 1; cityId <= distances->getMaxCityId(); cityId++) {
+        FoodQuery cheapest;
+        cheapest.cityId = cityId;
+        cheapest.limit = 1;
+        V<Food> found = foods->search(cheapest);
+        if (!found.empty()) {
+            foodByCity[cityId] = found[0];
         }
+    }
 
-        // Check if city is already visited
-        if (!hasCity(trip, candidate) && distance < minDistance) {
-            minDistance = distance;
-            nearestCityId = candidate;
-            std::cout << "   New nearest: " << candidate << " (distance: " << distance << ")" << std::endl;
-        } else {
-            std::cout << "   Skipping " << candidate << " (visited or farther)" << std::endl;
+    for (const auto& choice : options.chosenFoods) {
+        const Food* food = foods->findById(choice.second);
+        if (!food || food->getCityId() != choice.first) {
+            throw std::invalid_argument("Food " + std::to_string(choice.second) + " is not sold in city " +
+                                        std::to_string(choice.first));
         }
+        foodByCity[choice.first] = *food;
     }
-    
-    if (nearestCityId != -1) {
-        std::cout << "✅ Nearest unvisited city: " << nearestCityId << " (distance: " << minDistance << ")" << std::endl;
-    } else {
-        std::cout << "❌ No unvisited cities found from " << fromCityId << std::endl;
+
+    for (const auto& entry : foodByCity) {
+        if (entry.first < (int)model.foodCostByCity.size()) {
+            model.foodCostByCity[entry.first] = entry.second.getPrice();
+        }
     }
-    
-    return nearestCityId;
+
+    return model;
 }
 
-void TripService::CreateShortestTrip(Trip& trip, int startCityId) {
-    std::cout << "\n CreateShortestTrip called with startCityId: " << startCityId << std::endl;
-    
-    // Check if we've reached the maximum cities (11 for now)
-    int currentTripSize = getTripSize(trip);
-    std::cout << "   Current trip size: " << currentTripSize << std::endl;
-    
-    if (currentTripSize >= 11) {
-        std::cout << "✅ Trip complete! Visited 11 cities." << std::endl;
-        return;
-    }
+CostedRoute TripService::previewCulinaryTour(int startCityId, const V<int>& citiesToVisit,
+                                             const TripCostOptions& options) {
+    CostedRoute planned;
 
-    // Find the nearest unvisited city
-    int nextCityId = findNearestUnvisitedCity(trip, startCityId);
-    if (nextCityId == -1) {
-        std::cout << "🏁 No more cities to visit. Trip complete!" << std::endl;
-        return;
-    }
+    // One snapshot for the whole plan, so prices and distances come from the same load
+    std::shared_ptr<const ReferenceDataSnapshot> referenceSnapshot = referenceData.getSnapshot();
+    const DistanceMatrix* distances = &referenceSnapshot->shortestPaths.getMetricClosure();
+    TripCostModel model = buildCostModel(*referenceSnapshot, options, planned.foodByCity);
+
+    planned.route = TripPlanner::planGreedyByCost(*distances, model, startCityId, citiesToVisit, options.maxStops,
+                                                  nullptr, options.route.closed);
 
-    // Get distance to next city and update total distance
-    int legDistance = cityDistanceRepo.getDistance(startCityId, nextCityId);
-    if (legDistance > 0) {
-        trip.setTotalDistance(trip.getTotalDistance() + legDistance);
-        std::cout << "📏 Added " << legDistance << " km to trip. Total: " << trip.getTotalDistance() << " km" << std::endl;
+    // The visited cities (and so the food bill) are fixed now; 2-opt only shortens the travel
+    if (options.route.twoOpt) {
+        TripPlanner::improveTwoOpt(*distances, planned.route);
+    }
+    planned.costs = TripPlanner::breakdown(*distances, model, planned.route);
+
+    // Only report food for the cities actually on the route
+    std::map<int, Food> visitedFoods;
+    for (int cityId : planned.route.cityIds) {
+        auto food = planned.foodByCity.find(cityId);
+        if (food != planned.foodByCity.end()) {
+            visitedFoods[cityId] = food->second;
+        }
     }
+    planned.foodByCity = visitedFoods;
 
-    // Add city to trip
-    addCityToTrip(trip, nextCityId);
+    return planned;
+}
+
+Trip TripService::planCulinaryTour(int startCityId, const V<int>& citiesToVisit, const TripCostOptions& options,
+                                   CostedRoute& planned) {
+    planned = previewCulinaryTour(startCityId, citiesToVisit, options);
 
-    // Recursive call with the new city as starting point
-    CreateShortestTrip(trip, nextCityId);
+    Trip culinaryTrip = saveTrip(TripKind::Culinary, planned.route);
+    std::cout << " Culinary tour completed! " << planned.costs.totalCost << " EUR" << std::endl;
+    return culinaryTrip;
 }
 
-void TripService::CreateShortestTrip(Trip& trip, int startCityId, const V<int>& allowedCities) {
-    std::cout << "\n CreateShortestTrip called with startCityId: " << startCityId << std::endl;
-    
-    // ✅ FIXED: Check if we've visited all allowed cities (flexible limit)
-    int currentTripSize = getTripSize(trip);
-    int targetCities = allowedCities.size() + 1; // +1 for the starting city
-    std::cout << "   Current trip size: " << currentTripSize << std::endl;
-    std::cout << "   Target cities: " << targetCities << std::endl;
-    std::cout << "   Allowed cities count: " << allowedCities.size() << std::endl;
-
-    if (currentTripSize >= targetCities) {
-        std::cout << "✅ Trip complete! Visited all " << targetCities << " cities." << std::endl;
-        return;
+// The connection lock is held from BEGIN to COMMIT, so the stops and trip row
+// read here cannot change under the edit, and two edits of one trip run one
+// after the other instead of both acting on the same stops
+RouteEdit TripService::editTrip(int tripId,
+                                const std::function<bool(const Trip&, const V<TripCity>&, RouteEdit&)>& apply) {
+    RouteEdit edit;
+
+    Transaction transaction(DatabaseManager::getInstance());
+    if (!transaction.isActive()) {
+        edit.status = RouteEditStatus::StorageFailed;
+        edit.error = "Failed to start transaction";
+        return edit;
     }
 
-    // Find the nearest unvisited city from the allowed cities only
-    int nextCityId = findNearestUnvisitedCityFromList(trip, startCityId, allowedCities);
-    std::cout << "   Next city found: " << nextCityId << std::endl;
-    
-    if (nextCityId == -1) {
-        std::cout << " No more allowed cities to visit. Trip complete!" << std::endl;
-        std::cout << "   Final trip size: " << currentTripSize << std::endl;
-        return;
+    Trip trip;
+    V<TripCity> stops = tripCityService.getCitiesForTrip(tripId);
+    if (stops.empty() || !tripRepo.load(tripId, trip)) {
+        edit.status = RouteEditStatus::NotFound;
+        edit.error = "Trip not found or has no cities";
+        return edit;
     }
 
-    // Get distance to next city and update total distance
-    int legDistance = cityDistanceRepo.getDistance(startCityId, nextCityId);
-    if (legDistance > 0) {
-        trip.setTotalDistance(trip.getTotalDistance() + legDistance);
-        std::cout << " Distance from " << startCityId << " to " << nextCityId << ": " << legDistance << " km" << std::endl;
-        std::cout << " Added " << legDistance << " km to trip. Total: " << trip.getTotalDistance() << " km" << std::endl;
+    if (!apply(trip, stops, edit)) {
+        return edit;
     }
 
-    // Add city to trip
-    addCityToTrip(trip, nextCityId);
+    // Report the total as stored, not as computed from the earlier read
+    Trip updated;
+    if (!tripRepo.load(tripId, updated) || !transaction.commit()) {
+        edit.status = RouteEditStatus::StorageFailed;
+        edit.error = "Failed to save the updated trip";
+        return edit;
+    }
 
-    // Recursive call with the new city as starting point
-    CreateShortestTrip(trip, nextCityId, allowedCities);
+    edit.status = RouteEditStatus::Applied;
+    edit.totalDistance = updated.getTotalDistance();
+    return edit;
 }
 
-// Add helper method to find nearest city from a specific list
-int TripService::findNearestUnvisitedCityFromList(Trip& trip, int fromCityId, const V<int>& allowedCities) {
-    auto distances = cityDistanceRepo.findByFromCity(fromCityId);
-    int nearestCityId = -1;
-    int minDistance = std::numeric_limits<int>::max();
+RouteEdit TripService::insertCityIntoTrip(int tripId, int cityId) {
+    std::shared_ptr<const DistanceMatrix> distances = referenceData.getDistanceMatrix();
 
-    std::cout << "🔍 Finding nearest unvisited city from allowed list" << std::endl;
+    return editTrip(tripId, [&](const Trip&, const V<TripCity>& stops, RouteEdit& edit) {
+        if (!distances->hasCity(cityId)) {
+            edit.error = "Unknown city " + std::to_string(cityId);
+            return false;
+        }
+        for (const auto& stop : stops) {
+            if (stop.getCityId() == cityId) {
+                edit.error = "City " + std::to_string(cityId) + " is already on this trip";
+                return false;
+            }
+        }
 
-    for (const auto& row : distances) {
-        int candidate = row.getToCityId();
-        int distance = row.getDistance();
+        // Cheapest insertion: between a and b the city adds d(a,c) + d(c,b) - d(a,b).
+        // A gap whose own leg is unknown cannot be priced, so it is never chosen
+        bool closed = stops.size() > 1 && stops[0].getCityId() == stops[stops.size() - 1].getCityId();
+        bool found = false;
+        for (size_t i = 0; i + 1 < stops.size(); i++) {
+            int toCity = distances->getDistance(stops[i].getCityId(), cityId);
+            int fromCity = distances->getDistance(cityId, stops[i + 1].getCityId());
+            int direct = distances->getDistance(stops[i].getCityId(), stops[i + 1].getCityId());
+            if (toCity == DistanceMatrix::NO_EDGE || fromCity == DistanceMatrix::NO_EDGE ||
+                direct == DistanceMatrix::NO_EDGE) {
+                continue;
+            }
 
-        // Skip if not in allowed cities list
-        bool isAllowed = false;
-        for (int allowedCity : allowedCities) {
-            if (candidate == allowedCity) {
-                isAllowed = true;
-                break;
+            double delta = toCity + fromCity - direct;
+            if (!found || delta < edit.distanceDelta) {
+                found = true;
+                edit.distanceDelta = delta;
+                edit.visitOrder = stops[i + 1].getVisitOrder();
             }
         }
-        
-        if (!isAllowed) {
-            continue; // Skip cities not in the allowed list
+
+        // An open route may also simply end at the new city
+        const TripCity& last = stops[stops.size() - 1];
+        int toEnd = distances->getDistance(last.getCityId(), cityId);
+        if (!closed && toEnd != DistanceMatrix::NO_EDGE && (!found || toEnd < edit.distanceDelta)) {
+            found = true;
+            edit.distanceDelta = toEnd;
+            edit.visitOrder = last.getVisitOrder() + 1;
         }
 
-        // Skip the start city
-        if (candidate == trip.getStartCityId()) {
-            continue;
+        if (!found) {
+            edit.error = "City " + std::to_string(cityId) + " cannot be reached from this trip";
+            return false;
         }
 
-        // Check if city is already visited
-        if (!hasCity(trip, candidate) && distance < minDistance) {
-            minDistance = distance;
-            nearestCityId = candidate;
+        if (!tripCityService.insertCityAt(tripId, cityId, edit.visitOrder) ||
+            !tripRepo.addToTotalDistance(tripId, edit.distanceDelta)) {
+            edit.status = RouteEditStatus::StorageFailed;
+            edit.error = "Failed to save the updated trip";
+            return false;
         }
-    }
-    
-    return nearestCityId;
+        return true;
+    });
 }
 
-// Helper methods that were in Trip entity but should be in service
-bool TripService::hasCity(const Trip& trip, int cityId) {
-    // Check if city is already in the trip_cities table
-    V<TripCity> tripCities = tripCityService.getCitiesForTrip(trip.getId());
-    
-    for (const auto& tripCity : tripCities) {
-        if (tripCity.getCityId() == cityId) {
-            return true;
+RouteEdit TripService::removeCityFromTrip(int tripId, int cityId) {
+    std::shared_ptr<const DistanceMatrix> distances = referenceData.getDistanceMatrix();
+
+    return editTrip(tripId, [&](const Trip&, const V<TripCity>& stops, RouteEdit& edit) {
+        bool closed = stops.size() > 1 && stops[0].getCityId() == stops[stops.size() - 1].getCityId();
+        size_t lastMovable = closed ? stops.size() - 2 : stops.size() - 1;
+
+        if (stops[0].getCityId() == cityId) {
+            edit.error = "The start city cannot be removed";
+            return false;
         }
-    }
-    return false;
-}
 
-int TripService::getTripSize(const Trip& trip) {
-    // Get the number of cities in the trip
-    V<TripCity> tripCities = tripCityService.getCitiesForTrip(trip.getId());
-    return tripCities.size();
-}
+        size_t index = 0;
+        for (size_t i = 1; i <= lastMovable && index == 0; i++) {
+            if (stops[i].getCityId() == cityId) {
+                index = i;
+            }
+        }
+        if (index == 0) {
+            edit.status = RouteEditStatus::NotFound;
+            edit.error = "City " + std::to_string(cityId) + " is not on this trip";
+            return false;
+        }
+        if (lastMovable == 1) {
+            edit.error = "A trip must keep at least one city besides its start";
+            return false;
+        }
 
-void TripService::addCityToTrip(Trip& trip, int cityId) {
-    // Add city to trip_cities table
-    int visitOrder = getTripSize(trip) + 1; // Next position
-    bool success = tripCityService.addCityToTrip(trip.getId(), cityId, visitOrder);
-    
-    if (success) {
-        std::cout << "✅ Added city " << cityId << " to trip at position " << visitOrder << std::endl;
-    } else {
-        std::cout << "❌ Failed to add city " << cityId << " to trip" << std::endl;
-    }
+        // Removing c from a -> c -> b saves d(a,c) + d(c,b) and adds back d(a,b);
+        // every one of those legs must be known or the saving cannot be priced
+        int previous = stops[index - 1].getCityId();
+        int toCity = distances->getDistance(previous, cityId);
+        if (toCity == DistanceMatrix::NO_EDGE) {
+            edit.error = "No known route from city " + std::to_string(previous) + " to city " + std::to_string(cityId);
+            return false;
+        }
+        edit.distanceDelta = -(double)toCity;
+
+        if (index + 1 < stops.size()) {
+            int next = stops[index + 1].getCityId();
+            int fromCity = distances->getDistance(cityId, next);
+            int direct = distances->getDistance(previous, next);
+            if (fromCity == DistanceMatrix::NO_EDGE || direct == DistanceMatrix::NO_EDGE) {
+                edit.error = "No known route between the cities on either side of " + std::to_string(cityId);
+                return false;
+            }
+            edit.distanceDelta += direct - fromCity;
+        }
+        edit.visitOrder = stops[index].getVisitOrder();
+
+        if (!tripCityService.removeCityAt(tripId, edit.visitOrder) ||
+            !tripRepo.addToTotalDistance(tripId, edit.distanceDelta)) {
+            edit.status = RouteEditStatus::StorageFailed;
+            edit.error = "Failed to save the updated trip";
+            return false;
+        }
+        return true;
+    });
 }
 
-// Main trip planning methods using the new recursive approach
-Trip TripService::planParisTour() {
-    std::cout << "\n Planning Paris Tour - Visiting Initial 11 European Cities\n" << std::endl;
-
-    // Create trip - Paris is city ID 9
-    Trip parisTrip(0, 9, "paris_tour", 0.0);
-    
-    // Save trip to get ID
-    bool saved = tripRepo.save(parisTrip);
-    if (!saved || parisTrip.getId() <= 0) {
-        std::cout << "❌ Failed to save Paris trip" << std::endl;
-        return parisTrip;
-    }
+RouteEdit TripService::reorderTrip(int tripId, const V<int>& cityIds) {
+    std::shared_ptr<const DistanceMatrix> distances = referenceData.getDistanceMatrix();
+
+    return editTrip(tripId, [&](const Trip& trip, const V<TripCity>& stops, RouteEdit& edit) {
+        if (cityIds.size() != stops.size()) {
+            edit.error = "Expected " + std::to_string(stops.size()) + " cities, got " + std::to_string(cityIds.size());
+            return false;
+        }
+
+        bool closed = stops.size() > 1 && stops[0].getCityId() == stops[stops.size() - 1].getCityId();
+        if (cityIds[0] != stops[0].getCityId() ||
+            (closed && cityIds[cityIds.size() - 1] != stops[0].getCityId())) {
+            edit.error = closed ? "A round trip must start and end at its start city"
+                                : "A trip must start at its start city";
+            return false;
+        }
 
-    std::cout << "✅ Created Paris trip with ID: " << parisTrip.getId() << std::endl;
+        // Hand each requested city the next unused row for that city, so a
+        // city listed twice (the start of a round trip) keeps both of its rows
+        std::map<int, V<TripCity>> rowsByCity;
+        for (const auto& stop : stops) {
+            rowsByCity[stop.getCityId()].push_back(stop);
+        }
+        std::map<int, size_t> rowsUsed;
+        V<TripCity> reordered;
+        for (size_t i = 0; i < cityIds.size(); i++) {
+            auto rows = rowsByCity.find(cityIds[i]);
+            size_t& used = rowsUsed[cityIds[i]];
+            if (rows == rowsByCity.end() || used == rows->second.size()) {
+                edit.error = "City " + std::to_string(cityIds[i]) + " is not on this trip, or is listed too often";
+                return false;
+            }
+            reordered.push_back(rows->second[used++]);
+        }
 
-    // Add Paris as the first city
-    addCityToTrip(parisTrip, 9); // Paris is city ID 9
+        double total = 0.0;
+        for (size_t i = 1; i < cityIds.size(); i++) {
+            int leg = distances->getDistance(cityIds[i - 1], cityIds[i]);
+            if (leg == DistanceMatrix::NO_EDGE) {
+                edit.error = "No known route from city " + std::to_string(cityIds[i - 1]) +
+                             " to city " + std::to_string(cityIds[i]);
+                return false;
+            }
+            total += leg;
+        }
+        edit.distanceDelta = total - trip.getTotalDistance();
 
-    // Include all initial 11 cities (exclude Stockholm=12 and Vienna=13)
+        // The new total is known exactly, so it is stored as is rather than as a delta
+        if (!tripCityService.reorderStops(tripId, reordered) || !tripRepo.setTotalDistance(tripId, total)) {
+            edit.status = RouteEditStatus::StorageFailed;
+            edit.error = "Failed to save the updated trip";
+            return false;
+        }
+        return true;
+    });
+}
+
+// Inserts the trip row and its trip_cities rows; callers own the transaction
+bool TripService::saveRoute(Trip& trip, const PlannedRoute& route) {
+    if (!tripRepo.save(trip) || trip.getId() <= 0) {
+        return false;
+    }
+    return tripCityService.addRouteToTrip(trip.getId(), route.cityIds);
+}
+
+// Preset tour definitions (the starting city is added separately)
+V<int> TripService::parisTourCities() {
     V<int> initialCities;
     initialCities.push_back(1);  // Amsterdam
     initialCities.push_back(2);  // Berlin
@@ -220,49 +423,12 @@ Trip TripService::planParisTour() {
     initialCities.push_back(8);  // Madrid
     initialCities.push_back(10); // Prague
     initialCities.push_back(11); // Rome
-    // Note: Paris (9) is already added as the starting city
+    // Note: Paris (9) is the starting city
     // Excluding: Stockholm (12) and Vienna (13)
-
-    // Show what cities we're trying to visit
-    std::cout << " DEBUG: Initial cities list: ";
-    for (size_t i = 0; i < initialCities.size(); i++) {
-        std::cout << initialCities[i];
-        if (i < initialCities.size() - 1) std::cout << ", ";
-    }
-    std::cout << std::endl;
-
-    std::cout << " Planning route to visit " << (initialCities.size() + 1) << " cities total (initial 11):" << std::endl;
-    std::cout << "   - Starting city: Paris (ID 9)" << std::endl;
-    std::cout << "   - Other cities to visit: " << initialCities.size() << std::endl;
-    std::cout << "   - Excluding: Stockholm (ID 12) and Vienna (ID 13)" << std::endl;
-
-    // Use recursive algorithm to find optimal route among initial cities only
-    CreateShortestTrip(parisTrip, 9, initialCities);
-
-    std::cout << " Paris tour completed!" << std::endl;
-    std::cout << "   Total distance: " << parisTrip.getTotalDistance() << " km" << std::endl;
-    std::cout << "   Cities visited: " << getTripSize(parisTrip) << std::endl;
-
-    return parisTrip;
+    return initialCities;
 }
 
-Trip TripService::planLondonTour(int numCities) {
-    std::cout << "\n🇬🇧 Planning London Tour for " << numCities << " cities\n" << std::endl;
-
-    Trip londonTrip(0, 7, "london_tour", 0.0); // London has ID 7
-    
-    bool saved = tripRepo.save(londonTrip);
-    if (!saved || londonTrip.getId() <= 0) {
-        std::cout << "❌ Failed to save London trip" << std::endl;
-        return londonTrip;
-    }
-
-    std::cout << "✅ Created London trip with ID: " << londonTrip.getId() << std::endl;
-
-    // Add London as the first city
-    addCityToTrip(londonTrip, 7); // London is city ID 7
-
-    //  Only visit the specified number of cities (excluding London)
+V<int> TripService::londonTourCities(int numCities) {
     V<int> availableCities;
     availableCities.push_back(1);  // Amsterdam
     availableCities.push_back(2);  // Berlin
@@ -276,46 +442,18 @@ Trip TripService::planLondonTour(int numCities) {
     availableCities.push_back(11); // Rome
     availableCities.push_back(12); // Stockholm
     availableCities.push_back(13); // Vienna
-    // Note: London (7) is already added as the starting city
+    // Note: London (7) is the starting city
 
-    // ✅ NEW: Limit to the requested number of cities (excluding London)
+    // Limit to the requested number of cities (excluding London)
     int citiesToVisit = std::min(numCities - 1, (int)availableCities.size());
     V<int> selectedCities;
     for (int i = 0; i < citiesToVisit; i++) {
         selectedCities.push_back(availableCities[i]);
     }
-
-    std::cout << " Planning London route to visit " << (selectedCities.size() + 1) << " cities total:" << std::endl;
-    std::cout << "   - Starting city: London (ID 7)" << std::endl;
-    std::cout << "   - Other cities to visit: " << selectedCities.size() << std::endl;
-
-    // Use recursive algorithm to find optimal route
-    CreateShortestTrip(londonTrip, 7, selectedCities);
-
-    std::cout << " London tour completed!" << std::endl;
-    std::cout << "   Total distance: " << londonTrip.getTotalDistance() << " km" << std::endl;
-    std::cout << "   Cities visited: " << getTripSize(londonTrip) << std::endl;
-
-    return londonTrip;
+    return selectedCities;
 }
 
-Trip TripService::planBerlinTour() {
-    std::cout << "\n🇩🇪 Planning Berlin Tour\n" << std::endl;
-
-    Trip berlinTrip(0, 2, "berlin_tour", 0.0); // Berlin has ID 2
-    
-    bool saved = tripRepo.save(berlinTrip);
-    if (!saved || berlinTrip.getId() <= 0) {
-        std::cout << "❌ Failed to save Berlin trip" << std::endl;
-        return berlinTrip;
-    }
-
-    std::cout << "✅ Created Berlin trip with ID: " << berlinTrip.getId() << std::endl;
-
-    // Add Berlin as the first city
-    addCityToTrip(berlinTrip, 2); // Berlin is city ID 2
-
-    // Berlin tour should visit ALL 13 European cities
+V<int> TripService::berlinTourCities() {
     V<int> allEuropeanCities;
     allEuropeanCities.push_back(1);  // Amsterdam
     allEuropeanCities.push_back(3);  // Brussels
@@ -329,50 +467,81 @@ Trip TripService::planBerlinTour() {
     allEuropeanCities.push_back(11); // Rome
     allEuropeanCities.push_back(12); // Stockholm
     allEuropeanCities.push_back(13); // Vienna
+    // Note: Berlin (2) is the starting city
+    return allEuropeanCities;
+}
 
-    std::cout << " Planning Berlin route to visit ALL " << (allEuropeanCities.size() + 1) << " European cities:" << std::endl;
-    std::cout << "   - Starting city: Berlin (ID 2)" << std::endl;
-    std::cout << "   - Other cities to visit: " << allEuropeanCities.size() << std::endl;
+V<BatchTripResult> TripService::planBatch(const V<TripPlanRequest>& requests) {
+    if (requests.size() > MAX_TRIPS_PER_BATCH) {
+        throw std::invalid_argument("A batch may plan at most " + std::to_string(MAX_TRIPS_PER_BATCH) + " trips");
+    }
 
-    // Use recursive algorithm to find optimal route
-    CreateShortestTrip(berlinTrip, 2, allEuropeanCities);
+    std::cout << "\n Planning batch of " << requests.size() << " trips\n" << std::endl;
 
-    std::cout << " Berlin tour completed!" << std::endl;
-    std::cout << "   Total distance: " << berlinTrip.getTotalDistance() << " km" << std::endl;
-    std::cout << "   Cities visited: " << getTripSize(berlinTrip) << std::endl;
+    // Every request reads the same immutable matrix, so no locking is needed while planning
+    std::shared_ptr<const DistanceMatrix> distances = referenceData.getDistanceMatrix();
+    std::vector<BatchTripResult> outcomes(requests.size());
 
-    return berlinTrip;
-}
+    auto planRange = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const TripPlanRequest& request = requests[i];
+            BatchTripResult& outcome = outcomes[i];
 
-Trip TripService::planCustomTour(int startCityId, const V<int>& citiesToVisit) {
-    std::cout << "\n Planning Custom Tour\n" << std::endl;
-    std::cout << "   Starting city ID: " << startCityId << std::endl;
-    std::cout << "   Cities to visit: " << citiesToVisit.size() << std::endl;
+            if (!distances->hasCity(request.startCityId)) {
+                outcome.error = "Unknown start city " + std::to_string(request.startCityId);
+                continue;
+            }
+            if (request.cityIds.empty()) {
+                outcome.error = "At least one city must be specified in city_ids";
+                continue;
+            }
 
-    Trip customTrip(0, startCityId, "custom", 0.0);
-    
-    bool saved = tripRepo.save(customTrip);
-    if (!saved || customTrip.getId() <= 0) {
-        std::cout << "❌ Failed to save custom trip" << std::endl;
-        return customTrip;
-    }
+            outcome.route = TripPlanner::planGreedy(*distances, request.startCityId, request.cityIds, nullptr,
+                                                    request.options.closed);
+            if (request.options.twoOpt) {
+                TripPlanner::improveTwoOpt(*distances, outcome.route);
+            }
+            outcome.success = true;
+        }
+    };
 
-    std::cout << "✅ Created custom trip with ID: " << customTrip.getId() << std::endl;
+    // Chunks go to the shared scheduler; this thread plans chunks too while it waits
+    TaskScheduler::getInstance().parallelFor(requests.size(), planRange);
 
-    // Add starting city as the first city
-    addCityToTrip(customTrip, startCityId);
+    // Persist everything in one transaction: one commit instead of one per row
+    Transaction transaction(DatabaseManager::getInstance());
+    if (!transaction.isActive()) {
+        throw std::runtime_error("Failed to start transaction for batch trips");
+    }
 
-    std::cout << " Planning custom route:" << std::endl;
-    std::cout << "   - Starting city: " << startCityId << std::endl;
-    std::cout << "   - Cities to visit: " << citiesToVisit.size() << std::endl;
+    for (auto& outcome : outcomes) {
+        if (!outcome.success) {
+            continue;
+        }
 
-    // Use recursive algorithm with user-selected cities
-    CreateShortestTrip(customTrip, startCityId, citiesToVisit);
+        outcome.trip = Trip(0, outcome.route.startCityId, TripKind::Custom, outcome.route.totalDistance);
+        if (!saveRoute(outcome.trip, outcome.route)) {
+            throw std::runtime_error("Failed to save batch trips; no trips were stored");
+        }
+    }
 
-    std::cout << " Custom tour completed!" << std::endl;
-    std::cout << "   Total distance: " << customTrip.getTotalDistance() << " km" << std::endl;
-    std::cout << "   Cities visited: " << getTripSize(customTrip) << std::endl;
+    if (!transaction.commit()) {
+        throw std::runtime_error("Failed to commit batch trips");
+    }
 
-    return customTrip;
+    V<BatchTripResult> results;
+    for (const auto& outcome : outcomes) {
+        results.push_back(outcome);
+    }
+
+    std::cout << " Batch planning completed!" << std::endl;
+    return results;
 }
 
+bool TripService::forEachTrip(int afterId, int limit, TripKind tripKind,
+                              const std::function<bool(const Trip&)>& onTrip) {
+    if (afterId < 0) {
+        return false;
+    }
+    return tripRepo.forEachInPage(afterId, limit, tripKind, onTrip);
+}
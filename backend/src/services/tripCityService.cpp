@@ -56,6 +56,30 @@ bool TripCityService::addCityToTrip(int tripId, int cityId, int visitOrder) {
     return repo.save(tripCity);
 }
 
+/**
+ * @brief Adds a complete planned route to a new trip
+ * @param tripId The ID of the trip to add the cities to
+ * @param cityIds The cities in visit order
+ * @return true if all cities were saved, false otherwise
+ * 
+ * Used when the route was planned in memory: visit orders are simply the
+ * positions in the list, so no database lookups are needed before the
+ * inserts. Callers wrap this in a transaction when saving many trips.
+ */
+bool TripCityService::addRouteToTrip(int tripId, const V<int>& cityIds) {
+    V<TripCity> tripCities;
+    
+    for (size_t i = 0; i < cityIds.size(); i++) {
+        int visitOrder = i + 1;
+        if (!validateTripCity(tripId, cityIds[i], visitOrder)) {
+            return false;
+        }
+        tripCities.push_back(TripCity(tripId, cityIds[i], visitOrder));
+    }
+    
+    return repo.saveAll(tripCities);
+}
+
 /**
  * @brief Retrieves all cities for a specific trip
  * @param tripId The ID of the trip
@@ -68,6 +92,22 @@ V<TripCity> TripCityService::getCitiesForTrip(int tripId) {
     return repo.findByTrip(tripId);
 }
 
+/**
+ * @brief Visits one keyset page of trip-city rows
+ * @param afterId Only rows with an ID greater than this
+ * @param limit Maximum number of rows to visit
+ * @param tripId Restrict to one trip, or 0 for every trip
+ * @param onTripCity Called for each row; return false to stop early
+ * @return true if the rows could be read, false otherwise
+ */
+bool TripCityService::forEachTripCity(int afterId, int limit, int tripId,
+                                      const std::function<bool(const TripCity&)>& onTripCity) {
+    if (afterId < 0 || tripId < 0) {
+        return false;
+    }
+    return repo.forEachInPage(afterId, limit, tripId, onTripCity);
+}
+
 /**
  * @brief Removes a city from a specific trip
  * @param tripId The ID of the trip
@@ -117,6 +157,64 @@ bool TripCityService::updateVisitOrder(int tripId, int cityId, int newOrder) {
     return false; // City not found in trip
 }
 
+/**
+ * @brief Inserts a city at a visit order
+ * @param tripId The ID of the trip
+ * @param cityId The ID of the city to insert
+ * @param visitOrder Position the city takes
+ * @return true if the city was inserted, false otherwise
+ * 
+ * Stops at or after visitOrder move back one place first, so the new stop
+ * never collides with an existing one. Callers wrap this in a transaction.
+ */
+bool TripCityService::insertCityAt(int tripId, int cityId, int visitOrder) {
+    if (!validateTripCity(tripId, cityId, visitOrder)) {
+        return false;
+    }
+    
+    TripCity tripCity(tripId, cityId, visitOrder);
+    return repo.shiftVisitOrders(tripId, visitOrder, 1) && repo.save(tripCity);
+}
+
+/**
+ * @brief Removes the stop at a visit order
+ * @param tripId The ID of the trip
+ * @param visitOrder Position of the stop to remove
+ * @return true if the stop was removed, false otherwise
+ * 
+ * Later stops move forward one place so visit orders stay contiguous.
+ * Callers wrap this in a transaction.
+ */
+bool TripCityService::removeCityAt(int tripId, int visitOrder) {
+    if (!validateTripCity(tripId, 1, visitOrder)) {
+        return false;
+    }
+    
+    return repo.removeByTripAndOrder(tripId, visitOrder) && repo.shiftVisitOrders(tripId, visitOrder + 1, -1);
+}
+
+/**
+ * @brief Gives a trip's stops new visit orders
+ * @param tripId The ID of the trip
+ * @param stops Every stop of the trip in its new order
+ * @return true if the stops were reordered, false otherwise
+ * 
+ * The stops keep their rows; only visit_order changes, to each stop's
+ * position in the list. Callers wrap this in a transaction.
+ */
+bool TripCityService::reorderStops(int tripId, const V<TripCity>& stops) {
+    V<int> tripCityIds;
+    
+    for (const auto& stop : stops) {
+        if (stop.getTripId() != tripId || stop.getId() <= 0) {
+            return false;
+        }
+        tripCityIds.push_back(stop.getId());
+    }
+    
+    return repo.reorderTrip(tripId, tripCityIds);
+}
+
 /**
  * @brief Checks if a city exists in a specific trip
  * @param tripId The ID of the trip